@@ -98,6 +98,9 @@ static struct
   int       has_mem_access;
 } _tracer;
 
+/* Funció que rep els accessos registrats (veure ACCLOG). */
+static PyObject *_acclog_flush;
+
 /* Pantalla. */
 static struct
 {
@@ -123,15 +126,12 @@ static int _control;
 static struct
 {
   
-  double *buffer;
-  char    silence;
-  int     pos;
-  int     size;
-  double  ratio;
-  double  pos2;
+  GG_AudioRing *ring;
+  double       *buffer;
+  char          silence;
+  int           nframes;
   
 } _audio;
-static volatile int _audio_full;
 
 
 
@@ -289,19 +289,15 @@ audio_callback (
         	)
 {
   
-  int i;
+  int i, n;
   
   
-  assert ( _audio.size == len );
-  if ( _audio_full )
-    {
-      for ( i= 0; i < len; ++i )
-        stream[i]= 127 + (Uint8) ((128*_audio.buffer[i]) + 0.5);
-      _audio_full= 0;
-    }
-  else
-    for ( i= 0; i < len; ++i )
-      stream[i]= _audio.silence;
+  assert ( 2*_audio.nframes == len );
+  n= 2*GG_audio_ring_read ( _audio.ring, _audio.buffer, _audio.nframes );
+  for ( i= 0; i < n; ++i )
+    stream[i]= 127 + (Uint8) ((128*_audio.buffer[i]) + 0.5);
+  for ( ; i < len; ++i )
+    stream[i]= _audio.silence;
   
 } /* end audio_callback */
 
@@ -314,9 +310,6 @@ init_audio (void)
   SDL_AudioSpec desired, obtained;
   
   
-  /* Únic camp de l'estat que s'inicialitza abans. */
-  _audio_full= 0;
-  
   /* Inicialitza. */
   desired.freq= 44100;
   desired.format= AUDIO_U8;
@@ -337,17 +330,26 @@ init_audio (void)
     }
   
   /* Inicialitza estat. */
-  _audio.buffer= (double *) malloc ( sizeof(double)*obtained.size );
-  _audio.silence= (char) obtained.silence;
-  _audio.pos= 0;
-  _audio.size= obtained.size;
   if ( obtained.freq >= GG_PSG_SAMPLES_PER_SEC )
     {
       SDL_CloseAudio ();
       return "Freqüència massa gran";
     }
-  _audio.ratio= GG_PSG_SAMPLES_PER_SEC / (double) obtained.freq;
-  _audio.pos2= 0.0;
+  _audio.nframes= obtained.size/2;
+  _audio.buffer= (double *) malloc ( sizeof(double)*2*_audio.nframes );
+  _audio.ring= GG_audio_ring_new ( 4*_audio.nframes );
+  if ( _audio.buffer == NULL || _audio.ring == NULL )
+    {
+      SDL_CloseAudio ();
+      free ( _audio.buffer );
+      GG_audio_ring_free ( _audio.ring );
+      return "No s'ha pogut reservar memòria per a l'àudio";
+    }
+  _audio.silence= (char) obtained.silence;
+  
+  /* Es deixa marge per a un buffer i mig de SDL. */
+  GG_pacing_init ( _audio.ring, obtained.freq,
+        	   (1.5*_audio.nframes) / obtained.freq );
   
   return NULL;
   
@@ -360,6 +362,7 @@ close_audio (void)
   
   SDL_CloseAudio ();
   free ( _audio.buffer );
+  GG_audio_ring_free ( _audio.ring );
   
 } /* end close_audio */
 
@@ -413,6 +416,7 @@ update_screen (
   for ( i= 0; i < 23040; ++i )
     _screen.data[i]= _palette[fb[i]];
   screen_update ();
+  if ( !GG_turbo_is_enabled () ) GG_pacing_frame ();
   
 } /* end update_screen */
 
@@ -496,37 +500,30 @@ play_sound (
             void         *udata
             )
 {
-  int nofull, j;
+  GG_pacing_play_sound ( left, right );
+} /* end play_sound */
+
+
+static void
+acclog_flush (
+              const GG_AccessHit *hits,
+              const int           n,
+              void               *udata
+              )
+{
   
+  PyObject *bytes, *ret;
   
-  for (;;)
-    {
-      
-      while ( _audio_full ) SDL_Delay ( 1 );
-      
-      j= (int) (_audio.pos2 + 0.5);
-      while ( (nofull= (_audio.pos != _audio.size)) &&
-              j < GG_PSG_BUFFER_SIZE )
-        {
-          _audio.buffer[_audio.pos++]= left[j];
-          _audio.buffer[_audio.pos++]= right[j];
-          _audio.pos2+= _audio.ratio;
-          j= (int) (_audio.pos2 + 0.5);
-        }
-      if ( !nofull )
-        {
-          _audio.pos= 0;
-          _audio_full= 1;
-        }
-      if ( j >= GG_PSG_BUFFER_SIZE )
-        {
-          _audio.pos2-= GG_PSG_BUFFER_SIZE;
-          break;
-        }
-      
-    }
   
-} /* end play_sound */
+  if ( _acclog_flush == NULL || PyErr_Occurred () != NULL ) return;
+  bytes= PyBytes_FromStringAndSize ( (const char *) hits,
+        			     n*sizeof(GG_AccessHit) );
+  if ( bytes == NULL ) return;
+  ret= PyObject_CallFunctionObjArgs ( _acclog_flush, bytes, NULL );
+  Py_DECREF ( bytes );
+  Py_XDECREF ( ret );
+  
+} /* end acclog_flush */
 
 
 static void
@@ -628,6 +625,201 @@ cpu_step (
 /* FUNCIONS MÒDUL */
 /******************/
 
+static PyObject *
+GG_acclog_add_range_module (
+        		    PyObject *self,
+        		    PyObject *args
+        		    )
+{
+  
+  int first, last, mask;
+  
+  
+  mask= GG_ACCLOG_READ|GG_ACCLOG_WRITE;
+  if ( !PyArg_ParseTuple ( args, "ii|i", &first, &last, &mask ) )
+    return NULL;
+  if ( first < 0 || last > 0xFFFF ||
+       GG_acclog_add_range ( (Z80u16) first, (Z80u16) last, mask ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Invalid access log range" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_acclog_add_range_module */
+
+
+static PyObject *
+GG_acclog_clear_ranges_module (
+        		       PyObject *self,
+        		       PyObject *args
+        		       )
+{
+  
+  GG_acclog_clear_ranges ();
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_acclog_clear_ranges_module */
+
+
+static PyObject *
+GG_acclog_close_module (
+        		PyObject *self,
+        		PyObject *args
+        		)
+{
+  
+  GG_acclog_close ();
+  Py_XDECREF ( _acclog_flush );
+  _acclog_flush= NULL;
+  if ( PyErr_Occurred () != NULL ) return NULL;
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_acclog_close_module */
+
+
+static PyObject *
+GG_acclog_flush_module (
+        		PyObject *self,
+        		PyObject *args
+        		)
+{
+  
+  GG_acclog_flush ();
+  if ( PyErr_Occurred () != NULL ) return NULL;
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_acclog_flush_module */
+
+
+static PyObject *
+GG_acclog_init_module (
+        	       PyObject *self,
+        	       PyObject *args
+        	       )
+{
+  
+  int size;
+  PyObject *aux;
+  
+  
+  if ( !PyArg_ParseTuple ( args, "iO", &size, &aux ) )
+    return NULL;
+  if ( !PyCallable_Check ( aux ) )
+    {
+      PyErr_SetString ( PyExc_TypeError, "Flush must be callable" );
+      return NULL;
+    }
+  GG_acclog_close ();
+  Py_XDECREF ( _acclog_flush );
+  _acclog_flush= aux;
+  Py_INCREF ( _acclog_flush );
+  if ( GG_acclog_init ( size, acclog_flush, NULL ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to allocate the access log" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_acclog_init_module */
+
+
+static PyObject *
+GG_break_clear_module (
+        	       PyObject *self,
+        	       PyObject *args
+        	       )
+{
+  
+  GG_break_clear ();
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_break_clear_module */
+
+
+static PyObject *
+GG_break_get_event_module (
+        		   PyObject *self,
+        		   PyObject *args
+        		   )
+{
+  
+  GG_BreakEvent event;
+  
+  
+  GG_break_get_event ( &event );
+  
+  return Py_BuildValue ( "{sisisisB}",
+        		 "reason", event.reason,
+        		 "addr", event.addr,
+        		 "bank", event.bank,
+        		 "data", event.data );
+  
+} /* end GG_break_get_event_module */
+
+
+static PyObject *
+GG_break_set_exec_module (
+        		  PyObject *self,
+        		  PyObject *args
+        		  )
+{
+  
+  int bank, addr, enable;
+  
+  
+  enable= 1;
+  if ( !PyArg_ParseTuple ( args, "ii|p", &bank, &addr, &enable ) )
+    return NULL;
+  if ( addr < 0 || addr > 0xFFFF ||
+       GG_break_set_exec ( bank, (Z80u16) addr,
+        		   enable ? Z80_TRUE : Z80_FALSE ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to set the breakpoint" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_break_set_exec_module */
+
+
+static PyObject *
+GG_break_set_watch_module (
+        		   PyObject *self,
+        		   PyObject *args
+        		   )
+{
+  
+  int space, type, first, last, enable;
+  
+  
+  last= -1;
+  enable= 1;
+  if ( !PyArg_ParseTuple ( args, "iii|ip", &space, &type, &first,
+        		   &last, &enable ) )
+    return NULL;
+  if ( last == -1 ) last= first;
+  if ( (type != GG_READ && type != GG_WRITE) ||
+       GG_break_set_watch ( (GG_WatchSpace) space, (GG_MemAccessType) type,
+        		    first, last,
+        		    enable ? Z80_TRUE : Z80_FALSE ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to set the watchpoint" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_break_set_watch_module */
+
+
 static PyObject *
 GG_close (
           PyObject *self,
@@ -643,12 +835,104 @@ GG_close (
   if ( _rom.banks != NULL ) GG_rom_free ( _rom );
   _initialized= FALSE;
   Py_XDECREF ( _tracer.obj );
+  GG_acclog_close ();
+  Py_XDECREF ( _acclog_flush );
+  _acclog_flush= NULL;
   
   Py_RETURN_NONE;
   
 } /* end GG_close */
 
 
+static PyObject *
+GG_get_audio_stats (
+        	    PyObject *self,
+        	    PyObject *args
+        	    )
+{
+  
+  GG_AudioRingStats stats;
+  GG_PacingStats pacing;
+  
+  
+  CHECK_INITIALIZED;
+  
+  GG_audio_ring_get_stats ( _audio.ring, &stats );
+  GG_pacing_get_stats ( &pacing );
+  
+  return Py_BuildValue ( "{sksksisisdsdsdsd}",
+        		 "underruns", stats.underruns,
+        		 "overruns", stats.overruns,
+        		 "fill", GG_audio_ring_get_fill ( _audio.ring ),
+        		 "size", GG_audio_ring_get_size ( _audio.ring ),
+        		 "target_latency", pacing.target_latency,
+        		 "latency", pacing.latency,
+        		 "jitter", pacing.jitter,
+        		 "ratio", pacing.ratio );
+  
+} /* end GG_get_audio_stats */
+
+
+static PyObject *
+GG_get_idle_stats (
+        	   PyObject *self,
+        	   PyObject *args
+        	   )
+{
+  
+  GG_IdleStats stats;
+  
+  
+  GG_idle_get_stats ( &stats );
+  
+  return Py_BuildValue ( "{sKsKsKsK}",
+        		 "probes", (unsigned long long) stats.probes,
+        		 "loops", (unsigned long long) stats.loops,
+        		 "skips", (unsigned long long) stats.skips,
+        		 "cycles", (unsigned long long) stats.cycles );
+  
+} /* end GG_get_idle_stats */
+
+
+static PyObject *
+GG_get_runahead_stats (
+        	       PyObject *self,
+        	       PyObject *args
+        	       )
+{
+  
+  GG_RunaheadStats stats;
+  
+  
+  CHECK_INITIALIZED;
+  
+  GG_runahead_get_stats ( &stats );
+  
+  return Py_BuildValue ( "{sisksdsd}",
+        		 "nframes", stats.nframes,
+        		 "frames", stats.frames,
+        		 "cpu", stats.cpu,
+        		 "runahead", stats.runahead );
+  
+} /* end GG_get_runahead_stats */
+
+
+static PyObject *
+GG_get_state_hash_module (
+        		  PyObject *self,
+        		  PyObject *args
+        		  )
+{
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  
+  return Py_BuildValue ( "K",
+        		 (unsigned long long) GG_get_state_hash () );
+  
+} /* end GG_get_state_hash_module */
+
+
 static PyObject *
 GG_get_cram (
              PyObject *self,
@@ -664,6 +948,30 @@ GG_get_cram (
 } /* end GG_get_cram */
 
 
+static PyObject *
+GG_get_turbo_stats (
+        	    PyObject *self,
+        	    PyObject *args
+        	    )
+{
+  
+  GG_TurboStats stats;
+  
+  
+  CHECK_INITIALIZED;
+  
+  GG_turbo_get_stats ( &stats );
+  
+  return Py_BuildValue ( "{sdskskso}",
+        		 "speed", stats.speed,
+        		 "frames", stats.frames,
+        		 "shown", stats.shown,
+        		 "enabled",
+        		 GG_turbo_is_enabled () ? Py_True : Py_False );
+  
+} /* end GG_get_turbo_stats */
+
+
 static PyObject *
 GG_get_vram (
              PyObject *self,
@@ -743,7 +1051,7 @@ GG_get_mapper_state (
   Py_DECREF ( aux );
   
   return dict;
-
+  
  error:
   Py_DECREF ( dict );
   return NULL;  
@@ -751,6 +1059,55 @@ GG_get_mapper_state (
 } /* end GG_get_mapper_state */
 
 
+static PyObject *
+GG_get_perf_stats (
+        	   PyObject *self,
+        	   PyObject *args
+        	   )
+{
+  
+  static const char *names[GG_PERF_NCOUNTERS]=
+    {
+      "cpu", "render", "sat", "synth", "mix", "update_screen",
+      "play_sound", "check", "check_buttons"
+    };
+  
+  GG_PerfStats stats;
+  PyObject *dict, *aux;
+  int i;
+  
+  
+  GG_perf_get_stats ( &stats );
+  dict= PyDict_New ();
+  if ( dict == NULL ) return NULL;
+  for ( i= 0; i < GG_PERF_NCOUNTERS; ++i )
+    {
+      aux= Py_BuildValue ( "{sKsdsKsd}",
+        		   "calls", (unsigned long long) stats.total[i].calls,
+        		   "time", stats.total[i].ns*1e-9,
+        		   "last_calls",
+        		   (unsigned long long) stats.last[i].calls,
+        		   "last_time", stats.last[i].ns*1e-9 );
+      if ( aux == NULL || PyDict_SetItemString ( dict, names[i], aux ) != 0 )
+        {
+          Py_XDECREF ( aux );
+          Py_DECREF ( dict );
+          return NULL;
+        }
+      Py_DECREF ( aux );
+    }
+  
+  return Py_BuildValue ( "{sOsksdsdsN}",
+        		 "available",
+        		 GG_perf_is_available () ? Py_True : Py_False,
+        		 "frames", stats.frames,
+        		 "frame_time", stats.frame_ns*1e-9,
+        		 "last_frame_time", stats.last_frame_ns*1e-9,
+        		 "counters", dict );
+  
+} /* end GG_get_perf_stats */
+
+
 static PyObject *
 GG_get_rom (
             PyObject *self,
@@ -902,19 +1259,303 @@ GG_loop_module (
         	)
 {
   
+  GG_BreakReason reason;
+  
+  
   CHECK_INITIALIZED;
   CHECK_ROM;
   
-  _audio_full= 0;
+  GG_audio_ring_clear ( _audio.ring );
+  GG_pacing_reset ();
   SDL_PauseAudio ( 0 );
-  GG_loop ();
+  reason= GG_loop ();
   SDL_PauseAudio ( 1 );
   
-  Py_RETURN_NONE;
+  return PyLong_FromLong ( reason );
   
 } /* end GG_loop_module */
 
 
+static PyObject *
+GG_movie_get_info_module (
+        		  PyObject *self,
+        		  PyObject *args
+        		  )
+{
+  
+  GG_MovieInfo info;
+  
+  
+  CHECK_INITIALIZED;
+  
+  GG_movie_get_info ( &info );
+  
+  return Py_BuildValue ( "{sisisisisisksn}",
+        		 "mode", (int) info.mode,
+        		 "frame", info.frame,
+        		 "nframes", info.nframes,
+        		 "nkeyframes", info.nkeyframes,
+        		 "interval", info.interval,
+        		 "rom_crc", (unsigned long) info.rom_crc,
+        		 "size", (Py_ssize_t) info.size );
+  
+} /* end GG_movie_get_info_module */
+
+
+static PyObject *
+GG_movie_load_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  const char *fname;
+  FILE *f;
+  int ret;
+  
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  if ( !PyArg_ParseTuple ( args, "s", &fname ) )
+    return NULL;
+  f= fopen ( fname, "rb" );
+  if ( f == NULL )
+    return PyErr_SetFromErrnoWithFilename ( PyExc_OSError, fname );
+  ret= GG_movie_load ( f );
+  fclose ( f );
+  if ( ret != 0 )
+    {
+      PyErr_SetString ( GGError, "Invalid movie or recorded with"
+        		" another ROM" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_movie_load_module */
+
+
+static PyObject *
+GG_movie_play_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  if ( GG_movie_play () != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to play the movie" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_movie_play_module */
+
+
+static PyObject *
+GG_movie_record_module (
+        		PyObject *self,
+        		PyObject *args
+        		)
+{
+  
+  int interval;
+  
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  interval= 600;
+  if ( !PyArg_ParseTuple ( args, "|i", &interval ) )
+    return NULL;
+  if ( GG_movie_record ( interval ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to start recording" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_movie_record_module */
+
+
+static PyObject *
+GG_movie_save_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  const char *fname;
+  FILE *f;
+  int ret;
+  
+  
+  CHECK_INITIALIZED;
+  if ( !PyArg_ParseTuple ( args, "s", &fname ) )
+    return NULL;
+  f= fopen ( fname, "wb" );
+  if ( f == NULL )
+    return PyErr_SetFromErrnoWithFilename ( PyExc_OSError, fname );
+  ret= GG_movie_save ( f );
+  if ( fclose ( f ) != 0 ) ret= -1;
+  if ( ret != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to write the movie" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_movie_save_module */
+
+
+static PyObject *
+GG_movie_seek_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  int frame;
+  
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  if ( !PyArg_ParseTuple ( args, "i", &frame ) )
+    return NULL;
+  if ( GG_movie_seek ( frame ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to seek the movie" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_movie_seek_module */
+
+
+static PyObject *
+GG_movie_stop_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  CHECK_INITIALIZED;
+  
+  GG_movie_stop ();
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_movie_stop_module */
+
+
+static PyObject *
+GG_perf_reset_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  GG_perf_reset ();
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_perf_reset_module */
+
+
+static PyObject *
+GG_prof_save (
+              PyObject *self,
+              PyObject *args
+              )
+{
+  
+  const char *fname;
+  int cycles, ret;
+  FILE *f;
+  
+  
+  cycles= 0;
+  if ( !PyArg_ParseTuple ( args, "s|p", &fname, &cycles ) )
+    return NULL;
+  f= fopen ( fname, "w" );
+  if ( f == NULL )
+    return PyErr_SetFromErrnoWithFilename ( PyExc_OSError, fname );
+  ret= GG_prof_write ( f, cycles ? Z80_TRUE : Z80_FALSE );
+  if ( fclose ( f ) != 0 ) ret= -1;
+  if ( ret != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to write the profile" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_prof_save */
+
+
+static PyObject *
+GG_prof_start_module (
+        	      PyObject *self,
+        	      PyObject *args
+        	      )
+{
+  
+  int mode, period;
+  
+  
+  period= 0;
+  if ( !PyArg_ParseTuple ( args, "i|i", &mode, &period ) )
+    return NULL;
+  if ( (mode != GG_PROF_EXACT && mode != GG_PROF_SAMPLING) ||
+       GG_prof_start ( (GG_ProfMode) mode, period ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Invalid profiler mode or period" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_prof_start_module */
+
+
+static PyObject *
+GG_prof_stop_module (
+        	     PyObject *self,
+        	     PyObject *args
+        	     )
+{
+  
+  GG_prof_stop ();
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_prof_stop_module */
+
+
+static PyObject *
+GG_set_idle_skip (
+        	  PyObject *self,
+        	  PyObject *args
+        	  )
+{
+  
+  int enabled;
+  
+  
+  if ( !PyArg_ParseTuple ( args, "p", &enabled ) )
+    return NULL;
+  GG_idle_set_enabled ( enabled ? Z80_TRUE : Z80_FALSE );
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_set_idle_skip */
+
+
 static PyObject *
 GG_set_rom (
             PyObject *self,
@@ -973,6 +1614,59 @@ GG_set_rom (
 } /* end GG_set_rom */
 
 
+static PyObject *
+GG_set_runahead (
+        	 PyObject *self,
+        	 PyObject *args
+        	 )
+{
+  
+  int nframes;
+  
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  if ( !PyArg_ParseTuple ( args, "i", &nframes ) )
+    return NULL;
+  if ( GG_runahead_init ( nframes ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to enable run-ahead" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_set_runahead */
+
+
+static PyObject *
+GG_set_turbo (
+              PyObject *self,
+              PyObject *args
+              )
+{
+  
+  int enabled, nth;
+  double speed;
+  
+  
+  CHECK_INITIALIZED;
+  speed= GG_TURBO_MAX;
+  nth= 10;
+  if ( !PyArg_ParseTuple ( args, "p|di", &enabled, &speed, &nth ) )
+    return NULL;
+  if ( !enabled ) GG_turbo_disable ();
+  else if ( GG_turbo_enable ( speed, nth ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Invalid turbo speed or frame interval" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_set_turbo */
+
+
 static PyObject *
 GG_set_tracer (
                PyObject *self,
@@ -1025,6 +1719,103 @@ GG_trace_module (
 } /* end GG_trace_module */
 
 
+static PyObject *
+GG_trace_close (
+        	PyObject *self,
+        	PyObject *args
+        	)
+{
+  
+  GG_tracer_close ();
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_trace_close */
+
+
+static PyObject *
+GG_trace_open (
+               PyObject *self,
+               PyObject *args
+               )
+{
+  
+  Py_ssize_t nrecords;
+  const char *fname;
+  
+  
+  fname= NULL;
+  if ( !PyArg_ParseTuple ( args, "n|z", &nrecords, &fname ) )
+    return NULL;
+  if ( nrecords <= 0 || GG_tracer_open ( (size_t) nrecords, fname ) != 0 )
+    {
+      PyErr_SetString ( GGError, "Unable to open the trace buffer" );
+      return NULL;
+    }
+  
+  Py_RETURN_NONE;
+  
+} /* end GG_trace_open */
+
+
+static PyObject *
+GG_trace_read (
+               PyObject *self,
+               PyObject *args
+               )
+{
+  
+  unsigned long long pos;
+  uint64_t aux;
+  Py_ssize_t n;
+  size_t nread;
+  GG_TracerStats stats;
+  PyObject *bytes;
+  
+  
+  n= -1;
+  if ( !PyArg_ParseTuple ( args, "K|n", &pos, &n ) )
+    return NULL;
+  GG_tracer_get_stats ( &stats );
+  if ( n < 0 || (uint64_t) n > stats.capacity ) n= stats.capacity;
+  bytes= PyBytes_FromStringAndSize ( NULL, n*sizeof(GG_TraceRecord) );
+  if ( bytes == NULL ) return NULL;
+  aux= pos;
+  nread= GG_tracer_read ( &aux,
+        		  (GG_TraceRecord *) PyBytes_AS_STRING ( bytes ), n );
+  if ( _PyBytes_Resize ( &bytes, nread*sizeof(GG_TraceRecord) ) != 0 )
+    return NULL;
+  
+  return Py_BuildValue ( "KN", (unsigned long long) aux, bytes );
+  
+} /* end GG_trace_read */
+
+
+static PyObject *
+GG_trace_run_module (
+        	     PyObject *self,
+        	     PyObject *args
+        	     )
+{
+  
+  long nsteps, cc;
+  
+  
+  CHECK_INITIALIZED;
+  CHECK_ROM;
+  if ( !PyArg_ParseTuple ( args, "l", &nsteps ) )
+    return NULL;
+  
+  SDL_PauseAudio ( 0 );
+  cc= GG_trace_run ( nsteps );
+  SDL_PauseAudio ( 1 );
+  if ( PyErr_Occurred () != NULL ) return NULL;
+  
+  return PyLong_FromLong ( cc );
+  
+} /* end GG_trace_run_module */
+
+
 
 
 /************************/
@@ -1033,23 +1824,123 @@ GG_trace_module (
 
 static PyMethodDef GGMethods[]=
   {
+    { "acclog_add_range", GG_acclog_add_range_module, METH_VARARGS,
+      "Log the accesses to the cpu addresses FIRST to LAST. The optional"
+      " third argument is a mask of ACCLOG_READ and ACCLOG_WRITE" },
+    { "acclog_clear_ranges", GG_acclog_clear_ranges_module, METH_VARARGS,
+      "Remove all access log ranges" },
+    { "acclog_close", GG_acclog_close_module, METH_VARARGS,
+      "Flush and free the access log" },
+    { "acclog_flush", GG_acclog_flush_module, METH_VARARGS,
+      "Pass the pending logged accesses to the flush function" },
+    { "acclog_init", GG_acclog_init_module, METH_VARARGS,
+      "Allocate an access log of N entries. Every time it is full the"
+      " second argument is called with the entries as bytes (6 bytes"
+      " each: addr H, data B, type B, bank B, flags B)" },
+    { "break_clear", GG_break_clear_module, METH_VARARGS,
+      "Remove all breakpoints and watchpoints" },
+    { "break_get_event", GG_break_get_event_module, METH_VARARGS,
+      "Get the event that stopped the last loop (reason, addr, bank and"
+      " data) structured into a dictionary" },
+    { "break_set_exec", GG_break_set_exec_module, METH_VARARGS,
+      "Set (or remove if the third argument is False) an execution"
+      " breakpoint at an offset inside a ROM bank. Bank -1 means a cpu"
+      " address in RAM/SRAM (0x8000-0xFFFF)" },
+    { "break_set_watch", GG_break_set_watch_module, METH_VARARGS,
+      "Set (or remove if the fifth argument is False) a watchpoint of"
+      " type READ or WRITE on the addresses FIRST to LAST of the space"
+      " WATCH_RAM, WATCH_VRAM or WATCH_IO" },
     { "close", GG_close, METH_VARARGS,
       "Free module resources and close the module" },
+    { "get_audio_stats", GG_get_audio_stats, METH_VARARGS,
+      "Get the audio ring statistics (underruns, overruns, fill and size"
+      " in frames) and the pacing statistics (target_latency, latency and"
+      " jitter in seconds, and the resampling ratio correction) structured"
+      " into a dictionary" },
+    { "get_idle_stats", GG_get_idle_stats, METH_VARARGS,
+      "Get the idle loop detection statistics (probes, loops found, skips"
+      " and skipped cycles) structured into a dictionary" },
+    { "get_runahead_stats", GG_get_runahead_stats, METH_VARARGS,
+      "Get the run-ahead statistics (nframes, displayed frames, and mean"
+      " cpu and run-ahead time per displayed frame in seconds) structured"
+      " into a dictionary" },
+    { "get_state_hash", GG_get_state_hash_module, METH_VARARGS,
+      "Get a 64-bit hash of the architectural state (cpu registers,"
+      " memories, mapper, vdp and psg). Cheap enough to be compared"
+      " every frame to detect desyncs" },
     { "get_cram", GG_get_cram, METH_VARARGS,
       "Get a copy of the current vdp color ram" },
+    { "get_turbo_stats", GG_get_turbo_stats, METH_VARARGS,
+      "Get the turbo mode statistics (enabled, achieved speed relative"
+      " to real time, frames run and frames shown) structured into a"
+      " dictionary" },
     { "get_vram", GG_get_vram, METH_VARARGS,
       "Get a copy of the current vdp ram" },
     { "get_mapper_state", GG_get_mapper_state, METH_VARARGS,
       "Get the current state of the memory mapper structured"
       " into a dictionary" },
+    { "get_perf_stats", GG_get_perf_stats, METH_VARARGS,
+      "Get the performance counters structured into a dictionary: whether"
+      " they are available (the library must be built with -DGG_PERF),"
+      " the frames measured, the total and last frame host time in"
+      " seconds, and the calls and time of each part (cpu, render, sat,"
+      " synth, mix and the frontend callbacks), in total and in the last"
+      " frame" },
     { "get_rom", GG_get_rom, METH_VARARGS,
       "Get the ROM structured into a dictionary" },
     { "init", GG_init_module, METH_VARARGS,
       "Initialize the module" },
     { "loop", GG_loop_module, METH_VARARGS,
-      "Run the simulator into a loop and block" },
+      "Run the simulator into a loop and block. Returns the reason why"
+      " it stopped (BREAK_NONE, BREAK_EXEC, BREAK_RAM_READ, ...)" },
+    { "movie_get_info", GG_movie_get_info_module, METH_VARARGS,
+      "Get the movie state (mode MOVIE_NONE, MOVIE_STOPPED,"
+      " MOVIE_RECORDING or MOVIE_PLAYING, current frame, number of"
+      " frames and keyframes, keyframe interval, ROM CRC-32 and size in"
+      " bytes) structured into a dictionary" },
+    { "movie_load", GG_movie_load_module, METH_VARARGS,
+      "Load a movie (.ggm) recorded with the current ROM. It is left"
+      " stopped" },
+    { "movie_play", GG_movie_play_module, METH_VARARGS,
+      "Load the initial state of the movie and play it with GG.loop. At"
+      " the end the buttons are read again from the frontend" },
+    { "movie_record", GG_movie_record_module, METH_VARARGS,
+      "Start recording the input from the current state. The optional"
+      " argument is the number of frames between keyframes (600 by"
+      " default)" },
+    { "movie_save", GG_movie_save_module, METH_VARARGS,
+      "Write the current movie to a file (.ggm)" },
+    { "movie_seek", GG_movie_seek_module, METH_VARARGS,
+      "Jump to the beginning of frame N of the movie and keep playing" },
+    { "movie_stop", GG_movie_stop_module, METH_VARARGS,
+      "Stop recording or playing. The movie is kept in memory" },
+    { "perf_reset", GG_perf_reset_module, METH_VARARGS,
+      "Reset the performance counters" },
+    { "prof_save", GG_prof_save, METH_VARARGS,
+      "Write the profile to a file in folded-stacks format, one line per"
+      " address ('rom:OFFSET N' or 'ram:ADDR N'). N is the number of"
+      " instructions (or samples), or cycles if the second argument is"
+      " True" },
+    { "prof_start", GG_prof_start_module, METH_VARARGS,
+      "Start profiling GG.loop in mode PROF_EXACT or PROF_SAMPLING. The"
+      " second argument is the sampling period in cycles. Counters are"
+      " kept" },
+    { "prof_stop", GG_prof_stop_module, METH_VARARGS,
+      "Stop profiling. Counters are kept" },
+    { "set_idle_skip", GG_set_idle_skip, METH_VARARGS,
+      "Enable or disable the detection of idle loops in GG.loop. Detected"
+      " iterations are skipped up to the next vdp or psg event, charging"
+      " the same cycles. Not done while profiling or with breakpoints" },
     { "set_rom", GG_set_rom, METH_VARARGS,
       "Set a ROM into the simulator. The ROM should be of type bytes" },
+    { "set_runahead", GG_set_runahead, METH_VARARGS,
+      "Run N frames ahead of the real timeline to reduce input latency."
+      " 0 disables it" },
+    { "set_turbo", GG_set_turbo, METH_VARARGS,
+      "Enable (or disable if False) the turbo mode. The optional second"
+      " argument is the speed relative to real time (0.0, the default,"
+      " means as fast as possible) and the third one shows only one of"
+      " every N frames (10 by default). Sound is not synthesized" },
     { "set_tracer", GG_set_tracer, METH_VARARGS,
       "Set a python object to trace the execution. The object can"
       " implement one of these methods:\n"
@@ -1069,6 +1960,20 @@ static PyMethodDef GGMethods[]=
       "is passed as arguments" },
     { "trace", GG_trace_module, METH_VARARGS,
       "Executes the next instruction or interruption in trace mode" },
+    { "trace_close", GG_trace_close, METH_VARARGS,
+      "Stop recording and free the trace buffer" },
+    { "trace_open", GG_trace_open, METH_VARARGS,
+      "Record every step executed in trace mode into a ring buffer of at"
+      " least N fixed-size records (rounded up to a power of 2). If a"
+      " file name is given the buffer is mapped to that file" },
+    { "trace_read", GG_trace_read, METH_VARARGS,
+      "Read up to N records starting at record POS. Returns the next"
+      " position and the raw records as bytes (32 bytes each: pc H,"
+      " bank B, type B, nbytes B, nacc B, cc B, flags B, bytes 4s and 5"
+      " accesses of addr H, data B, type B)" },
+    { "trace_run", GG_trace_run_module, METH_VARARGS,
+      "Execute N steps in trace mode without returning to python. Returns"
+      " the number of cycles" },
     { NULL, NULL, 0, NULL }
   };
 
@@ -1103,6 +2008,10 @@ PyInit_GG (void)
   PyModule_AddIntConstant ( m, "NMI", Z80_STEP_NMI );
   PyModule_AddIntConstant ( m, "IRQ", Z80_STEP_IRQ );
   
+  /* Modes del perfilador. */
+  PyModule_AddIntConstant ( m, "PROF_EXACT", GG_PROF_EXACT );
+  PyModule_AddIntConstant ( m, "PROF_SAMPLING", GG_PROF_SAMPLING );
+  
   /* Mnemonics. */
   PyModule_AddIntConstant ( m, "UNK", Z80_UNK );
   PyModule_AddIntConstant ( m, "LD", Z80_LD );
@@ -1246,6 +2155,29 @@ PyInit_GG (void)
   PyModule_AddIntConstant ( m, "READ", GG_READ );
   PyModule_AddIntConstant ( m, "WRITE", GG_WRITE );
   
+  /* REGISTRE D'ACCESSOS. */
+  PyModule_AddIntConstant ( m, "ACCLOG_READ", GG_ACCLOG_READ );
+  PyModule_AddIntConstant ( m, "ACCLOG_WRITE", GG_ACCLOG_WRITE );
+  
+  /* PUNTS DE RUPTURA. */
+  PyModule_AddIntConstant ( m, "BREAK_NONE", GG_BREAK_NONE );
+  PyModule_AddIntConstant ( m, "BREAK_EXEC", GG_BREAK_EXEC );
+  PyModule_AddIntConstant ( m, "BREAK_RAM_READ", GG_BREAK_RAM_READ );
+  PyModule_AddIntConstant ( m, "BREAK_RAM_WRITE", GG_BREAK_RAM_WRITE );
+  PyModule_AddIntConstant ( m, "BREAK_VRAM_READ", GG_BREAK_VRAM_READ );
+  PyModule_AddIntConstant ( m, "BREAK_VRAM_WRITE", GG_BREAK_VRAM_WRITE );
+  PyModule_AddIntConstant ( m, "BREAK_IO_READ", GG_BREAK_IO_READ );
+  PyModule_AddIntConstant ( m, "BREAK_IO_WRITE", GG_BREAK_IO_WRITE );
+  PyModule_AddIntConstant ( m, "WATCH_RAM", GG_WATCH_RAM );
+  PyModule_AddIntConstant ( m, "WATCH_VRAM", GG_WATCH_VRAM );
+  PyModule_AddIntConstant ( m, "WATCH_IO", GG_WATCH_IO );
+  
+  /* PEL·LÍCULES. */
+  PyModule_AddIntConstant ( m, "MOVIE_NONE", GG_MOVIE_NONE );
+  PyModule_AddIntConstant ( m, "MOVIE_STOPPED", GG_MOVIE_STOPPED );
+  PyModule_AddIntConstant ( m, "MOVIE_RECORDING", GG_MOVIE_RECORDING );
+  PyModule_AddIntConstant ( m, "MOVIE_PLAYING", GG_MOVIE_PLAYING );
+  
   return m;
   
 } /* end PyInit_GG */
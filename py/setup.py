@@ -2,12 +2,28 @@ from distutils.core import setup, Extension
 
 module= Extension ( 'GG',
                     sources= [ 'ggmodule.c',
+                               '../src/acclog.c',
+                               '../src/audio.c',
+                               '../src/branch.c',
+                               '../src/break.c',
+                               '../src/clock.c',
+                               '../src/idle.c',
                                '../src/io.c',
                                '../src/control.c',
                                '../src/main.c',
+                               '../src/pacing.c',
+                               '../src/perf.c',
+                               '../src/prof.c',
                                '../src/mem.c',
+                               '../src/movie.c',
                                '../src/psg.c',
+                               '../src/rewind.c',
+                               '../src/rollback.c',
                                '../src/rom.c',
+                               '../src/runahead.c',
+                               '../src/state.c',
+                               '../src/tracer.c',
+                               '../src/turbo.c',
                                '../src/vdp.c',
                                'Z80/src/z80.c',
                                'Z80/src/z80_dis.c' ],
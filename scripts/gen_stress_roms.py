@@ -0,0 +1,606 @@
+#!/usr/bin/env python3
+#
+# Genera ROMs sintètiques que estressen cada part del simulador, per a
+# tindre càrregues de treball que es poden compartir (les ROMs
+# comercials no es poden pujar al repositori). Opcionalment les
+# executa amb tools/gg_bench i compara els resums amb una línia base
+# local, DIR/baseline.txt. El repositori no inclou resums de
+# referència: la línia base es grava amb la primera compilació que
+# s'executa (els que falten s'afegeixen, els distints sols es
+# sobreescriuen amb --update), per tant sols detecta canvis respecte a
+# eixa compilació, no que siga correcta.
+#
+#   gen_stress_roms.py DIR [--bench GG_BENCH] [--frames N] [--update]
+#
+
+import argparse
+import os
+import subprocess
+import sys
+
+
+BANK_SIZE= 0x4000
+
+# Ports.
+VDP_DATA= 0xBE
+VDP_CTRL= 0xBF
+PSG= 0x7F
+
+
+class Asm:
+    """Assemblador mínim de Z80. Sols les instruccions que fan falta."""
+
+    def __init__ ( self, size ):
+        self.rom= bytearray ( size )
+        self.pc= 0
+        self.labels= {}
+        self.fixups= []
+
+    def org ( self, addr ):
+        self.pc= addr
+
+    def label ( self, name ):
+        assert name not in self.labels, name
+        self.labels[name]= self.pc
+
+    def db ( self, *data ):
+        for b in data:
+            self.rom[self.pc]= b&0xFF
+            self.pc+= 1
+
+    def dw ( self, w ):
+        self.db ( w&0xFF, w>>8 )
+
+    def data ( self, data ):
+        self.rom[self.pc:self.pc+len(data)]= data
+        self.pc+= len(data)
+
+    def word ( self, op, arg ):
+        self.db ( *op )
+        if isinstance ( arg, str ):
+            self.fixups.append ( ('abs',self.pc,arg) )
+            self.dw ( 0 )
+        else: self.dw ( arg )
+
+    def rel ( self, op, label ):
+        self.db ( op )
+        self.fixups.append ( ('rel',self.pc,label) )
+        self.db ( 0 )
+
+    def link ( self ):
+        for kind,pos,label in self.fixups:
+            addr= self.labels[label]
+            if kind == 'abs':
+                self.rom[pos]= addr&0xFF
+                self.rom[pos+1]= addr>>8
+            else:
+                disp= addr-(pos+1)
+                assert -128 <= disp < 128, label
+                self.rom[pos]= disp&0xFF
+
+    # Control.
+    def di ( self ): self.db ( 0xF3 )
+    def ei ( self ): self.db ( 0xFB )
+    def im1 ( self ): self.db ( 0xED, 0x56 )
+    def halt ( self ): self.db ( 0x76 )
+    def ret ( self ): self.db ( 0xC9 )
+    def reti ( self ): self.db ( 0xED, 0x4D )
+    def retn ( self ): self.db ( 0xED, 0x45 )
+    def jp ( self, l ): self.word ( (0xC3,), l )
+    def call ( self, l ): self.word ( (0xCD,), l )
+    def jr ( self, l ): self.rel ( 0x18, l )
+    def jr_nz ( self, l ): self.rel ( 0x20, l )
+    def jr_z ( self, l ): self.rel ( 0x28, l )
+    def djnz ( self, l ): self.rel ( 0x10, l )
+
+    # Càrregues.
+    def ld_sp ( self, nn ): self.word ( (0x31,), nn )
+    def ld_hl ( self, nn ): self.word ( (0x21,), nn )
+    def ld_de ( self, nn ): self.word ( (0x11,), nn )
+    def ld_bc ( self, nn ): self.word ( (0x01,), nn )
+    def ld_a ( self, n ): self.db ( 0x3E, n )
+    def ld_b ( self, n ): self.db ( 0x06, n )
+    def ld_c ( self, n ): self.db ( 0x0E, n )
+    def ld_d ( self, n ): self.db ( 0x16, n )
+    def ld_e ( self, n ): self.db ( 0x1E, n )
+    def ld_mem_a ( self, nn ): self.word ( (0x32,), nn )
+    def ld_a_mem ( self, nn ): self.word ( (0x3A,), nn )
+    def ld_a_phl ( self ): self.db ( 0x7E )
+    def ld_phl_a ( self ): self.db ( 0x77 )
+    def ld_a_b ( self ): self.db ( 0x78 )
+    def ld_a_c ( self ): self.db ( 0x79 )
+    def ld_a_d ( self ): self.db ( 0x7A )
+    def ld_a_e ( self ): self.db ( 0x7B )
+    def ld_c_a ( self ): self.db ( 0x4F )
+    def ld_d_a ( self ): self.db ( 0x57 )
+    def ld_e_a ( self ): self.db ( 0x5F )
+    def ldir ( self ): self.db ( 0xED, 0xB0 )
+    def push_af ( self ): self.db ( 0xF5 )
+    def pop_af ( self ): self.db ( 0xF1 )
+    def push_bc ( self ): self.db ( 0xC5 )
+    def pop_bc ( self ): self.db ( 0xC1 )
+    def push_de ( self ): self.db ( 0xD5 )
+    def pop_de ( self ): self.db ( 0xD1 )
+    def push_hl ( self ): self.db ( 0xE5 )
+    def pop_hl ( self ): self.db ( 0xE1 )
+    def exx ( self ): self.db ( 0xD9 )
+    def ex_af ( self ): self.db ( 0x08 )
+
+    # Aritmètica.
+    def add_a ( self, n ): self.db ( 0xC6, n )
+    def and_ ( self, n ): self.db ( 0xE6, n )
+    def or_ ( self, n ): self.db ( 0xF6, n )
+    def xor_ ( self, n ): self.db ( 0xEE, n )
+    def or_c ( self ): self.db ( 0xB1 )
+    def add_a_b ( self ): self.db ( 0x80 )
+    def add_hl_de ( self ): self.db ( 0x19 )
+    def add_hl_hl ( self ): self.db ( 0x29 )
+    def inc_a ( self ): self.db ( 0x3C )
+    def inc_c ( self ): self.db ( 0x0C )
+    def inc_d ( self ): self.db ( 0x14 )
+    def inc_e ( self ): self.db ( 0x1C )
+    def inc_hl ( self ): self.db ( 0x23 )
+    def dec_d ( self ): self.db ( 0x15 )
+    def dec_bc ( self ): self.db ( 0x0B )
+    def rlca ( self ): self.db ( 0x07 )
+    def rrca ( self ): self.db ( 0x0F )
+
+    # Entrada/eixida.
+    def out ( self, n ): self.db ( 0xD3, n )
+    def in_ ( self, n ): self.db ( 0xDB, n )
+    def otir ( self ): self.db ( 0xED, 0xB3 )
+
+
+def vdp_regs ( values ):
+    """Parells (valor, 0x80|registre) per a escriure amb OTIR."""
+    ret= bytearray ()
+    for reg,val in enumerate ( values ):
+        ret+= bytes ( (val,0x80|reg) )
+    return ret
+
+
+def tiles ( n ):
+    """N 'tiles' amb patrons distints i asimètrics (perquè el volteig
+    horitzontal canvie el resultat)."""
+    ret= bytearray ()
+    for t in range ( n ):
+        for row in range ( 8 ):
+            for plane in range ( 4 ):
+                ret.append ( ((t*37 + row*11 + plane*5)*0x9D >> 3) & 0xFF )
+    return ret
+
+
+def palette ():
+    """64 bytes de CRAM (32 colors de 12 bits)."""
+    ret= bytearray ()
+    for i in range ( 32 ):
+        c= (i*0x135) & 0xFFF
+        ret+= bytes ( (c&0xFF,c>>8) )
+    return ret
+
+
+def name_table ( flags ):
+    """32x28 entrades. FLAGS és el byte alt (bit 1 volteig horitzontal,
+    bit 2 vertical, bit 3 paleta)."""
+    ret= bytearray ()
+    for i in range ( 32*28 ):
+        ret+= bytes ( (i&0xFF, (flags(i)&0x0E) | ((i>>8)&0x1)) )
+    return ret
+
+
+def prologue ( a, isr= None ):
+    """Vectors, inicialització i rutines comunes. Tot abans de 0x400
+    perquè no es mou amb el 'mapper'."""
+    a.org ( 0x0000 )
+    a.di ()
+    a.im1 ()
+    a.ld_sp ( 0xDFF0 )
+    a.jp ( 'main' )
+    a.org ( 0x0038 )
+    if isr is None:
+        a.push_af ()
+        a.in_ ( VDP_CTRL )
+        a.pop_af ()
+        a.ei ()
+        a.reti ()
+    else: a.jp ( isr )
+    a.org ( 0x0066 )
+    a.retn ()
+    a.org ( 0x0080 )
+    # HL: taula, B: bytes. Escriu en el port de control.
+    a.label ( 'vdp_ctrl_table' )
+    a.ld_c ( VDP_CTRL )
+    a.otir ()
+    a.ret ()
+    # HL: dades, D: blocs de 256 bytes. Escriu en el port de dades.
+    a.label ( 'vdp_data_blocks' )
+    a.ld_c ( VDP_DATA )
+    a.label ( 'vdp_data_blocks_loop' )
+    a.ld_b ( 0 )
+    a.otir ()
+    a.dec_d ()
+    a.jr_nz ( 'vdp_data_blocks_loop' )
+    a.ret ()
+    # A: byte baix i E: byte alt de l'adreça VRAM/CRAM amb el codi.
+    a.label ( 'vdp_addr' )
+    a.out ( VDP_CTRL )
+    a.ld_a_e ()
+    a.out ( VDP_CTRL )
+    a.ret ()
+
+
+def setup_video ( a, regs, nt_flags, ntiles= 256 ):
+    """Registres, paleta, 'tiles' a 0x0000 i taula de noms a 0x3800."""
+    a.ld_hl ( 'regs' )
+    a.ld_b ( len(regs)*2 )
+    a.call ( 'vdp_ctrl_table' )
+    a.ld_a ( 0x00 )
+    a.ld_e ( 0xC0 )
+    a.call ( 'vdp_addr' )
+    a.ld_hl ( 'palette' )
+    a.ld_b ( 64 )
+    a.ld_c ( VDP_DATA )
+    a.otir ()
+    a.ld_a ( 0x00 )
+    a.ld_e ( 0x40 )
+    a.call ( 'vdp_addr' )
+    a.ld_hl ( 'tiles' )
+    a.ld_d ( ntiles*32//256 )
+    a.call ( 'vdp_data_blocks' )
+    a.ld_a ( 0x00 )
+    a.ld_e ( 0x78 )
+    a.call ( 'vdp_addr' )
+    a.ld_hl ( 'names' )
+    a.ld_d ( 7 )
+    a.call ( 'vdp_data_blocks' )
+    return { 'regs': vdp_regs ( regs ), 'palette': palette (),
+             'tiles': tiles ( ntiles ), 'names': name_table ( nt_flags ) }
+
+
+def put_tables ( a, tables, addr ):
+    a.org ( addr )
+    for name,data in tables.items ():
+        a.label ( name )
+        a.data ( data )
+
+
+def header ( rom ):
+    """Capçalera en 0x7FF0 amb la suma de comprovació."""
+    size_code= { 0x8000: 0xC, 0x10000: 0xE, 0x20000: 0xF, 0x40000: 0x0 }
+    code= size_code[len(rom)]
+    rom[0x7FF0:0x7FF8]= b'TMR SEGA'
+    rom[0x7FF8:0x7FFA]= b'\x00\x00'
+    rom[0x7FFC:0x7FFF]= b'\x99\x99\x00'
+    rom[0x7FFF]= 0x70 | code
+    csum= sum ( rom[:0x7FF0] ) + sum ( rom[0x8000:] )
+    rom[0x7FFA]= csum&0xFF
+    rom[0x7FFB]= (csum>>8)&0xFF
+
+
+def rom_vdp_hflip_scroll ():
+    """Pantalla completa de 'tiles' voltejats horitzontalment i
+    desplaçament X diferent en cada línia (interrupció de línia)."""
+    a= Asm ( 0x8000 )
+    prologue ( a, 'isr' )
+    a.label ( 'main' )
+    tables= setup_video ( a,
+                          [0x16,0xE0,0xFF,0xFF,0xFF,0xFF,0xFB,0x00,
+                           0x00,0x00,0x00],
+                          lambda i: 0x02 | ((i&0x10)>>1) )
+    a.ei ()
+    a.label ( 'idle' )
+    a.halt ()
+    a.jr ( 'idle' )
+    # Interrupció: en la de 'frame' torna el desplaçament a 0, en les de
+    # línia el suma 3.
+    a.label ( 'isr' )
+    a.push_af ()
+    a.in_ ( VDP_CTRL )
+    a.and_ ( 0x80 )
+    a.jr_z ( 'isr_line' )
+    a.xor_ ( 0x80 )
+    a.ld_mem_a ( 0xC000 )
+    a.jr ( 'isr_out' )
+    a.label ( 'isr_line' )
+    a.ld_a_mem ( 0xC000 )
+    a.add_a ( 3 )
+    a.ld_mem_a ( 0xC000 )
+    a.out ( VDP_CTRL )
+    a.ld_a ( 0x88 )
+    a.out ( VDP_CTRL )
+    a.label ( 'isr_out' )
+    a.pop_af ()
+    a.ei ()
+    a.reti ()
+    put_tables ( a, tables, 0x0400 )
+    a.link ()
+    return a.rom
+
+
+def rom_vdp_sprites ():
+    """64 sprites de 8x16 ampliats (16x32) repartits perquè totes les
+    línies en tinguen més de 8. Es mouen cada 'frame'."""
+    a= Asm ( 0x8000 )
+    prologue ( a, 'isr' )
+    a.label ( 'main' )
+    tables= setup_video ( a,
+                          [0x06,0xE3,0xFF,0xFF,0xFF,0xFF,0xFB,0x00,
+                           0x00,0x00,0xFF],
+                          lambda i: 0x00 )
+    a.ld_a ( 0x00 )
+    a.ld_e ( 0x7F )
+    a.call ( 'vdp_addr' )
+    a.ld_hl ( 'sat_y' )
+    a.ld_b ( 64 )
+    a.ld_c ( VDP_DATA )
+    a.otir ()
+    a.ei ()
+    a.label ( 'idle' )
+    a.halt ()
+    a.jr ( 'idle' )
+    # Interrupció de 'frame': reescriu les X i els 'tiles'.
+    a.label ( 'isr' )
+    a.push_af ()
+    a.push_bc ()
+    a.push_de ()
+    a.in_ ( VDP_CTRL )
+    a.ld_a ( 0x80 )
+    a.ld_e ( 0x7F )
+    a.call ( 'vdp_addr' )
+    a.ld_a_mem ( 0xC000 )
+    a.inc_a ()
+    a.ld_mem_a ( 0xC000 )
+    a.ld_d_a ()
+    a.ld_e ( 0 )
+    a.ld_b ( 64 )
+    a.label ( 'isr_loop' )
+    a.ld_a_d ()
+    a.out ( VDP_DATA )
+    a.add_a ( 3 )
+    a.ld_d_a ()
+    a.ld_a_e ()
+    a.out ( VDP_DATA )
+    a.add_a ( 2 )
+    a.ld_e_a ()
+    a.djnz ( 'isr_loop' )
+    a.pop_de ()
+    a.pop_bc ()
+    a.pop_af ()
+    a.ei ()
+    a.reti ()
+    tables['sat_y']= bytes ( (i*3)%184 for i in range ( 64 ) )
+    put_tables ( a, tables, 0x0400 )
+    a.link ()
+    return a.rom
+
+
+def rom_mapper ():
+    """256KB. Canvia contínuament els tres bancs del 'mapper' i llig de
+    cadascun."""
+    nbanks= 16
+    a= Asm ( nbanks*BANK_SIZE )
+    for b in range ( nbanks ):
+        a.rom[b*BANK_SIZE:(b+1)*BANK_SIZE]= bytes ( (b,) )*BANK_SIZE
+    prologue ( a )
+    a.label ( 'main' )
+    a.ld_hl ( 'regs' )
+    a.ld_b ( 22 )
+    a.call ( 'vdp_ctrl_table' )
+    a.ld_c ( 1 )
+    a.label ( 'loop' )
+    a.ld_a_c ()
+    a.ld_mem_a ( 0xFFFD )
+    a.inc_a ()
+    a.and_ ( nbanks-1 )
+    a.ld_mem_a ( 0xFFFE )
+    a.inc_a ()
+    a.and_ ( nbanks-1 )
+    a.ld_mem_a ( 0xFFFF )
+    a.ld_a_mem ( 0x0400 )
+    a.ld_a_mem ( 0x4000 )
+    a.ld_a_mem ( 0xBFFF )
+    a.ld_mem_a ( 0xC000 )
+    a.inc_c ()
+    a.ld_a_c ()
+    a.and_ ( nbanks-1 )
+    a.ld_c_a ()
+    a.jr ( 'loop' )
+    a.label ( 'regs' )
+    a.data ( vdp_regs ( [0x06,0x80,0xFF,0xFF,0xFF,0xFF,0xFB,0x00,
+                         0x00,0x00,0xFF] ) )
+    assert a.pc <= 0x400
+    a.link ()
+    return a.rom
+
+
+def rom_psg ():
+    """Escriu contínuament tots els registres del PSG i l'estèreo."""
+    a= Asm ( 0x8000 )
+    prologue ( a )
+    a.label ( 'main' )
+    a.ld_hl ( 'regs' )
+    a.ld_b ( 22 )
+    a.call ( 'vdp_ctrl_table' )
+    a.ld_e ( 0 )
+    a.label ( 'loop' )
+    for latch in (0x80,0xA0,0xC0):
+        a.ld_a_e ()
+        a.and_ ( 0x0F )
+        a.or_ ( latch )
+        a.out ( PSG )
+        a.ld_a_e ()
+        a.rrca ()
+        a.rrca ()
+        a.and_ ( 0x3F )
+        a.out ( PSG )
+        a.ld_a_e ()
+        a.and_ ( 0x0F )
+        a.or_ ( latch|0x10 )
+        a.out ( PSG )
+    a.ld_a_e ()
+    a.and_ ( 0x07 )
+    a.or_ ( 0xE0 )
+    a.out ( PSG )
+    a.ld_a_e ()
+    a.or_ ( 0xF0 )
+    a.out ( PSG )
+    a.ld_a_e ()
+    a.out ( 0x06 )
+    a.inc_e ()
+    a.jr ( 'loop' )
+    a.label ( 'regs' )
+    a.data ( vdp_regs ( [0x06,0x80,0xFF,0xFF,0xFF,0xFF,0xFB,0x00,
+                         0x00,0x00,0xFF] ) )
+    a.link ()
+    return a.rom
+
+
+def rom_io ():
+    """Bucle de lectures i escriptures en tots els ports."""
+    a= Asm ( 0x8000 )
+    prologue ( a )
+    a.label ( 'main' )
+    a.ld_hl ( 'regs' )
+    a.ld_b ( 22 )
+    a.call ( 'vdp_ctrl_table' )
+    a.label ( 'loop' )
+    for port in (0x00,0x01,0x02,0x03,0x04,0x05,0x7E,0x7F,0xBF,0xBE,
+                 0xDC,0xDD):
+        a.in_ ( port )
+    a.out ( 0x06 )
+    a.out ( 0x3F )
+    a.out ( 0x01 )
+    a.jr ( 'loop' )
+    a.label ( 'regs' )
+    a.data ( vdp_regs ( [0x06,0x80,0xFF,0xFF,0xFF,0xFF,0xFB,0x00,
+                         0x00,0x00,0xFF] ) )
+    a.link ()
+    return a.rom
+
+
+def rom_cpu ():
+    """Còpies de blocs en RAM i aritmètica amb els registres
+    alternatius, sense vídeo."""
+    a= Asm ( 0x8000 )
+    prologue ( a )
+    a.label ( 'main' )
+    a.ld_hl ( 'regs' )
+    a.ld_b ( 22 )
+    a.call ( 'vdp_ctrl_table' )
+    a.label ( 'loop' )
+    a.ld_hl ( 0x0400 )
+    a.ld_de ( 0xC000 )
+    a.ld_bc ( 0x1000 )
+    a.ldir ()
+    a.ld_hl ( 0xC000 )
+    a.ld_de ( 0xD000 )
+    a.ld_bc ( 0x0800 )
+    a.ldir ()
+    a.ld_b ( 0 )
+    a.label ( 'alu' )
+    a.exx ()
+    a.ex_af ()
+    a.ld_hl ( 0x1234 )
+    a.ld_de ( 0x0101 )
+    a.add_hl_de ()
+    a.add_hl_hl ()
+    a.push_hl ()
+    a.pop_de ()
+    a.rlca ()
+    a.xor_ ( 0x5A )
+    a.ex_af ()
+    a.exx ()
+    a.djnz ( 'alu' )
+    a.jr ( 'loop' )
+    a.label ( 'regs' )
+    a.data ( vdp_regs ( [0x06,0x80,0xFF,0xFF,0xFF,0xFF,0xFB,0x00,
+                         0x00,0x00,0xFF] ) )
+    a.link ()
+    return a.rom
+
+
+ROMS= [ ('vdp_hflip_scroll',rom_vdp_hflip_scroll),
+        ('vdp_sprites',rom_vdp_sprites),
+        ('mapper',rom_mapper),
+        ('psg',rom_psg),
+        ('io',rom_io),
+        ('cpu',rom_cpu) ]
+
+
+def bench ( gg_bench, fn, frames ):
+    out= subprocess.run ( [gg_bench,fn,str(frames)], check= True,
+                          stdout= subprocess.PIPE,
+                          universal_newlines= True ).stdout
+    ret= {}
+    for line in out.splitlines ():
+        fields= line.split ( None, 1 )
+        if len(fields) == 2: ret[fields[0]]= fields[1]
+    return ret
+
+
+def main ():
+    parser= argparse.ArgumentParser (
+        description= 'Generate synthetic stress ROMs' )
+    parser.add_argument ( 'dir', help= 'output directory' )
+    parser.add_argument ( '--bench', metavar= 'GG_BENCH',
+                          help= 'run every ROM with gg_bench' )
+    parser.add_argument ( '--frames', type= int, default= 3000 )
+    parser.add_argument ( '--update', action= 'store_true',
+                          help= 'overwrite mismatching baseline hashes' )
+    args= parser.parse_args ()
+
+    os.makedirs ( args.dir, exist_ok= True )
+    fns= []
+    for name,gen in ROMS:
+        rom= gen ()
+        header ( rom )
+        fn= os.path.join ( args.dir, name+'.gg' )
+        with open ( fn, 'wb' ) as f: f.write ( rom )
+        fns.append ( (name,fn) )
+        print ( '%-18s %7d bytes'%(fn,len(rom)) )
+    if args.bench is None: return 0
+
+    # Línia base local. Les entrades noves s'afegeixen sempre, les que
+    # no coincideixen sols es sobreescriuen amb --update.
+    hashes_fn= os.path.join ( args.dir, 'baseline.txt' )
+    known= {}
+    if os.path.exists ( hashes_fn ):
+        with open ( hashes_fn ) as f:
+            for line in f:
+                name,frames,fhash,shash= line.split ()
+                known[(name,int(frames))]= (fhash,shash)
+    ret= 0
+    changed= False
+    for name,fn in fns:
+        res= bench ( args.bench, fn, args.frames )
+        got= (res['frame_hash'],res['state_hash'])
+        entry= (name,args.frames)
+        exp= known.get ( entry )
+        if exp is None:
+            status= 'recorded'
+            known[entry]= got
+            changed= True
+        elif exp == got: status= 'ok'
+        elif args.update:
+            status= 'updated'
+            known[entry]= got
+            changed= True
+        else:
+            status= 'MISMATCH'
+            ret= 1
+        print ( '%-18s %10s fps %12s ns/frame  %s'%
+                (name,res['fps'],res['ns/frame'],status) )
+        for key in sorted ( res ):
+            if key.startswith ( 'perf.' ):
+                print ( '    %-18s %s'%(key[5:],res[key]) )
+    if changed:
+        with open ( hashes_fn, 'w' ) as f:
+            for (name,frames),(fhash,shash) in known.items ():
+                f.write ( '%s %d %s %s\n'%(name,frames,fhash,shash) )
+        print ( 'baseline written to %s (not verified, taken from this'
+                ' build)'%hashes_fn )
+    return ret
+
+
+if __name__ == '__main__':
+    sys.exit ( main () )
@@ -25,6 +25,7 @@
 #define __GG_H__
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -43,6 +44,94 @@ typedef void
               ...
               );
 
+/* Resum de 64 bits de l'estat de la màquina. */
+typedef uint64_t GG_Hash;
+
+/* Barreja els bits de KEY (finalitzador de 'splitmix64'). Les
+ * memòries es resumixen com l'XOR de GG_hash_mix aplicat a cada
+ * parell (adreça,valor), d'aquesta manera es pot actualitzar el
+ * resum en cada escriptura.
+ */
+static inline GG_Hash
+GG_hash_mix (
+             GG_Hash key
+             )
+{
+  
+  key^= key>>30; key*= 0xbf58476d1ce4e5b9ULL;
+  key^= key>>27; key*= 0x94d049bb133111ebULL;
+  key^= key>>31;
+  
+  return key;
+  
+} /* end GG_hash_mix */
+
+/* Zones de memòria que es resumixen incrementalment. */
+#define GG_HASH_RAM  1
+#define GG_HASH_SRAM 2
+#define GG_HASH_VRAM 3
+#define GG_HASH_CRAM 4
+
+/* Clau per a GG_hash_mix del byte VAL de l'adreça ADDR de la memòria
+ * AREA.
+ */
+#define GG_HASH_KEY(AREA,ADDR,VAL)        			\
+  ((((GG_Hash) (AREA))<<32) | (((GG_Hash) (ADDR))<<8) | (VAL))
+
+/* Actualitza el resum HASH quan el byte ADDR de AREA passa de OLD a
+ * NEW.
+ */
+#define GG_HASH_UPDATE(HASH,AREA,ADDR,OLD,NEW)        		\
+  if ( (OLD) != (NEW) )        					\
+    (HASH)^= GG_hash_mix ( GG_HASH_KEY ( AREA, ADDR, OLD ) ) ^        \
+      GG_hash_mix ( GG_HASH_KEY ( AREA, ADDR, NEW ) )
+
+/* Resum sencer dels SIZE bytes de la memòria MEM de la zona AREA.
+ * Es gasta quan es carrega l'estat.
+ */
+static inline GG_Hash
+GG_hash_area (
+              const Z80u8  *mem,
+              const size_t  size,
+              const int     area
+              )
+{
+  
+  GG_Hash hash;
+  size_t i;
+  
+  
+  hash= 0;
+  for ( i= 0; i < size; ++i )
+    hash^= GG_hash_mix ( GG_HASH_KEY ( area, i, mem[i] ) );
+  
+  return hash;
+  
+} /* end GG_hash_area */
+
+/* Acumula en HASH els N bytes de DATA. Per a l'estat menut
+ * (registres) que es resumix quan es demana.
+ */
+static inline GG_Hash
+GG_hash_bytes (
+               GG_Hash      hash,
+               const void  *data,
+               const size_t n
+               )
+{
+  
+  const Z80u8 *p;
+  size_t i;
+  
+  
+  p= (const Z80u8 *) data;
+  for ( i= 0; i < n; ++i )
+    hash= GG_hash_mix ( hash ^ GG_HASH_KEY ( 0, i, p[i] ) );
+  
+  return hash;
+  
+} /* end GG_hash_bytes */
+
 
 
 
@@ -113,6 +202,303 @@ GG_rom_get_header (
         	   GG_RomHeader *header
         	   );
 
+/* CRC-32 (el mateix que calculen 'zip' i les bases de dades de ROMs)
+ * de tota la ROM.
+ */
+uint32_t
+GG_rom_crc32 (
+              const GG_Rom *rom
+              );
+
+
+/*********/
+/* STATE */
+/*********/
+/* Format d'estat portable. Després d'una capçalera (marca, versió i
+ * grandària) van una sèrie de trossos, cadascun amb un identificador
+ * de 4 caràcters, la grandària i les dades. Tots els enters es
+ * guarden en 'little-endian' i camp a camp, per tant no depén del
+ * compilador ni de l'arquitectura. L'única excepció és el tros de la
+ * UCP, que és el que guarda la llibreria Z80. Els trossos desconeguts
+ * s'ignoren.
+ *
+ * Capçalera:
+ *
+ *   char     magic[8]   - GG_STATE_MAGIC
+ *   uint32_t version    - GG_STATE_VERSION
+ *   uint32_t size       - Bytes de la resta de l'estat.
+ *
+ * Tros:
+ *
+ *   uint32_t id         - GG_STATE_ID.
+ *   uint32_t size       - Bytes de les dades.
+ *   Z80u8    data[size]
+ */
+
+#define GG_STATE_MAGIC "GGSTATP\n"
+#define GG_STATE_HEADER_SIZE 16
+#define GG_STATE_VERSION 1
+
+/* Número màxim de trossos en un estat. */
+#define GG_STATE_MAX_CHUNKS 32
+
+/* Identificador d'un tros. */
+#define GG_STATE_ID(A,B,C,D)        				\
+  (((uint32_t) (A)) | (((uint32_t) (B))<<8) |        		\
+   (((uint32_t) (C))<<16) | (((uint32_t) (D))<<24))
+
+#define GG_STATE_Z80  GG_STATE_ID ( 'Z', '8', '0', ' ' )
+#define GG_STATE_MAPR GG_STATE_ID ( 'M', 'A', 'P', 'R' )
+#define GG_STATE_RAM  GG_STATE_ID ( 'R', 'A', 'M', ' ' )
+#define GG_STATE_SRAM GG_STATE_ID ( 'S', 'R', 'A', 'M' )
+#define GG_STATE_VDP  GG_STATE_ID ( 'V', 'D', 'P', ' ' )
+#define GG_STATE_VRAM GG_STATE_ID ( 'V', 'R', 'A', 'M' )
+#define GG_STATE_CRAM GG_STATE_ID ( 'C', 'R', 'A', 'M' )
+#define GG_STATE_FB   GG_STATE_ID ( 'F', 'B', ' ', ' ' )
+#define GG_STATE_PSG  GG_STATE_ID ( 'P', 'S', 'G', ' ' )
+
+/* Índex dels trossos d'un estat. Les dades apunten dins del buffer
+ * indexat.
+ */
+typedef struct
+{
+  
+  uint32_t version;
+  int      N;
+  struct
+  {
+    uint32_t     id;
+    size_t       size;
+    const Z80u8 *data;
+  }        v[GG_STATE_MAX_CHUNKS];
+  
+} GG_StateChunks;
+
+/* Indexa l'estat de SIZE bytes en BUF (amb capçalera). Torna 0 si tot
+ * ha anat bé, -1 si no és un estat vàlid o és d'una versió
+ * posterior.
+ */
+int
+GG_state_index (
+        	const Z80u8    *buf,
+        	const size_t    size,
+        	GG_StateChunks *chunks
+        	);
+
+/* Busca el tros ID. Torna NULL si no està, en cas contrari les dades
+ * i la grandària en SIZE (pot ser NULL). Permet, per exemple, llegir
+ * sols la RAM d'un estat sense carregar-lo.
+ */
+const Z80u8 *
+GG_state_get_chunk (
+        	    const GG_StateChunks *chunks,
+        	    const uint32_t        id,
+        	    size_t               *size
+        	    );
+
+/* Funcions per als mòduls. */
+
+/* Escriu la capçalera en BUF i torna on comencen els trossos. */
+Z80u8 *
+GG_state_begin (
+        	Z80u8 *buf
+        	);
+
+/* Completa la capçalera de l'estat que comença en BUF i acaba en
+ * END. Torna la grandària total.
+ */
+size_t
+GG_state_end (
+              Z80u8       *buf,
+              const Z80u8 *end
+              );
+
+/* Comença el tros ID en BUF i torna on van les dades. */
+Z80u8 *
+GG_state_begin_chunk (
+        	      Z80u8          *buf,
+        	      const uint32_t  id
+        	      );
+
+/* Tanca el tros que té les dades en [DATA,END[. Torna END. */
+Z80u8 *
+GG_state_end_chunk (
+        	    Z80u8 *data,
+        	    Z80u8 *end
+        	    );
+
+Z80u8 *
+GG_state_put_u16 (
+        	  Z80u8        *buf,
+        	  const Z80u16  val
+        	  );
+
+Z80u8 *
+GG_state_put_u32 (
+        	  Z80u8          *buf,
+        	  const uint32_t  val
+        	  );
+
+/* Les funcions de lectura no passen de END i tornen NULL si no hi ha
+ * prou dades.
+ */
+const Z80u8 *
+GG_state_get_u8 (
+        	 const Z80u8 *buf,
+        	 const Z80u8 *end,
+        	 Z80u8       *val
+        	 );
+
+const Z80u8 *
+GG_state_get_u16 (
+        	  const Z80u8 *buf,
+        	  const Z80u8 *end,
+        	  Z80u16      *val
+        	  );
+
+const Z80u8 *
+GG_state_get_u32 (
+        	  const Z80u8 *buf,
+        	  const Z80u8 *end,
+        	  uint32_t    *val
+        	  );
+
+/* Macros per als GG_*_save_state_mem i GG_*_load_state_mem dels
+ * mòduls, que bolquen directament les variables. Esperen els punters
+ * 'buf' (i 'end' per a llegir) i tornen NULL si hi ha un error.
+ */
+#define GG_SAVE_MEM(VAR)        					\
+  memcpy ( buf, &(VAR), sizeof(VAR) ); buf+= sizeof(VAR)
+
+#define GG_LOAD_MEM(VAR)        					\
+  if ( (size_t) (end-buf) < sizeof(VAR) ) return NULL;        	\
+  memcpy ( &(VAR), buf, sizeof(VAR) ); buf+= sizeof(VAR)
+
+#define GG_CHECK_MEM(COND)        					\
+  if ( !(COND) ) return NULL;
+
+
+/**********/
+/* BRANCH */
+/**********/
+/* Bifurcacions de l'estat de la màquina. Una bifurcació és una
+ * captura de l'estat que es pot carregar tantes vegades com es
+ * vulga, pensada per a explorar moltes entrades distintes a partir
+ * del mateix punt. La RAM, la SRAM i la VRAM es guarden en pàgines
+ * de GG_PAGE_SIZE bytes amb comptador de referències compartides
+ * entre totes les bifurcacions i la màquina, i sols es copien les
+ * pàgines que s'han escrit des de l'última bifurcació. La ROM no
+ * forma part de l'estat, per tant sempre es comparteix. La resta de
+ * l'estat (registres, CRAM, línies pendents i so) es guarda en
+ * format portable (veure STATE).
+ *
+ * La màquina continua treballant sobre les seues memòries (la
+ * lectura no canvia), i per a cada pàgina recorda la pàgina
+ * compartida amb el mateix contingut, si n'hi ha. La primera
+ * escriptura en una pàgina deixa de compartir-la.
+ */
+
+#define GG_PAGE_SIZE 1024
+
+#define GG_RAM_PAGES  ((8*1024)/GG_PAGE_SIZE)
+#define GG_SRAM_PAGES ((32*1024)/GG_PAGE_SIZE)
+#define GG_VRAM_PAGES ((16*1024)/GG_PAGE_SIZE)
+
+typedef struct
+{
+  
+  int   refs;
+  Z80u8 data[GG_PAGE_SIZE];
+  
+} GG_Page;
+
+/* Bifurcació (opaca). */
+typedef struct GG_Branch GG_Branch;
+
+/* Estadístiques del mòdul. */
+typedef struct
+{
+  
+  int    branches;     /* Bifurcacions vives. */
+  int    pages;        /* Pàgines vives. */
+  size_t bytes;        /* Memòria total emprada. */
+  
+} GG_BranchStats;
+
+/* Crea una bifurcació amb l'estat actual. Torna NULL en cas
+ * d'error. Sols es pot carregar amb la ROM actual.
+ */
+GG_Branch *
+GG_branch_new (void);
+
+/* Carrega la bifurcació BRANCH, que no es modifica. Torna 0 si tot
+ * ha anat bé. En cas d'error es reinicia el simulador.
+ */
+int
+GG_branch_load (
+        	const GG_Branch *branch
+        	);
+
+void
+GG_branch_free (
+        	GG_Branch *branch
+        	);
+
+void
+GG_branch_get_stats (
+        	     GG_BranchStats *stats
+        	     );
+
+/* Funcions per als mòduls. Una taula és un vector de N pàgines que
+ * es correspon amb la memòria MEM de N*GG_PAGE_SIZE bytes. Les
+ * entrades a NULL indiquen que la pàgina no es comparteix.
+ */
+
+/* Copia en OUT les pàgines de TABLE, creant-ne de noves per a les
+ * que no es compartixen. Torna 0 si tot ha anat bé, -1 si no queda
+ * memòria (les pàgines ja copiades en OUT són vàlides).
+ */
+int
+GG_page_share (
+               GG_Page     *table[],
+               const Z80u8 *mem,
+               const int    N,
+               GG_Page     *out[]
+               );
+
+/* Passa a MEM el contingut de les pàgines IN, copiant sols les que
+ * són distintes a les de TABLE.
+ */
+void
+GG_page_restore (
+        	 GG_Page       *table[],
+        	 Z80u8         *mem,
+        	 const int      N,
+        	 GG_Page *const in[]
+        	 );
+
+/* Deixa de compartir totes les pàgines de TABLE. */
+void
+GG_page_release (
+        	 GG_Page   *table[],
+        	 const int  N
+        	 );
+
+void
+GG_page_unref (
+               GG_Page *page
+               );
+
+/* S'ha de cridar abans d'escriure en l'adreça ADDR de la memòria
+ * que té les pàgines en TABLE.
+ */
+#define GG_PAGE_UNSHARE(TABLE,ADDR)        			\
+  if ( (TABLE)[(ADDR)/GG_PAGE_SIZE] != NULL )        		\
+    {        							\
+      GG_page_unref ( (TABLE)[(ADDR)/GG_PAGE_SIZE] );        	\
+      (TABLE)[(ADDR)/GG_PAGE_SIZE]= NULL;        		\
+    }
+
 
 /*******/
 /* MEM */
@@ -126,6 +512,15 @@ typedef Z80u8 * (GG_GetExternalRAM) (
         			     void *udata
         			     );
 
+/* Tipus de la funció que avisa que el joc ha modificat la RAM externa
+ * (per exemple, per a programar una escriptura de la partida
+ * guardada amb GG_mem_flush_sram). Es crida al final del 'frame', com
+ * a molt una vegada per 'frame'.
+ */
+typedef void (GG_SRAMChanged) (
+        		       void *udata
+        		       );
+
 /* Tipus d'accessos a memòria RAM. */
 typedef enum
   {
@@ -172,6 +567,68 @@ typedef struct
   
 } GG_MapperState;
 
+/* Escriu amb 'pwrite' en el descriptor FD, a partir de la posició
+ * OFFSET, les pàgines de la RAM externa modificades des de l'última
+ * vegada (veure GG_mem_get_sram_dirty) i les marca com a netes. Les
+ * pàgines seguides s'escriuen d'una vegada. Torna el número de
+ * pàgines escrites o -1 en cas d'error.
+ */
+int
+GG_mem_flush_sram (
+        	   const int     fd,
+        	   const int64_t offset
+        	   );
+
+/* S'ha de cridar al final de cada 'frame'. Ho fa la pròpia llibreria. */
+void
+GG_mem_frame (void);
+
+/* Torna un mapa de bits amb les pàgines de GG_PAGE_SIZE bytes de la
+ * RAM externa (el bit I és la pàgina I) modificades pel joc o per
+ * una càrrega de l'estat des de l'última vegada que es van netejar.
+ * Si CLEAR és cert es netegen. Permet, per exemple, fer 'msync'
+ * sols de les pàgines modificades si la RAM externa és un fitxer
+ * mapejat amb 'mmap'.
+ */
+uint32_t
+GG_mem_get_sram_dirty (
+        	       const Z80_Bool clear
+        	       );
+
+/* Delimiten un tram en el qual la pròpia llibreria carrega estats i
+ * executa 'frames' que el 'frontend' no veu (execució anticipada,
+ * tornar a simular en ROLLBACK, avançar en GG_movie_seek). Les marques
+ * de la SRAM del tram es descarten i al final sols es marquen com a
+ * modificades les pàgines que són distintes de com estaven al
+ * principi, així restaurar el que ja estava no provoca escriptures.
+ * Es poden niuar. Ho fa la pròpia llibreria.
+ */
+void
+GG_mem_begin_speculative (void);
+
+void
+GG_mem_end_speculative (void);
+
+/* Resum de la RAM, la SRAM i l'estat del mapejador. El resum de les
+ * memòries s'actualitza en cada escriptura, per tant és molt barat.
+ */
+GG_Hash
+GG_mem_get_hash (void);
+
+/* Torna el banc de ROM mapejat en ADDR, o -1 si ADDR correspon a
+ * RAM o a SRAM.
+ */
+int
+GG_mem_get_bank (
+        	 const Z80u16 addr
+        	 );
+
+/* Torna cert si ADDR correspon a SRAM. */
+Z80_Bool
+GG_mem_is_sram (
+        	const Z80u16 addr
+        	);
+
 /* Obté en la variable indicada l'estat actual del mapejador de
  * memòria.
  */
@@ -189,6 +646,7 @@ GG_mem_init (
              GG_GetExternalRAM *get_external_ram,
              GG_MemAccess      *mem_acces,           /* Pot ser NULL. */
              GG_MapperChanged  *mapper_changed,      /* Pot ser NULL. */
+             GG_SRAMChanged    *sram_changed,        /* Pot ser NULL. */
              void              *udata
              );
 
@@ -204,6 +662,22 @@ GG_mem_set_mode_trace (
         	       const Z80_Bool val
         	       );
 
+/* Activa o desactiva el registre dels accessos. Ho fa el mòdul
+ * ACCLOG.
+ */
+void
+GG_mem_set_log (
+        	const Z80_Bool val
+        	);
+
+/* Activa o desactiva la comprovació dels 'watchpoints' de RAM en
+ * cada accés. Ho fa el mòdul BREAK.
+ */
+void
+GG_mem_set_watch (
+        	  const Z80_Bool val
+        	  );
+
 int
 GG_mem_save_state (
         	   FILE *f
@@ -214,6 +688,65 @@ GG_mem_load_state (
         	   FILE *f
         	   );
 
+/* Grandària màxima en bytes de l'estat guardat en memòria. */
+size_t
+GG_mem_state_size (void);
+
+/* Com GG_mem_save_state però escriu en BUF, que ha de tindre com a
+ * mínim GG_mem_state_size bytes. Torna el punter al següent byte
+ * lliure.
+ */
+Z80u8 *
+GG_mem_save_state_mem (
+        	       Z80u8 *buf
+        	       );
+
+/* Com GG_mem_load_state però llig de BUF sense passar de END. Torna
+ * el punter al següent byte a llegir o NULL en cas d'error.
+ */
+const Z80u8 *
+GG_mem_load_state_mem (
+        	       const Z80u8 *buf,
+        	       const Z80u8 *end
+        	       );
+
+/* Escriu en BUF els trossos del format portable (veure STATE) amb
+ * el mapejador, i la RAM i la SRAM si MEMORIES és cert. Torna el
+ * punter al següent byte lliure.
+ */
+Z80u8 *
+GG_mem_save_state_chunks (
+        		  Z80u8          *buf,
+        		  const Z80_Bool  memories
+        		  );
+
+/* Carrega els trossos del mòdul que hi haja en CHUNKS. Els que no hi
+ * són no es modifiquen. Torna 0 si tot ha anat bé.
+ */
+int
+GG_mem_load_state_chunks (
+        		  const GG_StateChunks *chunks
+        		  );
+
+/* Guarda en RAM i SRAM les pàgines de la RAM i la SRAM (veure
+ * BRANCH). Si la SRAM no està mapejada les pàgines de SRAM són
+ * NULL. Torna 0 si tot ha anat bé.
+ */
+int
+GG_mem_branch_save (
+        	    GG_Page *ram[GG_RAM_PAGES],
+        	    GG_Page *sram[GG_SRAM_PAGES]
+        	    );
+
+/* Passa a la RAM i la SRAM el contingut de les pàgines. El mapejador
+ * es carrega a banda.
+ */
+void
+GG_mem_branch_load (
+        	    GG_Page *const ram[GG_RAM_PAGES],
+        	    GG_Page *const sram[GG_SRAM_PAGES]
+        	    );
+
 
 /*******/
 /* VDP */
@@ -242,6 +775,17 @@ typedef struct
 
 } GG_VRAMState;
 
+/* Torna els cicles de UCP que poden passar sense que el VDP
+ * produïsca cap event visible per la UCP (interrupcions o
+ * actualització de la pantalla). Si LINE és cert també compten com a
+ * event els punts de cada línia on canvia el comptador V o es
+ * calculen els flags d'estat, i el principi de la línia.
+ */
+int
+GG_vdp_cc_to_event (
+        	    const Z80_Bool line
+        	    );
+
 /* Alimenta el dispositiu amb cicles de rellotge de la UCP. */
 void
 GG_vdp_clock (
@@ -252,6 +796,12 @@ GG_vdp_clock (
 const Z80u8 *
 GG_vdp_get_cram (void);
 
+/* Resum de la VRAM, la CRAM i els registres. El de les memòries
+ * s'actualitza en cada escriptura.
+ */
+GG_Hash
+GG_vdp_get_hash (void);
+
 /* Funció per accedir a l'estat actual de la memòria de vídeo. */
 void
 GG_vdp_get_vram (
@@ -317,6 +867,94 @@ GG_vdp_load_state (
         	   FILE *f
         	   );
 
+/* Grandària màxima en bytes de l'estat guardat en memòria. */
+size_t
+GG_vdp_state_size (void);
+
+/* Com GG_vdp_save_state però escriu en BUF, que ha de tindre com a
+ * mínim GG_vdp_state_size bytes. Torna el punter al següent byte
+ * lliure.
+ */
+Z80u8 *
+GG_vdp_save_state_mem (
+        	       Z80u8 *buf
+        	       );
+
+/* Com GG_vdp_load_state però llig de BUF sense passar de END. Torna
+ * el punter al següent byte a llegir o NULL en cas d'error. Si
+ * TRUSTED és cert l'estat l'ha escrit aquest mateix procés (veure
+ * GG_load_state_trusted_mem) i no es comprova el 'framebuffer'.
+ */
+const Z80u8 *
+GG_vdp_load_state_mem (
+        	       const Z80u8    *buf,
+        	       const Z80u8    *end,
+        	       const Z80_Bool  trusted
+        	       );
+
+/* Com GG_vdp_save_state_mem però sols es guarden les línies del 'frame'
+ * actual que encara no s'han passat al 'frontend', sense les línies
+ * auxiliars de renderitzat.
+ */
+Z80u8 *
+GG_vdp_save_state_compact_mem (
+        		       Z80u8 *buf
+        		       );
+
+const Z80u8 *
+GG_vdp_load_state_compact_mem (
+        		       const Z80u8 *buf,
+        		       const Z80u8 *end
+        		       );
+
+/* Escriu en BUF els trossos del format portable (veure STATE) amb
+ * la CRAM, els registres, les línies pendents i, si MEMORIES és
+ * cert, la VRAM. Torna el punter al següent byte lliure.
+ */
+Z80u8 *
+GG_vdp_save_state_chunks (
+        		  Z80u8          *buf,
+        		  const Z80_Bool  memories
+        		  );
+
+/* Carrega els trossos del mòdul que hi haja en CHUNKS. Els que no hi
+ * són no es modifiquen. Torna 0 si tot ha anat bé.
+ */
+int
+GG_vdp_load_state_chunks (
+        		  const GG_StateChunks *chunks
+        		  );
+
+/* Guarda en VRAM les pàgines de la VRAM (veure BRANCH). Torna 0 si
+ * tot ha anat bé.
+ */
+int
+GG_vdp_branch_save (
+        	    GG_Page *vram[GG_VRAM_PAGES]
+        	    );
+
+void
+GG_vdp_branch_load (
+        	    GG_Page *const vram[GG_VRAM_PAGES]
+        	    );
+
+/* Si SKIP és cert no es dibuixen els píxels (el 'frame buffer'
+ * passat a GG_UpdateScreen no és vàlid), però es calculen igualment
+ * els flags de col·lisió i excés de sprites.
+ */
+void
+GG_vdp_set_frame_skip (
+        	       const Z80_Bool skip
+        	       );
+
+/* Activa o desactiva la comprovació dels 'watchpoints' de VRAM en
+ * cada accés a les dades. Ho fa el mòdul BREAK.
+ */
+void
+GG_vdp_set_watch (
+        	  const Z80_Bool val
+        	  );
+
 
 /***********/
 /* CONTROL */
@@ -365,6 +1003,25 @@ GG_control_get_status_ext (void);
 Z80u8
 GG_control_get_status_start (void);
 
+/* Fixa l'estat dels botons (GG_Button) dels dos jugadors. Fins que es
+ * cride a GG_control_release_input no es torna a cridar a
+ * 'check_buttons'. El segon jugador segueix la convenció de la
+ * Master System (bits 6-7 de $DC i bits 0-3 de $DD).
+ */
+void
+GG_control_set_input (
+        	      const int player1,
+        	      const int player2
+        	      );
+
+/* Torna a llegir els botons amb 'check_buttons'. */
+void
+GG_control_release_input (void);
+
+/* Crida a 'check_buttons' encara que l'entrada estiga fixada. */
+int
+GG_control_read_buttons (void);
+
 
 /*******/
 /* PSG */
@@ -389,6 +1046,12 @@ typedef void (GG_PlaySound) (
         		     void         *udata
         		     );
 
+/* Torna els cicles de UCP que poden passar sense que es plene el
+ * buffer de so.
+ */
+int
+GG_psg_cc_to_event (void);
+
 /* Alimenta el dispositiu amb cicles de rellotge de la UCP. */
 void
 GG_psg_clock (
@@ -428,57 +1091,404 @@ GG_psg_load_state (
         	   FILE *f
         	   );
 
+/* Grandària màxima en bytes de l'estat guardat en memòria. */
+size_t
+GG_psg_state_size (void);
 
-/********/
-/* MAIN */
-/********/
-/* Funcions que un usuari normal deuria usar. */
-
-/* Número aproxima de cicles per segon. */
-#define GG_CICLES_PER_SEC 3579545
+/* Com GG_psg_save_state però escriu en BUF, que ha de tindre com a
+ * mínim GG_psg_state_size bytes. Torna el punter al següent byte
+ * lliure.
+ */
+Z80u8 *
+GG_psg_save_state_mem (
+        	       Z80u8 *buf
+        	       );
 
-/* Tipus de funció amb la que el 'frontend' indica a la llibreria si
- * s'ha produït una senyal de parada. A més esta funció pot ser
- * emprada per el frontend per a tractar els events pendents.
+/* Com GG_psg_load_state però llig de BUF sense passar de END. Torna
+ * el punter al següent byte a llegir o NULL en cas d'error. Si
+ * TRUSTED és cert l'estat l'ha escrit aquest mateix procés (veure
+ * GG_load_state_trusted_mem) i no es comproven els buffers de so.
  */
-typedef void (GG_CheckSignals) (
-        			Z80_Bool *stop,
-        			void     *udata
-        			);
+const Z80u8 *
+GG_psg_load_state_mem (
+        	       const Z80u8    *buf,
+        	       const Z80u8    *end,
+        	       const Z80_Bool  trusted
+        	       );
 
-/* Tipus de funció per a saber quin a sigut l'últim pas d'execució de
- * la UCP.
+/* Com GG_psg_save_state_mem però sols es guarden les mostres ja
+ * generades del buffer actual, sense _left/_right.
  */
-typedef void (GG_CPUStep) (
-        		   const Z80_Step *step,        /* Punter a
-        						   pas
-        						   d'execuió. */
-        		   const Z80u16    nextaddr,    /* Següent
-        						   adreça de
-        						   memòria. */
-        		   void           *udata
-        		   );
+Z80u8 *
+GG_psg_save_state_compact_mem (
+        		       Z80u8 *buf
+        		       );
 
-/* No tots els camps tenen que ser distint de NULL. */
-typedef struct
-{
-  
-  GG_MemAccess     *mem_access;         /* Es crida cada vegada que es
-        				   produïx un accés a
-        				   memòria. */
-  GG_MapperChanged *mapper_changed;     /* Es crida cada vegada que la
-        				   disposició de la memòria
-        				   canvia. */
-  GG_CPUStep       *cpu_step;           /* Es crida en cada pas de la
-        				   UCP. */
-  
-} GG_TraceCallbacks;
+const Z80u8 *
+GG_psg_load_state_compact_mem (
+        		       const Z80u8 *buf,
+        		       const Z80u8 *end
+        		       );
 
-/* Conté la informació necessària per a comunicar-se amb el
- * 'frontend'.
+/* Escriu en BUF els trossos del format portable (veure STATE) amb
+ * l'estat dels canals i les mostres pendents. Torna el punter al
+ * següent byte lliure.
  */
-typedef struct
-{
+Z80u8 *
+GG_psg_save_state_chunks (
+        		  Z80u8 *buf
+        		  );
+
+/* Carrega els trossos del mòdul que hi haja en CHUNKS. Els que no hi
+ * són no es modifiquen. Torna 0 si tot ha anat bé.
+ */
+int
+GG_psg_load_state_chunks (
+        		  const GG_StateChunks *chunks
+        		  );
+
+/* Si FAST és cert, a més de no generar eixida (com GG_psg_set_mute)
+ * tampoc es calculen les mostres de cada canal, sols s'avança el seu
+ * estat. Les mostres del buffer actual queden en silenci, però
+ * GG_psg_get_hash no canvia. El registre VGM continua.
+ */
+void
+GG_psg_set_fast (
+        	 const Z80_Bool fast
+        	 );
+
+/* Si MUTE és cert el xip continua funcionant però no genera eixida:
+ * no es crida a GG_PlaySound ni es captura res.
+ */
+void
+GG_psg_set_mute (
+        	 const Z80_Bool mute
+        	 );
+
+/* Torna el valor fixat amb GG_psg_set_mute. */
+Z80_Bool
+GG_psg_get_mute (void);
+
+/* Comença a capturar l'eixida del xip en el fitxer WAV FN (PCM de 16
+ * bits estèreo) remostrejada a FREQ mostres per segon. L'escriptura
+ * la fa un fil a banda. Torna 0 si tot ha anat bé, -1 en cas
+ * contrari.
+ */
+int
+GG_psg_capture_wav_start (
+        		  const char *fn,
+        		  const int   freq
+        		  );
+
+/* Para la captura WAV i completa el fitxer. Torna -1 si s'ha produït
+ * algun error d'escriptura o s'han perdut mostres.
+ */
+int
+GG_psg_capture_wav_stop (void);
+
+/* Comença a registrar en el fitxer VGM FN totes les escriptures en
+ * els registres del xip (GG_psg_control i GG_psg_stereo) amb el seu
+ * instant de temps. Al principi s'escriu l'estat actual. Torna 0 si
+ * tot ha anat bé, -1 en cas contrari.
+ */
+int
+GG_psg_capture_vgm_start (
+        		  const char *fn
+        		  );
+
+/* Para el registre VGM i completa el fitxer. Torna -1 si s'ha
+ * produït algun error d'escriptura.
+ */
+int
+GG_psg_capture_vgm_stop (void);
+
+/* Número de canals del xip: 0-2 són els de to i 3 el de soroll. */
+#define GG_PSG_NCHANNELS 4
+
+/* Torna una vista de només lectura (sense còpia) del buffer intern
+ * del canal CHANNEL. Conté GG_PSG_BUFFER_SIZE mostres a
+ * GG_PSG_SAMPLES_PER_SEC, i cada mostra és l'atenuació del canal (0
+ * màxim, 15 silenci) abans d'aplicar l'estèreo. El contingut sols és
+ * vàlid durant la crida a GG_PlaySound, després el xip el
+ * sobreescriu.
+ */
+const Z80u8 *
+GG_psg_get_channel_buffer (
+        		   const int channel
+        		   );
+
+/* Resum de l'estat dels canals i la temporització. No inclou les
+ * mostres generades.
+ */
+GG_Hash
+GG_psg_get_hash (void);
+
+/* Torna la taula de 16 entrades que converteix una atenuació en el
+ * nivell que aporta el canal a l'eixida, en el rang [0,0.25].
+ */
+const double *
+GG_psg_get_volume_table (void);
+
+
+/*********/
+/* AUDIO */
+/*********/
+/* Buffer circular sense bloquejos per a passar mostres estèreo entre
+ * un únic productor (normalment el fil del simulador) i un únic
+ * consumidor (normalment el fil d'àudio del 'frontend'). La grandària
+ * es mesura en 'frames', on un 'frame' són dues mostres (esquerra i
+ * dreta) intercalades.
+ */
+
+/* Tipus opac. */
+typedef struct GG_AudioRing GG_AudioRing;
+
+/* Estadístiques del buffer. */
+typedef struct
+{
+
+  unsigned long underruns;    /* 'Frames' que ha demanat el consumidor
+        			 i no hi havia. */
+  unsigned long overruns;     /* 'Frames' que ha descartat el
+        			 productor per estar ple. */
+
+} GG_AudioRingStats;
+
+/* Crea un buffer amb capacitat per a almenys NFRAMES 'frames'. Torna
+ * NULL en cas d'error.
+ */
+GG_AudioRing *
+GG_audio_ring_new (
+        	   const int nframes
+        	   );
+
+void
+GG_audio_ring_free (
+        	    GG_AudioRing *ring
+        	    );
+
+/* Buida el buffer. Sols es pot cridar quan ni el productor ni el
+ * consumidor l'estan gastant.
+ */
+void
+GG_audio_ring_clear (
+        	     GG_AudioRing *ring
+        	     );
+
+/* Torna el número de 'frames' pendents de llegir. Es pot cridar des
+ * de qualsevol dels dos fils.
+ */
+int
+GG_audio_ring_get_fill (
+        		GG_AudioRing *ring
+        		);
+
+/* Torna la capacitat real en 'frames'. */
+int
+GG_audio_ring_get_size (
+        		const GG_AudioRing *ring
+        		);
+
+void
+GG_audio_ring_get_stats (
+        		 GG_AudioRing      *ring,
+        		 GG_AudioRingStats *stats
+        		 );
+
+/* Consumidor. Llig com a màxim NFRAMES 'frames' en FRAMES i torna el
+ * número de 'frames' llegits. Els que falten es compten com a
+ * 'underruns'. No es bloqueja mai.
+ */
+int
+GG_audio_ring_read (
+        	    GG_AudioRing *ring,
+        	    double       *frames,
+        	    const int     nframes
+        	    );
+
+/* Productor. Escriu com a màxim NFRAMES 'frames' de FRAMES i torna el
+ * número de 'frames' escrits. Els que no caben es descarten i es
+ * compten com a 'overruns'. No es bloqueja mai.
+ */
+int
+GG_audio_ring_write (
+        	     GG_AudioRing *ring,
+        	     const double *frames,
+        	     const int     nframes
+        	     );
+
+
+/*********/
+/* BREAK */
+/*********/
+/* Punts de ruptura d'execució i d'accés ('watchpoints'). Sols es
+ * comproven dins de GG_loop, i sols si n'hi ha algun actiu, per tant
+ * quan no n'hi ha cap GG_loop va a tota velocitat. Els punts
+ * d'execució s'identifiquen com en PROF: pel banc de ROM i la posició
+ * dins del banc, o per l'adreça del processador en RAM/SRAM (banc
+ * -1), i paren abans d'executar la instrucció. Els d'accés paren
+ * després de la instrucció que ha fet l'accés.
+ */
+
+/* Raó per la qual s'ha parat GG_loop. */
+typedef enum
+  {
+    GG_BREAK_NONE,          /* GG_stop o CHECKSIGNALS. */
+    GG_BREAK_EXEC,
+    GG_BREAK_RAM_READ,
+    GG_BREAK_RAM_WRITE,
+    GG_BREAK_VRAM_READ,
+    GG_BREAK_VRAM_WRITE,
+    GG_BREAK_IO_READ,
+    GG_BREAK_IO_WRITE
+  } GG_BreakReason;
+
+/* Espais d'adreces dels 'watchpoints'. */
+typedef enum
+  {
+    GG_WATCH_RAM,           /* 0x0000-0x1FFF, dins de la RAM. */
+    GG_WATCH_VRAM,          /* 0x0000-0x3FFF. */
+    GG_WATCH_IO,            /* Ports 0x00-0xFF. */
+    GG_WATCH_NSPACES
+  } GG_WatchSpace;
+
+typedef struct
+{
+  
+  GG_BreakReason reason;
+  int            addr;      /* PC, adreça o port. */
+  int            bank;      /* Banc de PC en GG_BREAK_EXEC, o -1. */
+  Z80u8          data;      /* Valor llegit o escrit. */
+  
+} GG_BreakEvent;
+
+/* Posa (ENABLE cert) o lleva un punt de ruptura d'execució en l'adreça
+ * ADDR del banc BANK. Amb BANK -1 ADDR és una adreça del processador
+ * entre 0x8000 i 0xFFFF. Torna 0 si tot ha anat bé.
+ */
+int
+GG_break_set_exec (
+        	   const int      bank,
+        	   const Z80u16   addr,
+        	   const Z80_Bool enable
+        	   );
+
+/* Posa o lleva 'watchpoints' en les adreces FIRST a LAST (incloses)
+ * de l'espai SPACE per al tipus d'accés TYPE. Torna 0 si tot ha anat
+ * bé, -1 si l'espai, el tipus o el rang no són vàlids.
+ */
+int
+GG_break_set_watch (
+        	    const GG_WatchSpace    space,
+        	    const GG_MemAccessType type,
+        	    const int              first,
+        	    const int              last,
+        	    const Z80_Bool         enable
+        	    );
+
+/* Lleva tots els punts de ruptura. */
+void
+GG_break_clear (void);
+
+/* Obté l'últim event, el que ha parat GG_loop. */
+void
+GG_break_get_event (
+        	    GG_BreakEvent *event
+        	    );
+
+/* Les següents funcions les crida la pròpia llibreria. */
+Z80_Bool
+GG_break_is_enabled (void);
+
+Z80_Bool
+GG_break_has_exec (void);
+
+/* Torna cert si la següent instrucció té un punt de ruptura. */
+Z80_Bool
+GG_break_check_exec (void);
+
+void
+GG_break_clear_event (void);
+
+GG_BreakReason
+GG_break_get_reason (void);
+
+/* Notifiquen els accessos. ADDR és l'adreça dins de l'espai. Sols
+ * es criden mentre l'espai té algun 'watchpoint' (veure
+ * GG_mem_set_watch, GG_vdp_set_watch i GG_io_set_watch).
+ */
+void
+GG_break_ram (
+              const GG_MemAccessType type,
+              const Z80u16           addr,
+              const Z80u8            data
+              );
+
+void
+GG_break_vram (
+               const GG_MemAccessType type,
+               const Z80u16           addr,
+               const Z80u8            data
+               );
+
+void
+GG_break_io (
+             const GG_MemAccessType type,
+             const Z80u8            port,
+             const Z80u8            data
+             );
+
+
+/********/
+/* MAIN */
+/********/
+/* Funcions que un usuari normal deuria usar. */
+
+/* Número aproxima de cicles per segon. */
+#define GG_CICLES_PER_SEC 3579545
+
+/* Tipus de funció amb la que el 'frontend' indica a la llibreria si
+ * s'ha produït una senyal de parada. A més esta funció pot ser
+ * emprada per el frontend per a tractar els events pendents.
+ */
+typedef void (GG_CheckSignals) (
+        			Z80_Bool *stop,
+        			void     *udata
+        			);
+
+/* Tipus de funció per a saber quin a sigut l'últim pas d'execució de
+ * la UCP.
+ */
+typedef void (GG_CPUStep) (
+        		   const Z80_Step *step,        /* Punter a
+        						   pas
+        						   d'execuió. */
+        		   const Z80u16    nextaddr,    /* Següent
+        						   adreça de
+        						   memòria. */
+        		   void           *udata
+        		   );
+
+/* No tots els camps tenen que ser distint de NULL. */
+typedef struct
+{
+  
+  GG_MemAccess     *mem_access;         /* Es crida cada vegada que es
+        				   produïx un accés a
+        				   memòria. */
+  GG_MapperChanged *mapper_changed;     /* Es crida cada vegada que la
+        				   disposició de la memòria
+        				   canvia. */
+  GG_CPUStep       *cpu_step;           /* Es crida en cada pas de la
+        				   UCP. */
+  
+} GG_TraceCallbacks;
+
+/* Conté la informació necessària per a comunicar-se amb el
+ * 'frontend'.
+ */
+typedef struct
+{
   
   GG_Warning              *warning;            /* Funció per a mostrar
         					  avisos. */
@@ -503,6 +1513,10 @@ typedef struct
         					  es van a gastar les
         					  funcions per a fer
         					  una traça. */
+  GG_SRAMChanged          *sram_changed;       /* Avisa que la RAM
+        					  externa ha
+        					  canviat. Pot ser
+        					  NULL. */
   
 } GG_Frontend;
 
@@ -535,6 +1549,9 @@ GG_iter (
  * fitxer siga un fitxer d'estat vàlid de GameGear per a la ROM
  * actual. Si es produeix un error de lectura o es compromet la
  * integritat del simulador, aleshores es reiniciarà el simulador.
+ * Accepta el format portable i també els antics (GGSTATE i
+ * compacte), per tant carregar i tornar a guardar migra un estat
+ * antic.
  */
 int
 GG_load_state (
@@ -542,23 +1559,146 @@ GG_load_state (
                );
 
 /* Executa la GameGear. Aquesta funció es bloqueja fins que llig una
- * senyal de parada mitjançant CHECKSIGNALS o mitjançant GG_stop, si
- * es para es por tornar a cridar i continuarà on s'havia quedat. La
- * funció CHECKSIGNALS del frontend es crida amb una freqüència
- * suficient per a que el frontend tracte els seus events.
+ * senyal de parada mitjançant CHECKSIGNALS o mitjançant GG_stop, o
+ * fins que salta un punt de ruptura (veure BREAK), si es para es por
+ * tornar a cridar i continuarà on s'havia quedat. La funció
+ * CHECKSIGNALS del frontend es crida amb una freqüència suficient per
+ * a que el frontend tracte els seus events. Torna la raó per la qual
+ * s'ha parat. Els punts de ruptura que es posen dins de GG_loop tenen
+ * efecte al final del 'frame'.
  */
-void
+GG_BreakReason
 GG_loop (void);
 
 
-/* Escriu en 'f' l'estat de la màquina. Torna 0 si tot ha anat bé, -1
- * en cas contrari.
+/* Escriu en 'f' l'estat de la màquina en format portable (veure
+ * GG_save_state_portable_mem). Torna 0 si tot ha anat bé, -1 en cas
+ * contrari.
  */
 int
 GG_save_state (
                FILE *f
                );
 
+/* CRC-32 de la ROM passada a GG_init (veure GG_rom_crc32). Es
+ * calcula la primera vegada que es demana.
+ */
+uint32_t
+GG_get_rom_crc32 (void);
+
+/* Resum de 64 bits de l'estat arquitectònic (registres de la UCP,
+ * RAM, SRAM, mapejador, VRAM, CRAM, registres del VDP i canals del
+ * PSG). Les memòries es resumixen incrementalment en cada
+ * escriptura, per tant es pot calcular en cada 'frame' quasi sense
+ * cost per a detectar desincronitzacions. Dos màquines en el mateix
+ * estat tenen el mateix resum, però el valor no és portable entre
+ * arquitectures distintes.
+ */
+GG_Hash
+GG_get_state_hash (void);
+
+/* Torna la grandària màxima en bytes d'un estat guardat amb
+ * qualsevol dels formats. Sols és vàlida després de GG_init.
+ */
+size_t
+GG_state_size (void);
+
+/* Escriu l'estat en BUF, que ha de tindre com a mínim GG_state_size
+ * bytes, bolcant directament les estructures internes (sols es pot
+ * carregar en el mateix binari). Torna el número de bytes escrits, o
+ * 0 en cas d'error. Està pensada per a fer moltes captures per segon
+ * (rebobinat, execució anticipada, joc en xarxa...).
+ */
+size_t
+GG_save_state_mem (
+        	   Z80u8 *buf
+        	   );
+
+/* Com GG_load_state però llig l'estat dels SIZE bytes de BUF. */
+int
+GG_load_state_mem (
+        	   const Z80u8  *buf,
+        	   const size_t  size
+        	   );
+
+/* Com GG_load_state_mem però, si BUF l'ha escrit GG_save_state_mem en
+ * aquest mateix procés i no s'ha modificat, no torna a validar els
+ * buffers de vídeo i so. És responsabilitat de qui la crida garantir
+ * que BUF és de confiança.
+ */
+int
+GG_load_state_trusted_mem (
+        		   const Z80u8  *buf,
+        		   const size_t  size
+        		   );
+
+/* Com GG_save_state_mem però sols guarda l'estat arquitectònic
+ * (registres, RAM, VRAM, CRAM, temporització...). Els buffers
+ * derivats (eixida de vídeo i so) es tornen a calcular després de
+ * carregar. GG_load_state_mem i GG_load_state reconeixen els dos
+ * formats.
+ */
+size_t
+GG_save_state_compact_mem (
+        		   Z80u8 *buf
+        		   );
+
+/* Com GG_save_state però en format compacte. */
+int
+GG_save_state_compact (
+        	       FILE *f
+        	       );
+
+/* Escriu l'estat en BUF en el format portable per trossos (veure
+ * STATE), que no depén del compilador ni de l'arquitectura (excepte
+ * el tros de la UCP) i es pot llegir parcialment. Torna el número de
+ * bytes escrits, o 0 en cas d'error. GG_load_state_mem també el
+ * reconeix.
+ */
+size_t
+GG_save_state_portable_mem (
+        		    Z80u8 *buf
+        		    );
+
+/* Com GG_save_state_portable_mem però sense la RAM, la SRAM ni la
+ * VRAM, que BRANCH guarda en pàgines compartides.
+ */
+size_t
+GG_save_state_branch_mem (
+        		  Z80u8 *buf
+        		  );
+
+/* Carrega sols els trossos indexats en CHUNKS (veure
+ * GG_state_index), la resta de l'estat no es modifica. Per exemple,
+ * per a carregar sols la RAM. En cas d'error es reinicia el
+ * simulador.
+ */
+int
+GG_load_state_chunks (
+        	      const GG_StateChunks *chunks
+        	      );
+
+/* Executa fins al final del 'frame' actual sense cridar a les
+ * accions de final de 'frame' (rebobinat...). Pensat per a mòduls
+ * que necessiten executar 'frames' ocults.
+ */
+void
+GG_run_frame (void);
+
+/* Indica si els 'frames' s'han de dibuixar i passar al
+ * 'frontend'.
+ */
+void
+GG_set_show_frame (
+        	   const Z80_Bool show
+        	   );
+
+/* Torna el valor fixat amb GG_set_show_frame. Permet als mòduls que
+ * executen 'frames' ocults restaurar-lo després.
+ */
+Z80_Bool
+GG_get_show_frame (void);
+
 /* Para a 'GG_loop'. */
 void
 GG_stop (void);
@@ -570,5 +1710,972 @@ GG_stop (void);
 int
 GG_trace (void);
 
+/* Com cridar NSTEPS vegades a GG_trace, però sense eixir de C. Para
+ * abans si es crida a GG_stop. Pensada per a gravar traces amb el
+ * mòdul TRACER. Torna el número de cicles executats.
+ */
+long
+GG_trace_run (
+              const long nsteps
+              );
+
+
+/*********/
+/* CLOCK */
+/*********/
+/* Rellotge monòton del sistema, compartit pels mòduls que mesuren o
+ * esperen temps real.
+ */
+
+/* Torna el temps actual del rellotge monòton en nanosegons. */
+uint64_t
+GG_clock_get_ns (void);
+
+/* Torna el temps actual del rellotge monòton en segons. */
+double
+GG_clock_get (void);
+
+/* Espera fins que el rellotge monòton arribe a T segons. Si un senyal
+ * interromp l'espera es torna a esperar, amb qualsevol altre error
+ * torna sense esperar.
+ */
+void
+GG_clock_sleep_until (
+        	      const double t
+        	      );
+
+
+/**********/
+/* PACING */
+/**********/
+/* Mòdul que manté la velocitat real del simulador. El vídeo va al seu
+ * ritme (aprox. 59.92 'frames' per segon) mesurat amb el rellotge del
+ * sistema, i el so es remostreja a la freqüència del 'host' corregint
+ * lleugerament la relació de remostreig perquè el buffer circular
+ * d'àudio es mantinga al voltant de la latència objectiu.
+ */
+
+/* Cicles de UCP per 'frame' (262 línies de 228 cicles). */
+#define GG_CICLES_PER_FRAME (262*228)
+
+/* Estadístiques del mòdul. */
+typedef struct
+{
+
+  double target_latency;    /* Latència objectiu en segons. */
+  double latency;           /* Latència mitjana mesurada en segons. */
+  double jitter;            /* Desviació mitjana del període de
+        		       vídeo respecte a l'ideal, en segons. */
+  double ratio;             /* Correcció actual de la relació de
+        		       remostreig (1.0 vol dir cap). */
+
+} GG_PacingStats;
+
+/* Inicialitza el mòdul. RING és on s'escriuran les mostres
+ * remostrejades a FREQ mostres per segon. TARGET_LATENCY és
+ * l'ompliment objectiu de RING en segons.
+ */
+void
+GG_pacing_init (
+        	GG_AudioRing *ring,
+        	const int     freq,
+        	const double  target_latency
+        	);
+
+/* S'ha de cridar una vegada per 'frame' de vídeo. Espera el temps
+ * necessari per a mantindre la velocitat real. Si es va massa
+ * endarrere es torna a sincronitzar.
+ */
+void
+GG_pacing_frame (void);
+
+/* Torna la relació de remostreig actual (mostres del PSG per mostra
+ * del 'host').
+ */
+double
+GG_pacing_get_ratio (void);
+
+void
+GG_pacing_get_stats (
+        	     GG_PacingStats *stats
+        	     );
+
+/* Remostreja i escriu en el buffer circular. Pensat per a ser cridat
+ * des de la funció GG_PlaySound del 'frontend'.
+ */
+void
+GG_pacing_play_sound (
+        	      const double left[GG_PSG_BUFFER_SIZE],
+        	      const double right[GG_PSG_BUFFER_SIZE]
+        	      );
+
+/* Oblida la temporització anterior. S'ha de cridar cada vegada que el
+ * simulador es reprén després d'estar parat.
+ */
+void
+GG_pacing_reset (void);
+
+
+/**********/
+/* REWIND */
+/**********/
+/* Permet tornar arrere en el temps. Cada INTERVAL 'frames' es fa una
+ * captura de l'estat, i es guarda comprimida com la diferència
+ * respecte a l'anterior en un buffer circular de grandària fixa. Quan
+ * s'ompli, s'esborren les captures més antigues. Les captures es
+ * fan automàticament al final de cada 'frame' dins de GG_loop,
+ * GG_iter i GG_trace.
+ */
+
+/* Estadístiques del mòdul. */
+typedef struct
+{
+  
+  int    nsnapshots;       /* Captures disponibles. */
+  double seconds;          /* Segons d'història disponibles. */
+  size_t used;             /* Bytes emprats (incloent l'última
+        		      captura sencera). */
+  size_t capacity;         /* Grandària del buffer circular. */
+  double bytes_per_sec;    /* Bytes del buffer circular per segon
+        		      d'història. */
+  
+} GG_RewindStats;
+
+/* Inicialitza el mòdul (s'ha de cridar després de GG_init). INTERVAL
+ * és el número de 'frames' entre captures i CAPACITY la grandària en
+ * bytes del buffer circular. Torna 0 si tot ha anat bé, -1 en cas
+ * contrari.
+ */
+int
+GG_rewind_init (
+        	const int    interval,
+        	const size_t capacity
+        	);
+
+/* Allibera la memòria i desactiva el mòdul. */
+void
+GG_rewind_close (void);
+
+/* Oblida totes les captures. */
+void
+GG_rewind_clear (void);
+
+/* S'ha de cridar al final de cada 'frame'. Ho fa la pròpia llibreria. */
+void
+GG_rewind_frame (void);
+
+void
+GG_rewind_get_stats (
+        	     GG_RewindStats *stats
+        	     );
+
+/* Torna a l'última captura. Si no ha passat cap 'frame' des de
+ * l'última captura, torna a l'anterior i la descarta. Torna 0 si tot
+ * ha anat bé, -1 si no queden captures o no s'ha pogut carregar.
+ */
+int
+GG_rewind_step (void);
+
+
+/************/
+/* RUNAHEAD */
+/************/
+/* Redueix la latència de l'entrada. Al final de cada 'frame' es
+ * guarda l'estat, s'executen NFRAMES 'frames' més sense so, es
+ * mostra l'últim i es torna a carregar l'estat. El so és sempre el
+ * de la línia de temps real.
+ */
+
+/* Estadístiques del mòdul. */
+typedef struct
+{
+  
+  int           nframes;     /* 'Frames' avançats (0 desactivat). */
+  unsigned long frames;      /* 'Frames' mostrats. */
+  double        cpu;         /* Temps mitjà de UCP (del fil del
+        			simulador) per 'frame' mostrat, en
+        			segons. */
+  double        runahead;    /* Part de CPU emprada en avançar. */
+  
+} GG_RunaheadStats;
+
+/* Activa el mòdul (s'ha de cridar després de GG_init, que el
+ * desactiva). Si NFRAMES és 0 el desactiva. Torna 0 si tot ha anat
+ * bé, -1 en cas contrari.
+ */
+int
+GG_runahead_init (
+        	  const int nframes
+        	  );
+
+/* Desactiva el mòdul. */
+void
+GG_runahead_close (void);
+
+/* S'ha de cridar al final de cada 'frame'. Ho fa la pròpia
+ * llibreria. Si no es pot tornar a carregar l'estat guardat (la
+ * màquina queda reiniciada i ja s'ha avisat amb 'warning') desactiva
+ * el mòdul i torna -1.
+ */
+int
+GG_runahead_frame (void);
+
+void
+GG_runahead_get_stats (
+        	       GG_RunaheadStats *stats
+        	       );
+
+
+/************/
+/* ROLLBACK */
+/************/
+/* Joc en xarxa de dos jugadors amb 'rollback'. Cada extrem executa
+ * la mateixa màquina, fixa l'entrada dels dos jugadors per 'frame' i
+ * guarda els últims WINDOW estats en memòria. Si l'entrada remota
+ * d'un 'frame' encara no ha arribat es prediu, i si després resulta
+ * ser distinta es torna a executar des d'eixe 'frame' tan ràpid com
+ * es puga. El transport de les entrades és cosa del 'frontend', que
+ * ha d'enviar-les en ordre. En compte de GG_loop el 'frontend' crida
+ * a GG_rollback_advance una vegada per 'frame'.
+ */
+
+/* Estadístiques del mòdul. */
+typedef struct
+{
+  
+  unsigned long frames;         /* 'Frames' executats. */
+  unsigned long rollbacks;      /* Vegades que s'ha tornat arrere. */
+  unsigned long resimulated;    /* 'Frames' tornats a executar. */
+  int           max_depth;      /* Màxim de 'frames' tornats a
+        			   executar d'una vegada. */
+  
+} GG_RollbackStats;
+
+/* Inicialitza el mòdul (s'ha de cridar després de GG_init, que el
+ * desactiva). LOCAL_PLAYER és el jugador local (0 o 1) i WINDOW el
+ * número màxim de 'frames' que es pot anar per davant de l'última
+ * entrada remota confirmada. Torna 0 si tot ha anat bé, -1 en cas
+ * contrari.
+ */
+int
+GG_rollback_init (
+        	  const int local_player,
+        	  const int window
+        	  );
+
+void
+GG_rollback_close (void);
+
+/* Afegeix l'entrada remota del 'frame' FRAME. Les entrades han
+ * d'arribar en ordre. Torna -1 si FRAME no és el següent esperat o
+ * està massa lluny.
+ */
+int
+GG_rollback_add_remote_input (
+        		      const int frame,
+        		      const int buttons
+        		      );
+
+/* Executa el següent 'frame' amb l'entrada local BUTTONS, tornant
+ * arrere abans si cal. Torna el número del 'frame' executat, o -1 si
+ * s'està massa per davant de l'altre extrem i cal esperar entrades
+ * remotes.
+ */
+int
+GG_rollback_advance (
+        	     const int buttons
+        	     );
+
+/* Torna a executar els 'frames' pendents de corregir sense
+ * avançar.
+ */
+void
+GG_rollback_sync (void);
+
+/* Següent 'frame' a executar. */
+int
+GG_rollback_get_frame (void);
+
+/* Primer 'frame' del qual no s'ha rebut l'entrada remota. */
+int
+GG_rollback_get_confirmed (void);
+
+void
+GG_rollback_get_stats (
+        	       GG_RollbackStats *stats
+        	       );
+
+
+/*********/
+/* MOVIE */
+/*********/
+/* Gravació i reproducció deterministes de l'entrada. Mentre es grava
+ * els botons es lligen una vegada al principi de cada 'frame' i es
+ * fixen durant tot el 'frame' (veure GG_control_set_input), per tant
+ * reproduir els mateixos botons a partir del mateix estat dona
+ * exactament la mateixa execució. Una pel·lícula guarda el CRC-32 de
+ * la ROM, l'estat inicial, els botons (GG_Button) de cada 'frame' i,
+ * cada INTERVAL 'frames', un estat (fotograma clau) que permet
+ * saltar a qualsevol 'frame' executant com a molt INTERVAL-1
+ * 'frames'. Els estats es guarden en format portable (veure STATE).
+ * No es pot fer servir al mateix temps que ROLLBACK.
+ *
+ * Format del fitxer (extensió .ggm, enters en 'little-endian'):
+ *
+ *   char     magic[8]        - GG_MOVIE_MAGIC
+ *   uint32_t version         - GG_MOVIE_VERSION
+ *   uint32_t rom_crc         - CRC-32 de la ROM.
+ *   uint32_t interval        - 'Frames' entre fotogrames clau.
+ *   uint32_t nframes
+ *   uint32_t nkeyframes
+ *   uint32_t start_size
+ *   uint32_t key_size[nkeyframes]
+ *   uint16_t input[nframes]  - GG_Button de cada 'frame'.
+ *   Z80u8    start[start_size]
+ *   fotogrames clau          - Un darrere de l'altre.
+ *
+ * L'estat inicial i els fotogrames clau són estats complets en format
+ * portable, amb capçalera. Amb les grandàries al principi es pot
+ * calcular on està qualsevol fotograma clau sense llegir els
+ * anteriors.
+ */
+
+#define GG_MOVIE_MAGIC "GGMOVIE\n"
+#define GG_MOVIE_VERSION 1
+
+typedef enum
+  {
+    GG_MOVIE_NONE,         /* No hi ha pel·lícula. */
+    GG_MOVIE_STOPPED,      /* Hi ha pel·lícula però no s'usa. */
+    GG_MOVIE_RECORDING,
+    GG_MOVIE_PLAYING
+  } GG_MovieMode;
+
+typedef struct
+{
+  
+  GG_MovieMode mode;
+  int          frame;        /* 'Frame' actual, gravant o
+        			reproduint. */
+  int          nframes;      /* 'Frames' de la pel·lícula. */
+  int          nkeyframes;   /* Fotogrames clau. */
+  int          interval;     /* 'Frames' entre fotogrames clau. */
+  uint32_t     rom_crc;      /* CRC-32 de la ROM. */
+  size_t       size;         /* Bytes en memòria. */
+  
+} GG_MovieInfo;
+
+/* Comença a gravar a partir de l'estat actual (s'ha de cridar
+ * després de GG_init, que descarta la pel·lícula). INTERVAL són els
+ * 'frames' entre fotogrames clau. Descarta la pel·lícula anterior.
+ * Torna 0 si tot ha anat bé, -1 en cas contrari.
+ */
+int
+GG_movie_record (
+        	 const int interval
+        	 );
+
+/* Carrega l'estat inicial de la pel·lícula i comença a
+ * reproduir-la. Al final es para i es tornen a llegir els botons amb
+ * 'check_buttons'. Torna 0 si tot ha anat bé.
+ */
+int
+GG_movie_play (void);
+
+/* Salta al principi del 'frame' FRAME de la pel·lícula que s'està
+ * reproduint (o parada), a partir del fotograma clau anterior. Els
+ * 'frames' intermedis s'executen sense dibuixar ni so. Després es
+ * continua reproduint. Torna 0 si tot ha anat bé.
+ */
+int
+GG_movie_seek (
+               const int frame
+               );
+
+/* Para la gravació o la reproducció. La pel·lícula es queda en
+ * memòria.
+ */
+void
+GG_movie_stop (void);
+
+/* Descarta la pel·lícula. */
+void
+GG_movie_close (void);
+
+/* Escriu la pel·lícula en F. Torna 0 si tot ha anat bé. */
+int
+GG_movie_save (
+               FILE *f
+               );
+
+/* Llig una pel·lícula de F i la deixa parada. Torna -1 si no és
+ * vàlida o és d'una altra ROM.
+ */
+int
+GG_movie_load (
+               FILE *f
+               );
+
+void
+GG_movie_get_info (
+        	   GG_MovieInfo *info
+        	   );
+
+/* S'ha de cridar al final de cada 'frame'. Ho fa la pròpia llibreria. */
+void
+GG_movie_frame (void);
+
+
+/**********/
+/* TRACER */
+/**********/
+/* Grava una traça de l'execució en mode traça (GG_trace i
+ * GG_trace_run) en un buffer circular de registres de grandària
+ * fixa, sense cap 'callback' per pas. El buffer es reserva amb 'mmap'
+ * i, si s'indica un fitxer, es comparteix amb ell, de manera que un
+ * altre procés pot llegir la traça mentre es grava. El fitxer comença
+ * amb una capçalera (GG_TracerHeader) seguida dels registres. El
+ * registre N es guarda en la posició N%capacity.
+ */
+
+#define GG_TRACER_MAGIC "GGTRACE"
+#define GG_TRACER_VERSION 1
+
+/* Accessos a memòria guardats per registre. */
+#define GG_TRACER_NACC 5
+
+/* Flags d'un registre. */
+#define GG_TRACER_ACC_LOST 0x01   /* No caben tots els accessos. */
+
+/* Accés a memòria. Es guarden totes les escriptures i les lectures
+ * de l'àrea de RAM (0xC000-0xFFFF).
+ */
+typedef struct
+{
+  
+  Z80u16 addr;          /* Adreça del processador. */
+  Z80u8  data;
+  Z80u8  type;          /* GG_MemAccessType. */
+  
+} GG_TraceAccess;
+
+/* Registre d'un pas del processador (32 bytes). */
+typedef struct
+{
+  
+  Z80u16         pc;           /* Adreça del pas. */
+  Z80u8          bank;         /* Banc de ROM en PC, 0xFF si és RAM. */
+  Z80u8          type;         /* Z80_StepType. */
+  Z80u8          nbytes;       /* 0 en les interrupcions. */
+  Z80u8          nacc;         /* Accessos guardats. */
+  Z80u8          cc;           /* Cicles. */
+  Z80u8          flags;
+  Z80u8          bytes[4];     /* Codi d'operació, o el valor del
+        			  bus en IRQ. */
+  GG_TraceAccess acc[GG_TRACER_NACC];
+  
+} GG_TraceRecord;
+
+/* Capçalera del buffer (64 bytes). */
+typedef struct
+{
+  
+  char     magic[8];           /* GG_TRACER_MAGIC. */
+  uint32_t version;
+  uint32_t record_size;        /* sizeof(GG_TraceRecord). */
+  uint64_t capacity;           /* Registres, potència de 2. */
+  uint64_t count;              /* Registres escrits des del
+        			  principi. */
+  Z80u8    reserved[32];
+  
+} GG_TracerHeader;
+
+typedef struct
+{
+  
+  uint64_t capacity;
+  uint64_t count;              /* Registres escrits. */
+  uint64_t lost;               /* Registres sobreescrits. */
+  
+} GG_TracerStats;
+
+/* Comença a gravar en un buffer de com a mínim NRECORDS registres (es
+ * redondeja a la següent potència de 2). Si FNAME no és NULL el
+ * buffer és el fitxer FNAME, que es crea o es trunca. Tanca el buffer
+ * anterior. Torna 0 si tot ha anat bé, -1 en cas contrari.
+ */
+int
+GG_tracer_open (
+        	const size_t  nrecords,
+        	const char   *fname
+        	);
+
+/* Para de gravar i allibera el buffer. */
+void
+GG_tracer_close (void);
+
+/* Copia en OUT com a molt N registres a partir del registre *POS, i
+ * actualitza *POS amb el següent registre per llegir. Si *POS ja
+ * s'ha sobreescrit, comença pel més antic disponible. Torna el
+ * número de registres copiats.
+ */
+size_t
+GG_tracer_read (
+        	uint64_t       *pos,
+        	GG_TraceRecord *out,
+        	const size_t    n
+        	);
+
+void
+GG_tracer_get_stats (
+        	     GG_TracerStats *stats
+        	     );
+
+/* Torna cert si s'està gravant. */
+Z80_Bool
+GG_tracer_is_open (void);
+
+/* Les següents funcions les crida la pròpia llibreria. Comença el
+ * registre del pas STEP (veure GG_CPUStep).
+ */
+void
+GG_tracer_begin (
+        	 const Z80_Step *step,
+        	 const Z80u16    nextaddr
+        	 );
+
+/* Afegeix un accés a memòria al registre actual. */
+void
+GG_tracer_access (
+        	  const GG_MemAccessType type,
+        	  const Z80u16           addr,
+        	  const Z80u8            data
+        	  );
+
+/* Tanca el registre actual. */
+void
+GG_tracer_end (
+               const int cc
+               );
+
+
+/********/
+/* PROF */
+/********/
+/* Perfilador. Compta, per a cada adreça, les instruccions executades
+ * i els cicles gastats dins de GG_loop i GG_iter (no en els 'frames'
+ * tornats a executar per RUNAHEAD, ROLLBACK o MOVIE). Les adreces en
+ * ROM s'identifiquen pel banc mapejat en eixe moment i la posició dins
+ * del banc, i la resta (RAM i SRAM) per l'adreça del processador
+ * (banc -1). En mode exacte es compten totes les instruccions. En
+ * mode de mostreig, cada PERIOD cicles es compta la següent
+ * instrucció com si haguera gastat PERIOD cicles, que és molt més
+ * barat. Si GG_loop ja s'està executant, els canvis de mode tenen
+ * efecte al final del 'frame'.
+ */
+
+typedef enum
+  {
+    GG_PROF_OFF,
+    GG_PROF_EXACT,
+    GG_PROF_SAMPLING
+  } GG_ProfMode;
+
+typedef struct
+{
+  
+  uint64_t count;       /* Instruccions o mostres. */
+  uint64_t cycles;
+  
+} GG_ProfCounter;
+
+typedef struct
+{
+  
+  uint64_t count;       /* Total d'instruccions o mostres. */
+  uint64_t cycles;
+  uint64_t dropped;     /* Sense memòria per als comptadors. */
+  
+} GG_ProfStats;
+
+/* Comença a comptar en el mode indicat sense esborrar els
+ * comptadors. PERIOD sols s'usa en GG_PROF_SAMPLING. Torna 0 si tot
+ * ha anat bé, -1 en cas contrari.
+ */
+int
+GG_prof_start (
+               const GG_ProfMode mode,
+               const int         period
+               );
+
+/* Para de comptar. Els comptadors es mantenen. */
+void
+GG_prof_stop (void);
+
+/* Esborra els comptadors. */
+void
+GG_prof_clear (void);
+
+/* Para i esborra els comptadors. */
+void
+GG_prof_close (void);
+
+/* Obté el comptador de l'adreça ADDR del banc BANK (-1 per a
+ * RAM/SRAM). Torna -1 si el banc no és vàlid.
+ */
+int
+GG_prof_get (
+             const int       bank,
+             const Z80u16    addr,
+             GG_ProfCounter *counter
+             );
+
+GG_ProfMode
+GG_prof_get_mode (void);
+
+void
+GG_prof_get_stats (
+        	   GG_ProfStats *stats
+        	   );
+
+/* Escriu els comptadors distints de 0 en F, una línia per adreça en
+ * el format de piles plegades que entenen 'flamegraph.pl' i
+ * semblants: "rom:OFFSET N", on OFFSET és la posició en hexadecimal
+ * dins del fitxer de la ROM, o "ram:ADDR N". N és el número
+ * d'instruccions (o mostres), o de cicles si CYCLES és cert. Torna 0
+ * si tot ha anat bé.
+ */
+int
+GG_prof_write (
+               FILE           *f,
+               const Z80_Bool  cycles
+               );
+
+/* Executa un pas (com Z80_run) comptant-lo. Ho fa la pròpia
+ * llibreria.
+ */
+int
+GG_prof_run (void);
+
+
+/**********/
+/* ACCLOG */
+/**********/
+/* Registre d'accessos a memòria filtrat per rangs d'adreces del
+ * processador i per tipus d'accés. A diferència de
+ * GG_TraceCallbacks.mem_access inclou la SRAM i la ROM, i no crida
+ * cap funció per accés: els accessos es guarden en un buffer
+ * reservat per endavant que es buida cridant a FLUSH quan s'ompli,
+ * o amb GG_acclog_flush. Funciona en tots els modes d'execució.
+ */
+
+/* Màscara de tipus d'accés. */
+#define GG_ACCLOG_READ  (1<<GG_READ)
+#define GG_ACCLOG_WRITE (1<<GG_WRITE)
+
+/* Flags d'un accés. */
+#define GG_ACCLOG_SRAM 0x01
+
+typedef struct
+{
+  
+  Z80u16 addr;          /* Adreça del processador. */
+  Z80u8  data;
+  Z80u8  type;          /* GG_MemAccessType. */
+  Z80u8  bank;          /* Banc de ROM, 0xFF si és RAM o SRAM. */
+  Z80u8  flags;
+  
+} GG_AccessHit;
+
+/* Rep els accessos registrats des de l'últim buidat. */
+typedef void (GG_AccessFlush) (
+        		       const GG_AccessHit *hits,
+        		       const int           n,
+        		       void               *udata
+        		       );
+
+typedef struct
+{
+  
+  uint64_t hits;        /* Accessos registrats. */
+  uint64_t dropped;     /* Perduts per no tindre FLUSH. */
+  uint64_t flushes;
+  int      pending;     /* Accessos en el buffer. */
+  
+} GG_AcclogStats;
+
+/* Reserva un buffer de SIZE accessos. Si FLUSH és NULL, quan
+ * s'ompli es perden els següents. No registra res fins que s'afig
+ * un rang. Tanca el registre anterior. Torna 0 si tot ha anat bé.
+ */
+int
+GG_acclog_init (
+        	const int       size,
+        	GG_AccessFlush *flush,
+        	void           *udata
+        	);
+
+/* Buida el buffer i allibera la memòria. */
+void
+GG_acclog_close (void);
+
+/* Registra els accessos de tipus MASK (GG_ACCLOG_READ,
+ * GG_ACCLOG_WRITE) a les adreces FIRST a LAST (incloses). Torna 0 si
+ * tot ha anat bé.
+ */
+int
+GG_acclog_add_range (
+        	     const Z80u16 first,
+        	     const Z80u16 last,
+        	     const int    mask
+        	     );
+
+/* Lleva tots els rangs. */
+void
+GG_acclog_clear_ranges (void);
+
+/* Crida a FLUSH amb els accessos pendents. */
+void
+GG_acclog_flush (void);
+
+/* Si FLUSH és NULL, copia els accessos pendents en OUT (com a molt
+ * N) i els descarta. Torna el número d'accessos copiats.
+ */
+int
+GG_acclog_read (
+        	GG_AccessHit *out,
+        	const int     n
+        	);
+
+void
+GG_acclog_get_stats (
+        	     GG_AcclogStats *stats
+        	     );
+
+/* Ho crida el mòdul de memòria en cada accés. */
+void
+GG_acclog_access (
+        	  const GG_MemAccessType type,
+        	  const Z80u16           addr,
+        	  const Z80u8            data
+        	  );
+
+
+/********/
+/* IDLE */
+/********/
+/* Detecció de bucles d'espera. Molts jocs esperen la interrupció de
+ * 'frame' en un bucle curt que llig una variable en RAM, o el
+ * registre d'estat o el comptador V del VDP. Quan està activat,
+ * GG_loop busca de tant en tant un salt cap arrere de com a molt 32
+ * bytes i grava una volta del bucle. Si la volta no escriu en
+ * memòria, sols llig ports del VDP sense efectes laterals i no depén
+ * del que ha fet la volta anterior, la UCP no canviarà fins al
+ * següent event del VDP o del PSG, i es boten directament les voltes
+ * que caben abans, sumant els mateixos cicles. L'única diferència
+ * amb executar-les és el registre R. No es fa mentre s'està perfilant
+ * o hi ha punts de ruptura.
+ */
+
+typedef struct
+{
+  
+  uint64_t probes;      /* Sondejos. */
+  uint64_t loops;       /* Bucles d'espera trobats. */
+  uint64_t skips;       /* Vegades que s'han botat voltes. */
+  uint64_t cycles;      /* Cicles botats. */
+  
+} GG_IdleStats;
+
+/* Activa o desactiva la detecció. Té efecte al final del 'frame' si
+ * GG_loop s'està executant.
+ */
+void
+GG_idle_set_enabled (
+        	     const Z80_Bool enabled
+        	     );
+
+Z80_Bool
+GG_idle_is_enabled (void);
+
+void
+GG_idle_get_stats (
+        	   GG_IdleStats *stats
+        	   );
+
+/* Executa un pas (com Z80_run) buscant bucles d'espera. Torna els
+ * cicles executats més els botats. Ho fa la pròpia llibreria.
+ */
+int
+GG_idle_run (void);
+
+
+/*********/
+/* TURBO */
+/*********/
+/* Avança ràpidament, per exemple per a botar introduccions. Sols es
+ * mostra un de cada NTH 'frames', no es calculen les mostres de so
+ * (no es crida a GG_PlaySound, veure GG_psg_set_fast) i dins de
+ * GG_loop CHECKSIGNALS es crida amb menys freqüència. La velocitat es
+ * limita a SPEED vegades la real, o no es limita si és
+ * GG_TURBO_MAX. Mentre està actiu RUNAHEAD no fa res. L'estat simulat
+ * és el mateix que sense turbo.
+ */
+
+#define GG_TURBO_MAX 0.0
+
+typedef struct
+{
+  
+  double        speed;     /* Velocitat aconseguida respecte a la
+        		      real, mesurada cada mig segon. */
+  unsigned long frames;    /* 'Frames' executats. */
+  unsigned long shown;     /* 'Frames' mostrats. */
+  
+} GG_TurboStats;
+
+/* Activa el mode turbo o en canvia els paràmetres. Torna 0 si tot ha
+ * anat bé, -1 si els paràmetres no són vàlids.
+ */
+int
+GG_turbo_enable (
+        	 const double speed,
+        	 const int    nth
+        	 );
+
+void
+GG_turbo_disable (void);
+
+Z80_Bool
+GG_turbo_is_enabled (void);
+
+void
+GG_turbo_get_stats (
+        	    GG_TurboStats *stats
+        	    );
+
+/* S'ha de cridar al final de cada 'frame'. Ho fa la pròpia llibreria. */
+void
+GG_turbo_frame (void);
+
+
+/********/
+/* PERF */
+/********/
+/* Comptadors de rendiment per subsistema. Sols es mesura si la
+ * llibreria es compila amb -DGG_PERF; en cas contrari les macros
+ * GG_PERF_* no fan res i els comptadors estan sempre a 0. Es mesura
+ * el temps del 'host' i les crides de cada part, acumulats per
+ * 'frame'. El temps de la UCP és el que resta del 'frame' després de
+ * llevar les altres parts, per tant inclou la memòria, els ports i la
+ * resta del bucle. Les crides de la UCP són els passos executats dins
+ * de GG_loop i GG_iter.
+ */
+
+typedef enum
+  {
+    GG_PERF_CPU,              /* UCP i la resta. */
+    GG_PERF_RENDER,           /* Dibuixat de línies del VDP. */
+    GG_PERF_SAT,              /* Avaluació de la taula de sprites. */
+    GG_PERF_SYNTH,            /* Síntesi dels canals del PSG. */
+    GG_PERF_MIX,              /* Mescla dels canals del PSG. */
+    GG_PERF_UPDATE_SCREEN,    /* Crides al 'frontend'. */
+    GG_PERF_PLAY_SOUND,
+    GG_PERF_CHECK,
+    GG_PERF_CHECK_BUTTONS,
+    GG_PERF_NCOUNTERS
+  } GG_PerfCounter;
+
+typedef struct
+{
+  
+  uint64_t calls;
+  uint64_t ns;       /* Temps en nanosegons. */
+  
+} GG_PerfValue;
+
+typedef struct
+{
+  
+  unsigned long frames;                          /* 'Frames' mesurats. */
+  uint64_t      frame_ns;                        /* Temps total. */
+  uint64_t      last_frame_ns;                   /* Temps de l'últim. */
+  GG_PerfValue  total[GG_PERF_NCOUNTERS];
+  GG_PerfValue  last[GG_PERF_NCOUNTERS];         /* De l'últim 'frame'. */
+  
+} GG_PerfStats;
+
+#ifdef GG_PERF
+#define GG_PERF_BEGIN(COUNTER) GG_perf_begin ( (COUNTER) )
+#define GG_PERF_END(COUNTER) GG_perf_end ( (COUNTER) )
+#define GG_PERF_COUNT(COUNTER) GG_perf_count ( (COUNTER) )
+#define GG_PERF_FRAME() GG_perf_frame ()
+#else
+#define GG_PERF_BEGIN(COUNTER) ((void) 0)
+#define GG_PERF_END(COUNTER) ((void) 0)
+#define GG_PERF_COUNT(COUNTER) ((void) 0)
+#define GG_PERF_FRAME() ((void) 0)
+#endif
+
+/* Torna cert si la llibreria s'ha compilat amb GG_PERF. */
+Z80_Bool
+GG_perf_is_available (void);
+
+void
+GG_perf_get_stats (
+        	   GG_PerfStats *stats
+        	   );
+
+/* Posa a 0 els comptadors. El següent 'frame' no es mesura sencer i
+ * no es compta.
+ */
+void
+GG_perf_reset (void);
+
+/* Funcions emprades per les macros. Ho fa la pròpia llibreria. */
+void
+GG_perf_begin (
+               const GG_PerfCounter counter
+               );
+
+void
+GG_perf_end (
+             const GG_PerfCounter counter
+             );
+
+void
+GG_perf_count (
+               const GG_PerfCounter counter
+               );
+
+void
+GG_perf_frame (void);
+
+
+/******/
+/* IO */
+/******/
+/* Descodificació dels ports d'entrada/eixida ('Z80_io_read' i
+ * 'Z80_io_write').
+ */
+
+/* Construeix les taules de ports. Els avisos (per exemple accessos a
+ * funcionalitats no implementades) es mostren amb WARN, com a màxim
+ * uns pocs per inicialització. Ho fa GG_init.
+ */
+void
+GG_io_init (
+            GG_Warning *warn,
+            void       *udata
+            );
+
+/* Activa o desactiva la comprovació dels 'watchpoints' d'E/S en cada
+ * accés. Ho fa el mòdul BREAK.
+ */
+void
+GG_io_set_watch (
+        	 const Z80_Bool val
+        	 );
+
 
 #endif /* __GG_H__ */
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  acclog.c - Implementació del mòdul ACCLOG.
+ *
+ *  NOTES: Els rangs es guarden com un mapa de bits de 64K adreces per
+ *  tipus d'accés, per tant filtrar costa el mateix independentment
+ *  del número de rangs.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define TEST(MAP,I) (((MAP)[(I)>>3]>>((I)&0x7))&0x1)
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Rangs. */
+static Z80u8 _map[2][0x10000/8];
+static Z80_Bool _has_ranges= Z80_FALSE;
+
+/* Buffer. */
+static GG_AccessHit *_hits= NULL;
+static int _size;
+static int _n;
+static GG_AccessFlush *_flush;
+static void *_udata;
+
+static GG_AcclogStats _stats;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+update_mem (void)
+{
+  GG_mem_set_log ( _hits != NULL && _has_ranges );
+} /* end update_mem */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_acclog_access (
+        	  const GG_MemAccessType type,
+        	  const Z80u16           addr,
+        	  const Z80u8            data
+        	  )
+{
+  
+  GG_AccessHit *hit;
+  int bank;
+  
+  
+  if ( !TEST ( _map[type], addr ) ) return;
+  if ( _n == _size )
+    {
+      if ( _flush == NULL ) { ++_stats.dropped; return; }
+      GG_acclog_flush ();
+    }
+  hit= &(_hits[_n++]);
+  hit->addr= addr;
+  hit->data= data;
+  hit->type= (Z80u8) type;
+  bank= GG_mem_get_bank ( addr );
+  hit->bank= bank == -1 ? 0xFF : (Z80u8) bank;
+  hit->flags= GG_mem_is_sram ( addr ) ? GG_ACCLOG_SRAM : 0;
+  ++_stats.hits;
+  
+} /* end GG_acclog_access */
+
+
+int
+GG_acclog_add_range (
+        	     const Z80u16 first,
+        	     const Z80u16 last,
+        	     const int    mask
+        	     )
+{
+  
+  int i, t;
+  
+  
+  if ( last < first || (mask&~(GG_ACCLOG_READ|GG_ACCLOG_WRITE)) != 0 )
+    return -1;
+  for ( t= 0; t < 2; ++t )
+    if ( mask&(1<<t) )
+      for ( i= first; i <= last; ++i )
+        _map[t][i>>3]|= 1<<(i&0x7);
+  if ( mask != 0 ) _has_ranges= Z80_TRUE;
+  update_mem ();
+  
+  return 0;
+  
+} /* end GG_acclog_add_range */
+
+
+void
+GG_acclog_clear_ranges (void)
+{
+  
+  memset ( _map, 0, sizeof(_map) );
+  _has_ranges= Z80_FALSE;
+  update_mem ();
+  
+} /* end GG_acclog_clear_ranges */
+
+
+void
+GG_acclog_close (void)
+{
+  
+  if ( _hits == NULL ) return;
+  GG_acclog_flush ();
+  free ( _hits );
+  _hits= NULL;
+  _n= 0;
+  update_mem ();
+  
+} /* end GG_acclog_close */
+
+
+void
+GG_acclog_flush (void)
+{
+  
+  if ( _n == 0 || _flush == NULL ) return;
+  _flush ( _hits, _n, _udata );
+  _n= 0;
+  ++_stats.flushes;
+  
+} /* end GG_acclog_flush */
+
+
+void
+GG_acclog_get_stats (
+        	     GG_AcclogStats *stats
+        	     )
+{
+  
+  *stats= _stats;
+  stats->pending= _n;
+  
+} /* end GG_acclog_get_stats */
+
+
+int
+GG_acclog_init (
+        	const int       size,
+        	GG_AccessFlush *flush,
+        	void           *udata
+        	)
+{
+  
+  GG_acclog_close ();
+  if ( size <= 0 ) return -1;
+  _hits= (GG_AccessHit *) malloc ( size*sizeof(GG_AccessHit) );
+  if ( _hits == NULL ) return -1;
+  _size= size;
+  _n= 0;
+  _flush= flush;
+  _udata= udata;
+  memset ( &_stats, 0, sizeof(_stats) );
+  update_mem ();
+  
+  return 0;
+  
+} /* end GG_acclog_init */
+
+
+int
+GG_acclog_read (
+        	GG_AccessHit *out,
+        	const int     n
+        	)
+{
+  
+  int ret;
+  
+  
+  if ( _hits == NULL || _flush != NULL ) return 0;
+  ret= n < _n ? n : _n;
+  memcpy ( out, _hits, ret*sizeof(GG_AccessHit) );
+  memmove ( _hits, _hits+ret, (_n-ret)*sizeof(GG_AccessHit) );
+  _n-= ret;
+  
+  return ret;
+  
+} /* end GG_acclog_read */
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  audio.c - Implementació del buffer circular d'àudio.
+ *
+ *  NOTES: El buffer és d'un únic productor i un únic consumidor. Cada
+ *  fil sols modifica el seu índex, i els índexs no es reinicien mai
+ *  (es fa la màscara al accedir), d'aquesta manera la diferència
+ *  entre els dos és sempre el número de 'frames' disponibles.
+ *
+ */
+
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+struct GG_AudioRing
+{
+
+  double        *buf;         /* Mostres intercalades (esquerra,dreta). */
+  unsigned int   size;        /* Grandària en 'frames'. Potència de 2. */
+  unsigned int   mask;        /* size-1. */
+  atomic_uint    w;           /* Següent 'frame' a escriure. Sols el
+        			 modifica el productor. */
+  atomic_uint    r;           /* Següent 'frame' a llegir. Sols el
+        			 modifica el consumidor. */
+  atomic_ulong   underruns;   /* Sols el modifica el consumidor. */
+  atomic_ulong   overruns;    /* Sols el modifica el productor. */
+
+};
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+/* Copia N 'frames' de FRAMES al buffer a partir de la posició POS
+ * tenint en compter que pot donar la volta.
+ */
+static void
+copy_to_ring (
+              GG_AudioRing       *ring,
+              const unsigned int  pos,
+              const double       *frames,
+              const unsigned int  n
+              )
+{
+
+  unsigned int begin, n1;
+
+
+  begin= pos&ring->mask;
+  n1= ring->size - begin;
+  if ( n1 > n ) n1= n;
+  memcpy ( ring->buf + 2*begin, frames, 2*n1*sizeof(double) );
+  if ( n1 < n )
+    memcpy ( ring->buf, frames + 2*n1, 2*(n-n1)*sizeof(double) );
+
+} /* end copy_to_ring */
+
+
+static void
+copy_from_ring (
+        	const GG_AudioRing *ring,
+        	const unsigned int  pos,
+        	double             *frames,
+        	const unsigned int  n
+        	)
+{
+
+  unsigned int begin, n1;
+
+
+  begin= pos&ring->mask;
+  n1= ring->size - begin;
+  if ( n1 > n ) n1= n;
+  memcpy ( frames, ring->buf + 2*begin, 2*n1*sizeof(double) );
+  if ( n1 < n )
+    memcpy ( frames + 2*n1, ring->buf, 2*(n-n1)*sizeof(double) );
+
+} /* end copy_from_ring */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+GG_AudioRing *
+GG_audio_ring_new (
+        	   const int nframes
+        	   )
+{
+
+  GG_AudioRing *ret;
+  unsigned int size;
+
+
+  if ( nframes <= 0 ) return NULL;
+  for ( size= 1; size < (unsigned int) nframes; size<<= 1 );
+  ret= (GG_AudioRing *) malloc ( sizeof(GG_AudioRing) );
+  if ( ret == NULL ) return NULL;
+  ret->buf= (double *) malloc ( 2*size*sizeof(double) );
+  if ( ret->buf == NULL ) { free ( ret ); return NULL; }
+  ret->size= size;
+  ret->mask= size-1;
+  atomic_init ( &ret->w, 0 );
+  atomic_init ( &ret->r, 0 );
+  atomic_init ( &ret->underruns, 0 );
+  atomic_init ( &ret->overruns, 0 );
+
+  return ret;
+
+} /* end GG_audio_ring_new */
+
+
+void
+GG_audio_ring_free (
+        	    GG_AudioRing *ring
+        	    )
+{
+
+  if ( ring == NULL ) return;
+  free ( ring->buf );
+  free ( ring );
+
+} /* end GG_audio_ring_free */
+
+
+void
+GG_audio_ring_clear (
+        	     GG_AudioRing *ring
+        	     )
+{
+
+  atomic_store ( &ring->w, 0 );
+  atomic_store ( &ring->r, 0 );
+
+} /* end GG_audio_ring_clear */
+
+
+int
+GG_audio_ring_get_fill (
+        		GG_AudioRing *ring
+        		)
+{
+
+  unsigned int w, r;
+
+
+  w= atomic_load_explicit ( &ring->w, memory_order_acquire );
+  r= atomic_load_explicit ( &ring->r, memory_order_acquire );
+
+  return (int) (w-r);
+
+} /* end GG_audio_ring_get_fill */
+
+
+int
+GG_audio_ring_get_size (
+        		const GG_AudioRing *ring
+        		)
+{
+  return (int) ring->size;
+} /* end GG_audio_ring_get_size */
+
+
+void
+GG_audio_ring_get_stats (
+        		 GG_AudioRing      *ring,
+        		 GG_AudioRingStats *stats
+        		 )
+{
+
+  stats->underruns= atomic_load_explicit ( &ring->underruns,
+        				   memory_order_relaxed );
+  stats->overruns= atomic_load_explicit ( &ring->overruns,
+        				  memory_order_relaxed );
+
+} /* end GG_audio_ring_get_stats */
+
+
+int
+GG_audio_ring_read (
+        	    GG_AudioRing *ring,
+        	    double       *frames,
+        	    const int     nframes
+        	    )
+{
+
+  unsigned int w, r, n;
+
+
+  r= atomic_load_explicit ( &ring->r, memory_order_relaxed );
+  w= atomic_load_explicit ( &ring->w, memory_order_acquire );
+  n= w-r;
+  if ( n > (unsigned int) nframes ) n= (unsigned int) nframes;
+  copy_from_ring ( ring, r, frames, n );
+  atomic_store_explicit ( &ring->r, r+n, memory_order_release );
+  if ( n < (unsigned int) nframes )
+    atomic_fetch_add_explicit ( &ring->underruns, nframes-n,
+        			memory_order_relaxed );
+
+  return (int) n;
+
+} /* end GG_audio_ring_read */
+
+
+int
+GG_audio_ring_write (
+        	     GG_AudioRing *ring,
+        	     const double *frames,
+        	     const int     nframes
+        	     )
+{
+
+  unsigned int w, r, n;
+
+
+  w= atomic_load_explicit ( &ring->w, memory_order_relaxed );
+  r= atomic_load_explicit ( &ring->r, memory_order_acquire );
+  n= ring->size - (w-r);
+  if ( n > (unsigned int) nframes ) n= (unsigned int) nframes;
+  copy_to_ring ( ring, w, frames, n );
+  atomic_store_explicit ( &ring->w, w+n, memory_order_release );
+  if ( n < (unsigned int) nframes )
+    atomic_fetch_add_explicit ( &ring->overruns, nframes-n,
+        			memory_order_relaxed );
+
+  return (int) n;
+
+} /* end GG_audio_ring_write */
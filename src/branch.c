@@ -0,0 +1,289 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  branch.c - Implementació del mòdul BRANCH.
+ *
+ *  NOTES: Cada pàgina té un comptador amb les referències de les
+ *  bifurcacions i de la taula de la màquina. Una pàgina no es
+ *  modifica mai després de crear-la, per tant crear una bifurcació
+ *  sols copia les pàgines que la màquina ha escrit des de l'última
+ *  (les que tenen NULL en la taula), i carregar-la sols copia les
+ *  que són distintes a les de la màquina.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+struct GG_Branch
+{
+  
+  GG_Page *ram[GG_RAM_PAGES];
+  GG_Page *sram[GG_SRAM_PAGES];
+  GG_Page *vram[GG_VRAM_PAGES];
+  size_t   size;
+  Z80u8    state[];      /* Resta de l'estat en format portable. */
+  
+};
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Buffer on es guarda la resta de l'estat abans de saber la
+   grandària. */
+static Z80u8 *_buf= NULL;
+static size_t _buf_size= 0;
+
+/* Estadístiques. */
+static int _branches= 0;
+static int _pages= 0;
+static size_t _bytes= 0;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static GG_Page *
+page_new (
+          const Z80u8 *data
+          )
+{
+  
+  GG_Page *ret;
+  
+  
+  ret= (GG_Page *) malloc ( sizeof(GG_Page) );
+  if ( ret == NULL ) return NULL;
+  ret->refs= 1;
+  memcpy ( ret->data, data, GG_PAGE_SIZE );
+  ++_pages;
+  
+  return ret;
+  
+} /* end page_new */
+
+
+static void
+unref_all (
+           GG_Page   *table[],
+           const int  N
+           )
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < N; ++i )
+    if ( table[i] != NULL ) GG_page_unref ( table[i] );
+  
+} /* end unref_all */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_branch_free (
+        	GG_Branch *branch
+        	)
+{
+  
+  if ( branch == NULL ) return;
+  unref_all ( branch->ram, GG_RAM_PAGES );
+  unref_all ( branch->sram, GG_SRAM_PAGES );
+  unref_all ( branch->vram, GG_VRAM_PAGES );
+  _bytes-= sizeof(GG_Branch) + branch->size;
+  --_branches;
+  free ( branch );
+  
+} /* end GG_branch_free */
+
+
+void
+GG_branch_get_stats (
+        	     GG_BranchStats *stats
+        	     )
+{
+  
+  stats->branches= _branches;
+  stats->pages= _pages;
+  stats->bytes= _bytes + (size_t) _pages*sizeof(GG_Page);
+  
+} /* end GG_branch_get_stats */
+
+
+int
+GG_branch_load (
+        	const GG_Branch *branch
+        	)
+{
+  
+  GG_StateChunks chunks;
+  
+  
+  if ( GG_state_index ( branch->state, branch->size, &chunks ) != 0 )
+    return -1;
+  GG_mem_branch_load ( branch->ram, branch->sram );
+  GG_vdp_branch_load ( branch->vram );
+  
+  return GG_load_state_chunks ( &chunks );
+  
+} /* end GG_branch_load */
+
+
+GG_Branch *
+GG_branch_new (void)
+{
+  
+  GG_Branch *ret;
+  Z80u8 *aux;
+  size_t size;
+  
+  
+  /* Primer la resta de l'estat, que és de grandària variable. */
+  size= GG_state_size ();
+  if ( size > _buf_size )
+    {
+      aux= (Z80u8 *) realloc ( _buf, size );
+      if ( aux == NULL ) return NULL;
+      _buf= aux;
+      _buf_size= size;
+    }
+  size= GG_save_state_branch_mem ( _buf );
+  if ( size == 0 ) return NULL;
+  ret= (GG_Branch *) malloc ( sizeof(GG_Branch) + size );
+  if ( ret == NULL ) return NULL;
+  memcpy ( ret->state, _buf, size );
+  ret->size= size;
+  memset ( ret->ram, 0, sizeof(ret->ram) );
+  memset ( ret->sram, 0, sizeof(ret->sram) );
+  memset ( ret->vram, 0, sizeof(ret->vram) );
+  _bytes+= sizeof(GG_Branch) + size;
+  ++_branches;
+  
+  /* Pàgines. */
+  if ( GG_mem_branch_save ( ret->ram, ret->sram ) != 0 ||
+       GG_vdp_branch_save ( ret->vram ) != 0 )
+    {
+      GG_branch_free ( ret );
+      return NULL;
+    }
+  
+  return ret;
+  
+} /* end GG_branch_new */
+
+
+void
+GG_page_release (
+        	 GG_Page   *table[],
+        	 const int  N
+        	 )
+{
+  
+  unref_all ( table, N );
+  memset ( table, 0, N*sizeof(GG_Page *) );
+  
+} /* end GG_page_release */
+
+
+void
+GG_page_restore (
+        	 GG_Page       *table[],
+        	 Z80u8         *mem,
+        	 const int      N,
+        	 GG_Page *const in[]
+        	 )
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < N; ++i )
+    if ( table[i] != in[i] )
+      {
+        if ( table[i] != NULL ) GG_page_unref ( table[i] );
+        memcpy ( mem + i*GG_PAGE_SIZE, in[i]->data, GG_PAGE_SIZE );
+        table[i]= in[i];
+        ++(in[i]->refs);
+      }
+  
+} /* end GG_page_restore */
+
+
+int
+GG_page_share (
+               GG_Page     *table[],
+               const Z80u8 *mem,
+               const int    N,
+               GG_Page     *out[]
+               )
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < N; ++i )
+    {
+      if ( table[i] == NULL &&
+           (table[i]= page_new ( mem + i*GG_PAGE_SIZE )) == NULL )
+        return -1;
+      out[i]= table[i];
+      ++(out[i]->refs);
+    }
+  
+  return 0;
+  
+} /* end GG_page_share */
+
+
+void
+GG_page_unref (
+               GG_Page *page
+               )
+{
+  
+  if ( --(page->refs) == 0 )
+    {
+      free ( page );
+      --_pages;
+    }
+  
+} /* end GG_page_unref */
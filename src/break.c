@@ -0,0 +1,356 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  break.c - Implementació del mòdul BREAK.
+ *
+ *  NOTES: Cada mapa de bits porta un comptador de bits actius, per a
+ *  saber sense recórrer-lo si cal comprovar-lo. Els punts de
+ *  ruptura d'execució de cada banc es reserven quan es posa el
+ *  primer.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define TEST(MAP,I) (((MAP)[(I)>>3]>>((I)&0x7))&0x1)
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+#define BANK_SIZE 0x4000
+
+/* Adreces de l'àrea 2 i 3. */
+#define OTHER_SIZE 0x8000
+
+/* Grandària de cada espai de 'watchpoints'. */
+static const int SPACE_SIZE[GG_WATCH_NSPACES]=
+  {
+    0x2000,     /* RAM. */
+    0x4000,     /* VRAM. */
+    0x100       /* I/O. */
+  };
+
+/* Raó per espai i tipus d'accés. */
+static const GG_BreakReason REASON[GG_WATCH_NSPACES][2]=
+  {
+    { GG_BREAK_RAM_READ, GG_BREAK_RAM_WRITE },
+    { GG_BREAK_VRAM_READ, GG_BREAK_VRAM_WRITE },
+    { GG_BREAK_IO_READ, GG_BREAK_IO_WRITE }
+  };
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Punts de ruptura d'execució. */
+static Z80u8 *_exec[256];
+static Z80u8 *_exec_other;
+static int _nexec;
+
+/* 'Watchpoints'. */
+static Z80u8 _ram_map[2][0x2000/8];
+static Z80u8 _vram_map[2][0x4000/8];
+static Z80u8 _io_map[2][0x100/8];
+static Z80u8 *const _maps[GG_WATCH_NSPACES][2]=
+  {
+    { _ram_map[0], _ram_map[1] },
+    { _vram_map[0], _vram_map[1] },
+    { _io_map[0], _io_map[1] }
+  };
+static int _nwatch[GG_WATCH_NSPACES];
+
+/* Últim event. */
+static GG_BreakEvent _event;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+/* Activa o desactiva el bit I. Torna 1 si s'ha activat, -1 si s'ha
+   desactivat i 0 si no ha canviat. */
+static int
+set_bit (
+         Z80u8          *map,
+         const int       i,
+         const Z80_Bool  enable
+         )
+{
+  
+  Z80u8 mask;
+  
+  
+  mask= 1<<(i&0x7);
+  if ( enable && !(map[i>>3]&mask) ) { map[i>>3]|= mask; return 1; }
+  if ( !enable && (map[i>>3]&mask) ) { map[i>>3]&= ~mask; return -1; }
+  
+  return 0;
+  
+} /* end set_bit */
+
+
+static void
+hit (
+     const GG_WatchSpace    space,
+     const GG_MemAccessType type,
+     const int              addr,
+     const Z80u8            data
+     )
+{
+  
+  if ( _event.reason != GG_BREAK_NONE ) return;
+  _event.reason= REASON[space][type];
+  _event.addr= addr;
+  _event.bank= -1;
+  _event.data= data;
+  
+} /* end hit */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+Z80_Bool
+GG_break_check_exec (void)
+{
+  
+  Z80_Step step;
+  Z80u16 pc;
+  const Z80u8 *map;
+  int bank;
+  
+  
+  pc= Z80_decode_next_step ( &step );
+  if ( step.type == Z80_STEP_INST ) pc-= step.val.inst.nbytes;
+  bank= GG_mem_get_bank ( pc );
+  map= bank == -1 ? _exec_other : _exec[bank];
+  if ( map == NULL ||
+       !TEST ( map, bank == -1 ? (pc&(OTHER_SIZE-1)) : (pc&(BANK_SIZE-1)) ) )
+    return Z80_FALSE;
+  _event.reason= GG_BREAK_EXEC;
+  _event.addr= pc;
+  _event.bank= bank;
+  _event.data= 0;
+  
+  return Z80_TRUE;
+  
+} /* end GG_break_check_exec */
+
+
+void
+GG_break_clear (void)
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < 256; ++i )
+    {
+      free ( _exec[i] );
+      _exec[i]= NULL;
+    }
+  free ( _exec_other );
+  _exec_other= NULL;
+  _nexec= 0;
+  memset ( _ram_map, 0, sizeof(_ram_map) );
+  memset ( _vram_map, 0, sizeof(_vram_map) );
+  memset ( _io_map, 0, sizeof(_io_map) );
+  memset ( _nwatch, 0, sizeof(_nwatch) );
+  GG_mem_set_watch ( Z80_FALSE );
+  GG_vdp_set_watch ( Z80_FALSE );
+  GG_io_set_watch ( Z80_FALSE );
+  _event.reason= GG_BREAK_NONE;
+  
+} /* end GG_break_clear */
+
+
+void
+GG_break_clear_event (void)
+{
+  _event.reason= GG_BREAK_NONE;
+} /* end GG_break_clear_event */
+
+
+GG_BreakReason
+GG_break_get_reason (void)
+{
+  return _event.reason;
+} /* end GG_break_get_reason */
+
+
+void
+GG_break_get_event (
+        	    GG_BreakEvent *event
+        	    )
+{
+  *event= _event;
+} /* end GG_break_get_event */
+
+
+Z80_Bool
+GG_break_has_exec (void)
+{
+  return _nexec > 0;
+} /* end GG_break_has_exec */
+
+
+Z80_Bool
+GG_break_is_enabled (void)
+{
+  
+  return _nexec > 0 || _nwatch[GG_WATCH_RAM] > 0 ||
+    _nwatch[GG_WATCH_VRAM] > 0 || _nwatch[GG_WATCH_IO] > 0;
+  
+} /* end GG_break_is_enabled */
+
+
+void
+GG_break_ram (
+              const GG_MemAccessType type,
+              const Z80u16           addr,
+              const Z80u8            data
+              )
+{
+  
+  if ( TEST ( _ram_map[type], addr ) )
+    hit ( GG_WATCH_RAM, type, addr, data );
+  
+} /* end GG_break_ram */
+
+
+void
+GG_break_io (
+             const GG_MemAccessType type,
+             const Z80u8            port,
+             const Z80u8            data
+             )
+{
+  
+  if ( TEST ( _io_map[type], port ) )
+    hit ( GG_WATCH_IO, type, port, data );
+  
+} /* end GG_break_io */
+
+
+int
+GG_break_set_exec (
+        	   const int      bank,
+        	   const Z80u16   addr,
+        	   const Z80_Bool enable
+        	   )
+{
+  
+  Z80u8 **map;
+  size_t size;
+  
+  
+  if ( bank < -1 || bank > 255 ) return -1;
+  if ( bank == -1 )
+    {
+      if ( addr < 0x8000 ) return -1;
+      map= &_exec_other;
+      size= OTHER_SIZE/8;
+    }
+  else
+    {
+      map= &_exec[bank];
+      size= BANK_SIZE/8;
+    }
+  if ( *map == NULL )
+    {
+      if ( !enable ) return 0;
+      *map= (Z80u8 *) calloc ( size, 1 );
+      if ( *map == NULL ) return -1;
+    }
+  _nexec+= set_bit ( *map, bank == -1 ?
+        	     (addr&(OTHER_SIZE-1)) : (addr&(BANK_SIZE-1)), enable );
+  
+  return 0;
+  
+} /* end GG_break_set_exec */
+
+
+int
+GG_break_set_watch (
+        	    const GG_WatchSpace    space,
+        	    const GG_MemAccessType type,
+        	    const int              first,
+        	    const int              last,
+        	    const Z80_Bool         enable
+        	    )
+{
+  
+  int i;
+  
+  
+  if ( space < 0 || space >= GG_WATCH_NSPACES ||
+       (type != GG_READ && type != GG_WRITE) ||
+       first < 0 || last < first || last >= SPACE_SIZE[space] )
+    return -1;
+  for ( i= first; i <= last; ++i )
+    _nwatch[space]+= set_bit ( _maps[space][type], i, enable );
+  switch ( space )
+    {
+    case GG_WATCH_RAM: GG_mem_set_watch ( _nwatch[space] > 0 ); break;
+    case GG_WATCH_VRAM: GG_vdp_set_watch ( _nwatch[space] > 0 ); break;
+    case GG_WATCH_IO: GG_io_set_watch ( _nwatch[space] > 0 ); break;
+    default: break;
+    }
+  
+  return 0;
+  
+} /* end GG_break_set_watch */
+
+
+void
+GG_break_vram (
+               const GG_MemAccessType type,
+               const Z80u16           addr,
+               const Z80u8            data
+               )
+{
+  
+  if ( TEST ( _vram_map[type], addr ) )
+    hit ( GG_WATCH_VRAM, type, addr, data );
+  
+} /* end GG_break_vram */
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  clock.c - Implementació del mòdul CLOCK.
+ *
+ *  NOTES: 'clock_nanosleep' no modifica 'errno' sinó que torna el
+ *  codi de l'error.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "GG.h"
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+uint64_t
+GG_clock_get_ns (void)
+{
+  
+  struct timespec ts;
+  
+  
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+  
+  return ((uint64_t) ts.tv_sec)*1000000000 + (uint64_t) ts.tv_nsec;
+  
+} /* end GG_clock_get_ns */
+
+
+double
+GG_clock_get (void)
+{
+  
+  struct timespec ts;
+  
+  
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+  
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+  
+} /* end GG_clock_get */
+
+
+void
+GG_clock_sleep_until (
+        	      const double t
+        	      )
+{
+  
+  struct timespec ts;
+  
+  
+  ts.tv_sec= (time_t) t;
+  ts.tv_nsec= (long) ((t-(double) ts.tv_sec)*1e9);
+  while ( clock_nanosleep ( CLOCK_MONOTONIC, TIMER_ABSTIME,
+        		    &ts, NULL ) == EINTR );
+  
+} /* end GG_clock_sleep_until */
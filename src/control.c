@@ -21,6 +21,12 @@
  *
  *  NOTA: NO ESTIC IMPLEMENTANT EL CONTROL EXT.
  *
+ *  ENTRADA FIXADA: Quan l'entrada es fixa per 'frame' (per exemple
+ *  per al joc en xarxa) no es crida a 'check_buttons'. El segon
+ *  jugador segueix la convenció de la Master System: amunt i avall
+ *  en els bits 6 i 7 del port $DC, i la resta en els bits 0-3 del
+ *  port $DD.
+ *
  */
 
 
@@ -37,6 +43,39 @@
 static void *_udata;
 static GG_CheckButtons *_check_buttons;
 
+/* Entrada fixada. */
+static Z80_Bool _latched;
+static int _input[2];
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static int
+check_buttons (void)
+{
+  
+  int ret;
+  
+  
+  GG_PERF_BEGIN ( GG_PERF_CHECK_BUTTONS );
+  ret= _check_buttons ( _udata );
+  GG_PERF_END ( GG_PERF_CHECK_BUTTONS );
+  
+  return ret;
+  
+} /* end check_buttons */
+
+
+static int
+get_buttons (void)
+{
+  return _latched ? _input[0] : check_buttons ();
+} /* end get_buttons */
+
 
 
 
@@ -53,6 +92,7 @@ GG_control_init (
   
   _udata= udata;
   _check_buttons= check_buttons;
+  _latched= Z80_FALSE;
   
 } /* end GG_control_init */
 
@@ -60,19 +100,49 @@ GG_control_init (
 Z80u8
 GG_control_get_status1 (void)
 {
-  return (Z80u8) ~(_check_buttons ( _udata )&0x3F);
+  if ( _latched )
+    return (Z80u8) ~((_input[0]&0x3F) | ((_input[1]&0x03)<<6));
+  return (Z80u8) ~(check_buttons ()&0x3F);
 } /* GG_control_get_status1 */
 
 
 Z80u8
 GG_control_get_status_ext (void)
 {
-  return 0xFF;
+  return _latched ? (Z80u8) ~((_input[1]>>2)&0x0F) : 0xFF;
 } /* end GG_control_get_status_ext */
 
 
 Z80u8
 GG_control_get_status_start (void)
 {
-  return (_check_buttons ( _udata )&GG_START) ? 0x00 : 0x80;
+  return (get_buttons ()&GG_START) ? 0x00 : 0x80;
 } /* end GG_control_get_status_start */
+
+
+int
+GG_control_read_buttons (void)
+{
+  return check_buttons ();
+} /* end GG_control_read_buttons */
+
+
+void
+GG_control_release_input (void)
+{
+  _latched= Z80_FALSE;
+} /* end GG_control_release_input */
+
+
+void
+GG_control_set_input (
+        	      const int player1,
+        	      const int player2
+        	      )
+{
+  
+  _latched= Z80_TRUE;
+  _input[0]= player1;
+  _input[1]= player2;
+  
+} /* end GG_control_set_input */
@@ -0,0 +1,441 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  idle.c - Implementació del mòdul IDLE.
+ *
+ *  NOTES: Sols es pot saber el PC descodificant el següent pas, que
+ *  és car, per tant no es descodifica cada pas sinó que cada cert
+ *  número de cicles es fa un sondeig: es busca un salt cap arrere i
+ *  es grava una volta sencera del bucle. Una volta és un punt fix (la
+ *  següent volta deixa la UCP igual) si no escriu en memòria, sols
+ *  llig ports del VDP sense efectes laterals, i cap registre que
+ *  escriu depén del valor que tenia en la volta anterior. Per a
+ *  saber-ho es porten dos màscares de registres: els que s'han escrit
+ *  en la volta i els que s'han llegit abans d'escriure'ls (entrades).
+ *  Si una instrucció escriu una entrada el bucle no és ociós.
+ *
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* Grandària màxima del bucle en bytes. */
+#define MAX_LOOP 32
+
+/* Passos màxims d'un sondeig. */
+#define MAX_STEPS 64
+
+/* Cicles entre sondejos. Després de cada sondeig sense èxit es dobla
+   fins a MAX_PERIOD. */
+#define MIN_PERIOD 1024
+#define MAX_PERIOD 65536
+
+/* Registres. */
+#define RA 0x001
+#define RF 0x002
+#define RB 0x004
+#define RC 0x008
+#define RD 0x010
+#define RE 0x020
+#define RH 0x040
+#define RL 0x080
+#define RIXH 0x100
+#define RIXL 0x200
+#define RIYH 0x400
+#define RIYL 0x800
+
+/* Valor que indica que l'operand no és vàlid dins d'un bucle ociós. */
+#define BAD -1
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80_Bool _enabled= Z80_FALSE;
+
+/* Sondeig. */
+static enum
+  {
+    WAIT,          /* Esperant el següent sondeig. */
+    SEARCH,        /* Buscant el salt. */
+    RECORD         /* Gravant una volta. */
+  } _state;
+static int _cc;
+static int _period;
+static int _steps;
+
+/* Bucle. */
+static struct
+{
+  
+  Z80u16   begin;      /* Destí del salt. */
+  Z80u16   end;        /* Adreça del salt. */
+  int      cc;         /* Cicles de la volta. */
+  int      written;
+  int      inputs;
+  Z80_Bool vdp;        /* Llig ports del VDP. */
+  
+} _loop;
+
+static GG_IdleStats _stats;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+/* Registres que llig l'operand. */
+static int
+op_reads (
+          const Z80_Mode op
+          )
+{
+  
+  switch ( op )
+    {
+    case Z80_NONE:
+    case Z80_BYTE:
+    case Z80_WORD:
+    case Z80_ADDR:
+    case Z80_BRANCH:
+    case Z80_pBYTE:
+    case Z80_B0: case Z80_B1: case Z80_B2: case Z80_B3:
+    case Z80_B4: case Z80_B5: case Z80_B6: case Z80_B7:
+      return 0;
+    case Z80_A: return RA;
+    case Z80_B: return RB;
+    case Z80_C: return RC;
+    case Z80_D: return RD;
+    case Z80_E: return RE;
+    case Z80_H: return RH;
+    case Z80_L: return RL;
+    case Z80_IXH: return RIXH;
+    case Z80_IXL: return RIXL;
+    case Z80_IYH: return RIYH;
+    case Z80_IYL: return RIYL;
+    case Z80_BC: case Z80_pBC: return RB|RC;
+    case Z80_DE: case Z80_pDE: return RD|RE;
+    case Z80_HL: case Z80_pHL: return RH|RL;
+    case Z80_IX: case Z80_pIXd: return RIXH|RIXL;
+    case Z80_IY: case Z80_pIYd: return RIYH|RIYL;
+    case Z80_F_NZ: case Z80_F_Z: case Z80_F_NC: case Z80_F_C:
+    case Z80_F_PO: case Z80_F_PE: case Z80_F_P: case Z80_F_M:
+      return RF;
+    default: return BAD;
+    }
+  
+} /* end op_reads */
+
+
+/* Registres que escriu l'operand com a destí, BAD si no és un
+   registre. */
+static int
+op_writes (
+           const Z80_Mode op
+           )
+{
+  
+  switch ( op )
+    {
+    case Z80_A: case Z80_B: case Z80_C: case Z80_D: case Z80_E:
+    case Z80_H: case Z80_L: case Z80_IXH: case Z80_IXL: case Z80_IYH:
+    case Z80_IYL: case Z80_BC: case Z80_DE: case Z80_HL: case Z80_IX:
+    case Z80_IY:
+      return op_reads ( op );
+    default: return BAD;
+    }
+  
+} /* end op_writes */
+
+
+static Z80_Bool
+is_pair (
+         const Z80_Mode op
+         )
+{
+  return op == Z80_BC || op == Z80_DE || op == Z80_HL ||
+    op == Z80_IX || op == Z80_IY;
+} /* end is_pair */
+
+
+/* Port del VDP que es pot llegir sense efectes laterals: comptadors V
+   i H, i registre d'estat (sols esborra flags que han d'estar a 0
+   mentre dure el bucle). */
+static Z80_Bool
+vdp_port (
+          const Z80u8 port
+          )
+{
+  return (port >= 0x40 && port < 0x80) || (port >= 0x80 && port < 0xC0 &&
+        				   (port&0x1));
+} /* end vdp_port */
+
+
+/* Afig la instrucció a la volta. Torna fals si el bucle no és
+   ociós. */
+static Z80_Bool
+record (
+        const Z80_Inst *inst
+        )
+{
+  
+  int reads, writes, aux;
+  
+  
+  reads= op_reads ( inst->id.op1 );
+  aux= op_reads ( inst->id.op2 );
+  if ( reads == BAD || aux == BAD ) return Z80_FALSE;
+  reads|= aux;
+  switch ( inst->id.name )
+    {
+    case Z80_NOP: writes= 0; break;
+    case Z80_LD:
+      writes= op_writes ( inst->id.op1 );
+      if ( writes == BAD ) return Z80_FALSE;
+      reads= op_reads ( inst->id.op2 );
+      break;
+    case Z80_CP: writes= RF; reads|= RA; break;
+    case Z80_BIT: writes= RF; break;
+    case Z80_ADD: case Z80_ADC: case Z80_SUB: case Z80_SBC:
+    case Z80_AND: case Z80_OR: case Z80_XOR:
+      if ( inst->id.op2 == Z80_NONE ) { reads|= RA; writes= RA; }
+      else if ( (writes= op_writes ( inst->id.op1 )) == BAD ) return Z80_FALSE;
+      writes|= RF;
+      if ( inst->id.name == Z80_ADC || inst->id.name == Z80_SBC ) reads|= RF;
+      break;
+    case Z80_INC: case Z80_DEC:
+      if ( (writes= op_writes ( inst->id.op1 )) == BAD ) return Z80_FALSE;
+      if ( !is_pair ( inst->id.op1 ) ) writes|= RF;
+      break;
+    case Z80_CPL: reads|= RA; writes= RA|RF; break;
+    case Z80_RLCA: case Z80_RRCA: reads|= RA; writes= RA|RF; break;
+    case Z80_RLA: case Z80_RRA: reads|= RA|RF; writes= RA|RF; break;
+    case Z80_IN:
+      if ( inst->id.op1 != Z80_A || inst->id.op2 != Z80_pBYTE ||
+           !vdp_port ( inst->e2.byte ) )
+        return Z80_FALSE;
+      reads= 0; writes= RA;
+      _loop.vdp= Z80_TRUE;
+      break;
+    default: return Z80_FALSE;
+    }
+  _loop.inputs|= reads&~_loop.written;
+  if ( writes&_loop.inputs ) return Z80_FALSE;
+  _loop.written|= writes;
+  
+  return Z80_TRUE;
+  
+} /* end record */
+
+
+/* Descodifica el següent pas i torna la seua adreça. */
+static Z80u16
+decode (
+        Z80_Step *step
+        )
+{
+  
+  Z80u16 ret;
+  
+  
+  ret= Z80_decode_next_step ( step );
+  if ( step->type == Z80_STEP_INST ) ret-= step->val.inst.nbytes;
+  
+  return ret;
+  
+} /* end decode */
+
+
+/* Si INST és un salt cap arrere torna el destí, o -1 en cas
+   contrari. */
+static int
+backward_target (
+                 const Z80_Inst *inst,
+                 const Z80u16    pc
+                 )
+{
+  
+  int target;
+  
+  
+  if ( inst->id.name == Z80_JR )
+    target= inst->id.op1 == Z80_BRANCH ?
+      inst->e1.branch.addr : inst->e2.branch.addr;
+  else if ( inst->id.name == Z80_JP && inst->id.op1 == Z80_WORD )
+    target= inst->e1.addr_word;
+  else if ( inst->id.name == Z80_JP && inst->id.op2 == Z80_WORD )
+    target= inst->e2.addr_word;
+  else return -1;
+  if ( target > pc || pc-target >= MAX_LOOP ) return -1;
+  
+  return target;
+  
+} /* end backward_target */
+
+
+static void
+end_probe (
+           const Z80_Bool success
+           )
+{
+  
+  if ( success ) _period= MIN_PERIOD;
+  else if ( _period < MAX_PERIOD ) _period<<= 1;
+  _cc= success ? 0 : _period;
+  _state= WAIT;
+  
+} /* end end_probe */
+
+
+/* Salta les voltes que caben abans del següent event. Torna els
+   cicles botats. */
+static int
+skip (void)
+{
+  
+  int horizon, aux, n;
+  
+  
+  horizon= GG_vdp_cc_to_event ( _loop.vdp );
+  aux= GG_psg_cc_to_event ();
+  if ( aux < horizon ) horizon= aux;
+  n= horizon/_loop.cc;
+  if ( n == 0 ) return 0;
+  ++_stats.skips;
+  _stats.cycles+= (uint64_t) n*_loop.cc;
+  
+  return n*_loop.cc;
+  
+} /* end skip */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_idle_get_stats (
+        	   GG_IdleStats *stats
+        	   )
+{
+  *stats= _stats;
+} /* end GG_idle_get_stats */
+
+
+Z80_Bool
+GG_idle_is_enabled (void)
+{
+  return _enabled;
+} /* end GG_idle_is_enabled */
+
+
+int
+GG_idle_run (void)
+{
+  
+  Z80_Step step;
+  Z80u16 pc;
+  int cc, target;
+  
+  
+  if ( _state == WAIT )
+    {
+      cc= Z80_run ();
+      if ( (_cc-= cc) <= 0 ) { _state= SEARCH; _steps= 0; ++_stats.probes; }
+      return cc;
+    }
+  
+  /* Sondeig. */
+  pc= decode ( &step );
+  if ( step.type != Z80_STEP_INST || ++_steps > MAX_STEPS )
+    {
+      end_probe ( Z80_FALSE );
+      return Z80_run ();
+    }
+  target= backward_target ( &step.val.inst, pc );
+  if ( _state == SEARCH )
+    {
+      if ( target != -1 )
+        {
+          memset ( &_loop, 0, sizeof(_loop) );
+          _loop.begin= (Z80u16) target;
+          _loop.end= pc;
+          _state= RECORD;
+        }
+      return Z80_run ();
+    }
+  
+  /* Gravant una volta, que ha de començar en el destí del salt (s'ha
+     pres) i acabar en el salt. Dins no pot haver cap altre salt. */
+  if ( (_loop.cc == 0 && pc != _loop.begin) ||
+       pc < _loop.begin || pc > _loop.end ||
+       (pc == _loop.end && target != _loop.begin) ||
+       (pc != _loop.end && !record ( &step.val.inst )) )
+    {
+      end_probe ( Z80_FALSE );
+      return Z80_run ();
+    }
+  cc= Z80_run ();
+  _loop.cc+= cc;
+  if ( pc != _loop.end ) return cc;
+  
+  /* La volta és completa si s'ha tornat a prendre el salt. */
+  pc= decode ( &step );
+  if ( step.type != Z80_STEP_INST || pc != _loop.begin )
+    {
+      end_probe ( Z80_FALSE );
+      return cc;
+    }
+  ++_stats.loops;
+  end_probe ( Z80_TRUE );
+  
+  return cc + skip ();
+  
+} /* end GG_idle_run */
+
+
+void
+GG_idle_set_enabled (
+        	     const Z80_Bool enabled
+        	     )
+{
+  
+  _enabled= enabled;
+  _state= WAIT;
+  _period= MIN_PERIOD;
+  _cc= _period;
+  
+} /* end GG_idle_set_enabled */
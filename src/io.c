@@ -22,6 +22,11 @@
  *  NOTES: ELS 7 PRIMERS PORTS NO ELS VAIG A SIMULAR, SIMPLEMENT
  *  TORNARÉ EL VALOR PER DEFECTE DE CADA PORT.
  *
+ *  DESCODIFICACIÓ: Els ports es descodifiquen una única vegada en
+ *  GG_io_init, que omple una taula de 256 entrades per a cada
+ *  direcció amb la funció que atén el port i el seu context. Així
+ *  'IN' i 'OUT' (i 'OTIR' sobre el VDP) sols fan una indirecció.
+ *
  */
 
 
@@ -33,68 +38,389 @@
 
 
 
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* Avisos de 'memory_control' que es mostren com a màxim. */
+#define MAX_WARNINGS 8
+
+/* Valors dels ports 1-6 i dels ports no connectats. */
+static const Z80u8 PORT_VALUES[7]=
+  {
+    0x00, 0x7F, 0xFF, 0x00, 0xFF, 0x00, 0xFF
+  };
+static const Z80u8 UNUSED= 0xFF;
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+typedef Z80u8 (read_func_t) (
+        		     const void *ctx
+        		     );
+
+typedef void (write_func_t) (
+        		     void        *ctx,
+        		     const Z80u8  data
+        		     );
+
+typedef struct
+{
+  
+  read_func_t *func;
+  const void  *ctx;
+  
+} read_handler_t;
+
+typedef struct
+{
+  
+  write_func_t *func;
+  void         *ctx;
+  
+} write_handler_t;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static read_handler_t _read[256];
+static write_handler_t _write[256];
+
+/* Avisos. */
+static GG_Warning *_warning;
+static void *_udata;
+static Z80u8 _mem_control;
+static int _nwarnings;
+
+/* Comprova els 'watchpoints' d'E/S (veure GG_io_set_watch). */
+static Z80_Bool _watch;
+
+
+
+
 /*********************/
 /* FUNCIONS PRIVADES */
 /*********************/
-#include<stdio.h>
+
+/* Mostra com a màxim MAX_WARNINGS avisos per inicialització. */
+static void
+warning (
+         const char *msg
+         )
+{
+  
+  if ( _nwarnings >= MAX_WARNINGS ) return;
+  if ( ++_nwarnings == MAX_WARNINGS )
+    _warning ( _udata, "%s (no es mostraran més avisos de I/O)", msg );
+  else _warning ( _udata, "%s", msg );
+  
+} /* end warning */
+
+
+/* NOTA: En la GameGear sols tenen efecte els bits 4 i 3. Sols avisa
+   quan canvien, els jocs tornen a escriure el mateix valor. */
 static void
 memory_control (
-        	const Z80u8 data
+        	void        *ctx,
+        	const Z80u8  data
         	)
 {
   
-  /* NOTA: En la GameGear sols tenen efecte els bits 4 i 3. */
-  if ( !(data&0x10) )
-    printf ( "No s'ha implementat suport per a la 'Work RAM'\n" );
-  if ( !(data&0x08) )
-    printf ( "No s'ha implementat suport per a la BIOS\n" );
+  Z80u8 changed;
+  
+  
+  (void) ctx;
+  changed= (data^_mem_control)&0x18;
+  _mem_control= data;
+  if ( (changed&0x10) && !(data&0x10) )
+    warning ( "No s'ha implementat suport per a la 'Work RAM'" );
+  if ( (changed&0x08) && !(data&0x08) )
+    warning ( "No s'ha implementat suport per a la BIOS" );
   
 } /* end memory_control */
 
 
+static Z80u8
+read_const (
+            const void *ctx
+            )
+{
+  return *((const Z80u8 *) ctx);
+} /* end read_const */
 
 
-/**********************/
-/* FUNCIONS PÚBLIQUES */
-/**********************/
+/* Overseas i PAL. */
+static Z80u8
+read_start (
+            const void *ctx
+            )
+{
+  (void) ctx;
+  return GG_control_get_status_start ()|0x60;
+} /* end read_start */
 
-Z80u8
-Z80_io_read (
-             Z80u8 port
-             )
+
+static Z80u8
+read_V (
+        const void *ctx
+        )
+{
+  (void) ctx;
+  return GG_vdp_get_V ();
+} /* end read_V */
+
+
+static Z80u8
+read_H (
+        const void *ctx
+        )
+{
+  (void) ctx;
+  return GG_vdp_get_H ();
+} /* end read_H */
+
+
+static Z80u8
+read_vdp_data (
+               const void *ctx
+               )
+{
+  (void) ctx;
+  return GG_vdp_read_data ();
+} /* end read_vdp_data */
+
+
+static Z80u8
+read_vdp_status (
+        	 const void *ctx
+        	 )
+{
+  (void) ctx;
+  return GG_vdp_get_status ();
+} /* end read_vdp_status */
+
+
+static Z80u8
+read_control1 (
+               const void *ctx
+               )
+{
+  (void) ctx;
+  return GG_control_get_status1 ();
+} /* end read_control1 */
+
+
+static Z80u8
+read_control_ext (
+        	  const void *ctx
+        	  )
+{
+  (void) ctx;
+  return GG_control_get_status_ext ();
+} /* end read_control_ext */
+
+
+static void
+write_none (
+            void        *ctx,
+            const Z80u8  data
+            )
+{
+  (void) ctx;
+  (void) data;
+} /* end write_none */
+
+
+static void
+write_stereo (
+              void        *ctx,
+              const Z80u8  data
+              )
+{
+  (void) ctx;
+  GG_psg_stereo ( data );
+} /* end write_stereo */
+
+
+static void
+write_psg (
+           void        *ctx,
+           const Z80u8  data
+           )
+{
+  (void) ctx;
+  GG_psg_control ( data );
+} /* end write_psg */
+
+
+static void
+write_vdp_control (
+        	   void        *ctx,
+        	   const Z80u8  data
+        	   )
+{
+  (void) ctx;
+  GG_vdp_control ( data );
+} /* end write_vdp_control */
+
+
+static void
+write_vdp_data (
+        	void        *ctx,
+        	const Z80u8  data
+        	)
+{
+  (void) ctx;
+  GG_vdp_write_data ( data );
+} /* end write_vdp_data */
+
+
+static void
+set_read (
+          const int    port,
+          read_func_t *func,
+          const void  *ctx
+          )
 {
+  
+  _read[port].func= func;
+  _read[port].ctx= ctx;
+  
+} /* end set_read */
+
+
+static void
+set_write (
+           const int     port,
+           write_func_t *func,
+           void         *ctx
+           )
+{
+  
+  _write[port].func= func;
+  _write[port].ctx= ctx;
+  
+} /* end set_write */
 
-  if ( port < 0x07 )
+
+static void
+init_read_table (void)
+{
+  
+  int port;
+  
+  
+  for ( port= 0; port < 256; ++port )
     {
-      switch ( port )
+      if ( port < 0x07 )
         {
-        case 0: return GG_control_get_status_start()|0x60; /* Overseas i PAL. */
-        case 1: return 0x7F;
-        case 2: return 0xFF;
-        case 3: return 0x00;
-        case 4: return 0xFF;
-        case 5: return 0x00;
-        case 6: return 0xFF;
+          if ( port == 0 ) set_read ( port, read_start, NULL );
+          else             set_read ( port, read_const, &PORT_VALUES[port] );
         }
-      return 0x00; /* Per a què no es queixe. */
-    }
-  else if ( port < 0x40 ) return 0xFF;
-  else if ( port < 0x80 )
-    {
-      if ( port&0x1 ) return GG_vdp_get_H ();
-      else            return GG_vdp_get_V ();
-    }
-  else if ( port < 0xC0 )
-    {
-      if ( port&0x1 ) return GG_vdp_get_status ();
-      else            return GG_vdp_read_data ();
+      else if ( port < 0x40 ) set_read ( port, read_const, &UNUSED );
+      else if ( port < 0x80 )
+        {
+          if ( port&0x1 ) set_read ( port, read_H, NULL );
+          else            set_read ( port, read_V, NULL );
+        }
+      else if ( port < 0xC0 )
+        {
+          if ( port&0x1 ) set_read ( port, read_vdp_status, NULL );
+          else            set_read ( port, read_vdp_data, NULL );
+        }
+      else if ( (port&0xFE) == 0xC0 || (port&0xFE) == 0xDC )
+        {
+          if ( port&0x1 ) set_read ( port, read_control_ext, NULL );
+          else            set_read ( port, read_control1, NULL );
+        }
+      else set_read ( port, read_const, &UNUSED );
     }
-  else if ( (port&0xFE) == 0xC0 || (port&0xFE) == 0xDC )
+  
+} /* end init_read_table */
+
+
+static void
+init_write_table (void)
+{
+  
+  int port;
+  
+  
+  for ( port= 0; port < 256; ++port )
     {
-      if ( port&0x1 ) return GG_control_get_status_ext ();
-      else            return GG_control_get_status1 ();
+      if ( port < 0x06 ) set_write ( port, write_none, NULL );
+      else if ( port == 0x06 ) set_write ( port, write_stereo, NULL );
+      else if ( port < 0x40 )
+        {
+          /* No se molt bé que fa açò (I/O control register). */
+          if ( port&0x1 ) set_write ( port, write_none, NULL );
+          else            set_write ( port, memory_control, NULL );
+        }
+      else if ( port < 0x80 ) set_write ( port, write_psg, NULL );
+      else if ( port < 0xC0 )
+        {
+          if ( port&0x1 ) set_write ( port, write_vdp_control, NULL );
+          else            set_write ( port, write_vdp_data, NULL );
+        }
+      else set_write ( port, write_none, NULL );
     }
-  else return 0xFF;
+  
+} /* end init_write_table */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_io_init (
+            GG_Warning *warn,
+            void       *udata
+            )
+{
+  
+  _warning= warn;
+  _udata= udata;
+  _mem_control= 0x18;
+  _nwarnings= 0;
+  init_read_table ();
+  init_write_table ();
+  
+} /* end GG_io_init */
+
+
+void
+GG_io_set_watch (
+        	 const Z80_Bool val
+        	 )
+{
+  _watch= val;
+} /* end GG_io_set_watch */
+
+
+Z80u8
+Z80_io_read (
+             Z80u8 port
+             )
+{
+  
+  Z80u8 ret;
+  
+  
+  ret= _read[port].func ( _read[port].ctx );
+  if ( _watch ) GG_break_io ( GG_READ, port, ret );
+  
+  return ret;
   
 } /* end Z80_io_read */
 
@@ -106,19 +432,7 @@ Z80_io_write (
               )
 {
   
-  if ( port < 0x06 ) return;
-  else if ( port == 0x06 ) GG_psg_stereo ( data );
-  else if ( port < 0x40 )
-    {
-      /* No se molt bé que fa açò. */
-      if ( port&0x1 ) return;/*printf ( "I/O control register (W)\n" );*/
-      else            memory_control ( data );
-    }
-  else if ( port < 0x80 ) GG_psg_control ( data );
-  else if ( port < 0xC0 )
-    {
-      if ( port&0x1 ) GG_vdp_control ( data );
-      else            GG_vdp_write_data ( data );
-    }
+  if ( _watch ) GG_break_io ( GG_WRITE, port, data );
+  _write[port].func ( _write[port].ctx, data );
   
 } /* end Z80_io_write */
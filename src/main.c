@@ -22,7 +22,11 @@
  */
 
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -40,8 +44,23 @@
    segons. */
 static const int CCTOCHECK= 33000;
 
+/* En mode turbo es comprova cada 16 vegades més cicles. */
+static const int CCTOCHECK_TURBO= 16*33000;
+
 static const char GGSTATE[]= "GGSTATE\n";
 
+/* Format compacte. Després de la marca va la grandària (uint32_t) de
+   la resta de l'estat. */
+static const char GGSTATC[]= "GGSTATC\n";
+
+/* Trossos que ha de tindre un estat portable sencer. La SRAM sols si
+   està mapejada (ho comprova MEM). */
+static const uint32_t REQUIRED_CHUNKS[]=
+  {
+    GG_STATE_Z80, GG_STATE_MAPR, GG_STATE_RAM, GG_STATE_VDP,
+    GG_STATE_VRAM, GG_STATE_CRAM, GG_STATE_FB, GG_STATE_PSG
+  };
+
 
 
 
@@ -63,6 +82,391 @@ static void *_udata;
 static GG_CPUStep *_cpu_step;
 
 
+/* Final de 'frame'. El VDP avisa a meitat de GG_vdp_clock, per tant
+   les accions que necessiten l'estat complet es fan després. */
+static GG_UpdateScreen *_update_screen;
+static Z80_Bool _new_frame;
+static Z80_Bool _show_frame;
+
+
+/* Grandària de l'estat de la UCP. La UCP sols sap guardar l'estat en
+   un FILE, per tant es calcula una vegada en la inicialització. */
+static size_t _z80_state_size;
+
+/* Buffer per a resumir l'estat de la UCP (veure GG_get_state_hash). */
+static Z80u8 *_z80_buf;
+
+
+/* ROM i el seu CRC-32 (es calcula quan es demana). */
+static GG_Rom _rom;
+static Z80_Bool _rom_crc_ready;
+static uint32_t _rom_crc;
+
+/* Cert si s'està perfilant, hi ha punts de ruptura o es busquen
+   bucles d'espera. Dins de GG_loop sols es mira al final de cada
+   'frame'. */
+static Z80_Bool _prof;
+static Z80_Bool _break;
+static Z80_Bool _idle;
+static Z80_Bool _hooks;
+
+/* Cicles entre crides a CHECKSIGNALS. */
+static int _cctocheck;
+
+/* El primer pas de GG_loop no comprova els punts de ruptura
+   d'execució, per a poder continuar després de parar en un. */
+static Z80_Bool _resume;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static size_t
+get_z80_state_size (void)
+{
+  
+  FILE *f;
+  char *buf;
+  size_t size;
+  int ret;
+  
+  
+  buf= NULL;
+  size= 0;
+  f= open_memstream ( &buf, &size );
+  if ( f == NULL ) return 0;
+  ret= Z80_save_state ( f );
+  if ( fclose ( f ) != 0 ) ret= -1;
+  free ( buf );
+  
+  return ret==0 ? size : 0;
+  
+} /* end get_z80_state_size */
+
+
+static Z80u8 *
+save_z80_state_mem (
+        	    Z80u8 *buf
+        	    )
+{
+  
+  FILE *f;
+  int ret;
+  
+  
+  if ( _z80_state_size == 0 ) return NULL;
+  f= fmemopen ( buf, _z80_state_size, "wb" );
+  if ( f == NULL ) return NULL;
+  ret= Z80_save_state ( f );
+  if ( fclose ( f ) != 0 || ret != 0 ) return NULL;
+  
+  return buf + _z80_state_size;
+  
+} /* end save_z80_state_mem */
+
+
+static const Z80u8 *
+load_z80_state_mem (
+        	    const Z80u8 *buf,
+        	    const Z80u8 *end
+        	    )
+{
+  
+  FILE *f;
+  int ret;
+  
+  
+  if ( _z80_state_size == 0 ||
+       (size_t) (end-buf) < _z80_state_size ) return NULL;
+  f= fmemopen ( (void *) buf, _z80_state_size, "rb" );
+  if ( f == NULL ) return NULL;
+  ret= Z80_load_state ( f );
+  fclose ( f );
+  
+  return ret==0 ? buf + _z80_state_size : NULL;
+  
+} /* end load_z80_state_mem */
+
+
+/* Carrega l'estat compacte, sense capçalera. */
+static int
+load_state_compact (
+        	    const Z80u8 *buf,
+        	    const Z80u8 *end
+        	    )
+{
+  
+  if ( (buf= load_z80_state_mem ( buf, end )) == NULL ) return -1;
+  if ( (buf= GG_mem_load_state_mem ( buf, end )) == NULL ) return -1;
+  if ( (buf= GG_vdp_load_state_compact_mem ( buf, end )) == NULL )
+    return -1;
+  if ( (buf= GG_psg_load_state_compact_mem ( buf, end )) == NULL )
+    return -1;
+  
+  return 0;
+  
+} /* end load_state_compact */
+
+
+/* Carrega els trossos presents, sense avisar ni reiniciar. */
+static int
+load_state_chunks (
+        	   const GG_StateChunks *chunks
+        	   )
+{
+  
+  const Z80u8 *data;
+  size_t size;
+  
+  
+  if ( (data= GG_state_get_chunk ( chunks, GG_STATE_Z80, &size )) != NULL )
+    {
+      if ( size != _z80_state_size ) return -1;
+      if ( load_z80_state_mem ( data, data+size ) == NULL ) return -1;
+    }
+  if ( GG_mem_load_state_chunks ( chunks ) != 0 ) return -1;
+  if ( GG_vdp_load_state_chunks ( chunks ) != 0 ) return -1;
+  if ( GG_psg_load_state_chunks ( chunks ) != 0 ) return -1;
+  
+  return 0;
+  
+} /* end load_state_chunks */
+
+
+/* Carrega un estat portable sencer (amb capçalera). */
+static int
+load_state_portable (
+        	     const Z80u8  *buf,
+        	     const size_t  size
+        	     )
+{
+  
+  GG_StateChunks chunks;
+  size_t i;
+  
+  
+  if ( GG_state_index ( buf, size, &chunks ) != 0 ) return -1;
+  for ( i= 0; i < sizeof(REQUIRED_CHUNKS)/sizeof(REQUIRED_CHUNKS[0]); ++i )
+    if ( GG_state_get_chunk ( &chunks, REQUIRED_CHUNKS[i], NULL ) == NULL )
+      return -1;
+  
+  return load_state_chunks ( &chunks );
+  
+} /* end load_state_portable */
+
+
+/* Escriu un estat portable. Si MEMORIES és fals sense la RAM, la SRAM
+   ni la VRAM. */
+static size_t
+save_state_portable (
+        	     Z80u8          *buf,
+        	     const Z80_Bool  memories
+        	     )
+{
+  
+  Z80u8 *p, *data;
+  
+  
+  p= GG_state_begin ( buf );
+  data= p= GG_state_begin_chunk ( p, GG_STATE_Z80 );
+  if ( (p= save_z80_state_mem ( p )) == NULL ) return 0;
+  p= GG_state_end_chunk ( data, p );
+  p= GG_mem_save_state_chunks ( p, memories );
+  p= GG_vdp_save_state_chunks ( p, memories );
+  p= GG_psg_save_state_chunks ( p );
+  
+  return GG_state_end ( buf, p );
+  
+} /* end save_state_portable */
+
+
+static void
+update_screen (
+               const int  fb[23040],
+               void      *udata
+               )
+{
+  
+  _new_frame= Z80_TRUE;
+  if ( _show_frame )
+    {
+      GG_PERF_BEGIN ( GG_PERF_UPDATE_SCREEN );
+      _update_screen ( fb, udata );
+      GG_PERF_END ( GG_PERF_UPDATE_SCREEN );
+    }
+  
+} /* end update_screen */
+
+
+static void
+update_hooks (void)
+{
+  
+  _prof= GG_prof_get_mode () != GG_PROF_OFF;
+  _break= GG_break_is_enabled ();
+  _idle= GG_idle_is_enabled () && !_prof && !_break;
+  _hooks= _prof || _break || _idle;
+  _cctocheck= GG_turbo_is_enabled () ? CCTOCHECK_TURBO : CCTOCHECK;
+  
+} /* end update_hooks */
+
+
+/* Executa un pas de GG_loop amb el perfilador, els punts de ruptura
+   o la detecció de bucles d'espera. Si ha de parar abans d'executar-lo
+   torna 0. */
+static int
+hooked_step (void)
+{
+  
+  int cc;
+  
+  
+  if ( _idle ) return GG_idle_run ();
+  if ( _break )
+    {
+      if ( !_resume && GG_break_has_exec () && GG_break_check_exec () )
+        {
+          _stop= Z80_TRUE;
+          return 0;
+        }
+      _resume= Z80_FALSE;
+      /* Ignora els accessos fets fora de GG_loop, o per RUNAHEAD i
+         ROLLBACK al final del 'frame'. */
+      GG_break_clear_event ();
+    }
+  cc= _prof ? GG_prof_run () : Z80_run ();
+  if ( _break && GG_break_get_reason () != GG_BREAK_NONE )
+    _stop= Z80_TRUE;
+  
+  return cc;
+  
+} /* end hooked_step */
+
+
+/* Es crida entre dues instruccions després d'acabar un 'frame'. */
+static void
+end_frame (void)
+{
+  
+  _new_frame= Z80_FALSE;
+  update_hooks ();
+  GG_mem_frame ();
+  GG_movie_frame ();
+  GG_rewind_frame ();
+  if ( GG_turbo_is_enabled () ) GG_turbo_frame ();
+  else                          GG_runahead_frame ();
+  GG_PERF_FRAME ();
+  
+} /* end end_frame */
+
+
+/* Executa un pas en mode traça, gravant-lo si cal. */
+static int
+trace_step (void)
+{
+  
+  int cc;
+  Z80u16 addr;
+  Z80_Step step;
+  Z80_Bool rec;
+  
+  
+  rec= GG_tracer_is_open ();
+  if ( _cpu_step != NULL || rec )
+    {
+      addr= Z80_decode_next_step ( &step );
+      if ( _cpu_step != NULL ) _cpu_step ( &step, addr, _udata );
+      if ( rec ) GG_tracer_begin ( &step, addr );
+    }
+  GG_mem_set_mode_trace ( Z80_TRUE );
+  cc= Z80_run ();
+  GG_mem_set_mode_trace ( Z80_FALSE );
+  if ( rec ) GG_tracer_end ( cc );
+  GG_vdp_clock ( cc );
+  GG_psg_clock ( cc );
+  
+  return cc;
+  
+} /* end trace_step */
+
+
+static void
+reset_state (void)
+{
+  
+  Z80_init_state ();
+  GG_mem_init_state ();
+  GG_vdp_init_state ();
+  GG_psg_init_state ();
+  
+} /* end reset_state */
+
+
+/* Si TRUSTED és cert l'estat GGSTATE l'ha escrit GG_save_state_mem
+   en aquest procés i no es tornen a comprovar els buffers de vídeo i
+   so. */
+static int
+load_state_mem (
+        	const Z80u8    *buf,
+        	const size_t    size,
+        	const Z80_Bool  trusted
+        	)
+{
+  
+  const Z80u8 *p, *end;
+  uint32_t csize;
+  
+  
+  _stop= Z80_FALSE;
+  
+  /* Format compacte. */
+  end= buf + size;
+  if ( size >= (sizeof(GGSTATC)-1) + sizeof(csize) &&
+       !memcmp ( buf, GGSTATC, sizeof(GGSTATC)-1 ) )
+    {
+      p= buf + (sizeof(GGSTATC)-1);
+      memcpy ( &csize, p, sizeof(csize) );
+      p+= sizeof(csize);
+      if ( csize > (size_t) (end-p) ) goto error;
+      if ( load_state_compact ( p, p+csize ) != 0 ) goto error;
+      return 0;
+    }
+  
+  /* Format portable. */
+  if ( size >= GG_STATE_HEADER_SIZE &&
+       !memcmp ( buf, GG_STATE_MAGIC, 8 ) )
+    {
+      if ( load_state_portable ( buf, size ) != 0 ) goto error;
+      return 0;
+    }
+  
+  /* GGSTATE. */
+  if ( size < sizeof(GGSTATE)-1 ||
+       memcmp ( buf, GGSTATE, sizeof(GGSTATE)-1 ) )
+    goto error;
+  p= buf + (sizeof(GGSTATE)-1);
+  
+  /* Carrega. */
+  if ( (p= load_z80_state_mem ( p, end )) == NULL ) goto error;
+  if ( (p= GG_mem_load_state_mem ( p, end )) == NULL ) goto error;
+  if ( (p= GG_vdp_load_state_mem ( p, end, trusted )) == NULL ) goto error;
+  if ( (p= GG_psg_load_state_mem ( p, end, trusted )) == NULL ) goto error;
+  
+  return 0;
+  
+ error:
+  _warning ( _udata,
+             "error al carregar l'estat del simulador des de memòria" );
+  reset_state ();
+  return -1;
+  
+} /* end load_state_mem */
+
+
+
 
 
 /**********************/
@@ -82,6 +486,12 @@ GG_init (
   _udata= udata;
   _cpu_step= frontend->trace!=NULL ?
     frontend->trace->cpu_step:NULL;
+  _update_screen= frontend->update_screen;
+  _new_frame= Z80_FALSE;
+  _show_frame= Z80_TRUE;
+  _cctocheck= CCTOCHECK;
+  _rom= *rom;
+  _rom_crc_ready= Z80_FALSE;
   
   Z80_init ( frontend->warning, udata );
   GG_mem_init ( rom,
@@ -90,10 +500,23 @@ GG_init (
         	frontend->trace->mem_access:NULL,
         	frontend->trace!=NULL ?
         	frontend->trace->mapper_changed:NULL,
+        	frontend->sram_changed,
         	udata );
-  GG_vdp_init ( frontend->update_screen, udata );
+  GG_vdp_init ( update_screen, udata );
   GG_control_init ( frontend->check_buttons, udata );
+  GG_io_init ( frontend->warning, udata );
   GG_psg_init ( frontend->play_sound, udata );
+  _z80_state_size= get_z80_state_size ();
+  free ( _z80_buf );
+  _z80_buf= (Z80u8 *) malloc ( _z80_state_size );
+  GG_rewind_clear ();
+  GG_turbo_disable ();
+  GG_runahead_close ();
+  GG_rollback_close ();
+  GG_movie_close ();
+  GG_prof_close ();
+  GG_break_clear ();
+  GG_perf_reset ();
   
 } /* end GG_init */
 
@@ -103,19 +526,23 @@ GG_iter (
          Z80_Bool *stop
          )
 {
-
+  
   static int CC= 0;
   int cc;
   
   
-  cc= Z80_run ();
+  cc= GG_prof_get_mode () != GG_PROF_OFF ? GG_prof_run () : Z80_run ();
+  GG_PERF_COUNT ( GG_PERF_CPU );
   GG_vdp_clock ( cc );
   GG_psg_clock ( cc );
+  if ( _new_frame ) end_frame ();
   CC+= cc;
-  if ( CC >= CCTOCHECK && _check != NULL )
+  if ( CC >= _cctocheck && _check != NULL )
     {
-      CC-= CCTOCHECK;
+      CC-= _cctocheck;
+      GG_PERF_BEGIN ( GG_PERF_CHECK );
       _check ( stop, _udata );
+      GG_PERF_END ( GG_PERF_CHECK );
     }
   
   return cc;
@@ -123,7 +550,7 @@ GG_iter (
 } /* end GG_iter */
 
 
-void
+GG_BreakReason
 GG_loop (void)
 {
   
@@ -131,37 +558,83 @@ GG_loop (void)
   
   
   _stop= Z80_FALSE;
+  _resume= Z80_TRUE;
+  GG_break_clear_event ();
+  update_hooks ();
   if ( _check == NULL )
     {
       while ( !_stop )
         {
-          cc= Z80_run ();
+          cc= _hooks ? hooked_step () : Z80_run ();
+          GG_PERF_COUNT ( GG_PERF_CPU );
           GG_vdp_clock ( cc );
           GG_psg_clock ( cc );
+          if ( _new_frame ) end_frame ();
         }
     }
   else
     {
       CC= 0;
-      for (;;)
+      while ( !_stop )
         {
-          cc= Z80_run ();
+          cc= _hooks ? hooked_step () : Z80_run ();
+          GG_PERF_COUNT ( GG_PERF_CPU );
           GG_vdp_clock ( cc );
           GG_psg_clock ( cc );
+          if ( _new_frame ) end_frame ();
           CC+= cc;
-          if ( CC >= CCTOCHECK )
+          if ( CC >= _cctocheck )
             {
-              CC-= CCTOCHECK;
+              CC-= _cctocheck;
+              GG_PERF_BEGIN ( GG_PERF_CHECK );
               _check ( &_stop, _udata );
-              if ( _stop ) break;
+              GG_PERF_END ( GG_PERF_CHECK );
             }
         }
     }
   _stop= Z80_FALSE;
   
+  return GG_break_get_reason ();
+  
 } /* end GG_loop */
 
 
+void
+GG_run_frame (void)
+{
+  
+  int cc;
+  
+  
+  do {
+    cc= Z80_run ();
+    GG_vdp_clock ( cc );
+    GG_psg_clock ( cc );
+  } while ( !_new_frame );
+  _new_frame= Z80_FALSE;
+  
+} /* end GG_run_frame */
+
+
+void
+GG_set_show_frame (
+        	   const Z80_Bool show
+        	   )
+{
+  
+  _show_frame= show;
+  GG_vdp_set_frame_skip ( !show );
+  
+} /* end GG_set_show_frame */
+
+
+Z80_Bool
+GG_get_show_frame (void)
+{
+  return _show_frame;
+} /* end GG_get_show_frame */
+
+
 void
 GG_stop (void)
 {
@@ -174,40 +647,86 @@ GG_trace (void)
 {
   
   int cc;
-  Z80u16 addr;
-  Z80_Step step;
   
   
-  if ( _cpu_step != NULL )
-    {
-      addr= Z80_decode_next_step ( &step );
-      _cpu_step ( &step, addr, _udata );
-    }
-  GG_mem_set_mode_trace ( Z80_TRUE );
-  cc= Z80_run ();
-  GG_vdp_clock ( cc );
-  GG_psg_clock ( cc );
-  GG_mem_set_mode_trace ( Z80_FALSE );
+  cc= trace_step ();
+  if ( _new_frame ) end_frame ();
   
   return cc;
   
 } /* end GG_trace */
 
 
+long
+GG_trace_run (
+              const long nsteps
+              )
+{
+  
+  long n, ret;
+  
+  
+  _stop= Z80_FALSE;
+  ret= 0;
+  for ( n= 0; n < nsteps && !_stop; ++n )
+    {
+      ret+= trace_step ();
+      if ( _new_frame ) end_frame ();
+    }
+  _stop= Z80_FALSE;
+  
+  return ret;
+  
+} /* end GG_trace_run */
+
+
 int
 GG_load_state (
                FILE *f
                )
 {
-
+  
   static char buf[sizeof(GGSTATE)];
   
+  uint32_t size;
+  Z80u8 *mem, header[GG_STATE_HEADER_SIZE];
+  int ret;
+  
   
   _stop= Z80_FALSE;
   
   /* GGSTATE. */
   if ( fread ( buf, sizeof(GGSTATE)-1, 1, f ) != 1 ) goto error;
   buf[sizeof(GGSTATE)-1]= '\0';
+  if ( !strcmp ( buf, GG_STATE_MAGIC ) )
+    {
+      memcpy ( header, buf, 8 );
+      if ( fread ( header+8, GG_STATE_HEADER_SIZE-8, 1, f ) != 1 )
+        goto error;
+      GG_state_get_u32 ( header+12, header+GG_STATE_HEADER_SIZE, &size );
+      if ( size > GG_state_size () ) goto error;
+      mem= (Z80u8 *) malloc ( GG_STATE_HEADER_SIZE + size );
+      if ( mem == NULL ) goto error;
+      memcpy ( mem, header, GG_STATE_HEADER_SIZE );
+      ret= (size == 0 ||
+            fread ( mem+GG_STATE_HEADER_SIZE, size, 1, f ) == 1) ?
+        load_state_portable ( mem, GG_STATE_HEADER_SIZE + size ) : -1;
+      free ( mem );
+      if ( ret != 0 ) goto error;
+      return 0;
+    }
+  if ( !strcmp ( buf, GGSTATC ) )
+    {
+      if ( fread ( &size, sizeof(size), 1, f ) != 1 ) goto error;
+      if ( size > GG_state_size () ) goto error;
+      mem= (Z80u8 *) malloc ( size );
+      if ( mem == NULL ) goto error;
+      ret= fread ( mem, size, 1, f )==1 ?
+        load_state_compact ( mem, mem+size ) : -1;
+      free ( mem );
+      if ( ret != 0 ) goto error;
+      return 0;
+    }
   if ( strcmp ( buf, GGSTATE ) ) goto error;
   
   /* Carrega. */
@@ -221,10 +740,7 @@ GG_load_state (
  error:
   _warning ( _udata,
              "error al carregar l'estat del simulador des d'un fitxer" );
-  Z80_init_state ();
-  GG_mem_init_state ();
-  GG_vdp_init_state ();
-  GG_psg_init_state ();
+  reset_state ();
   return -1;
   
 } /* end GG_load_state */
@@ -236,12 +752,186 @@ GG_save_state (
                )
 {
   
-  if ( fwrite ( GGSTATE, sizeof(GGSTATE)-1, 1, f ) != 1 ) return -1;
-  if ( Z80_save_state ( f ) != 0 ) return -1;
-  if ( GG_mem_save_state ( f ) != 0 ) return -1;
-  if ( GG_vdp_save_state ( f ) != 0 ) return -1;
-  if ( GG_psg_save_state ( f ) != 0 ) return -1;
+  Z80u8 *buf;
+  size_t size;
+  int ret;
   
-  return 0;
+  
+  buf= (Z80u8 *) malloc ( GG_state_size () );
+  if ( buf == NULL ) return -1;
+  size= GG_save_state_portable_mem ( buf );
+  ret= (size != 0 && fwrite ( buf, size, 1, f ) == 1) ? 0 : -1;
+  free ( buf );
+  
+  return ret;
   
 } /* end GG_save_state */
+
+
+size_t
+GG_save_state_portable_mem (
+        		    Z80u8 *buf
+        		    )
+{
+  return save_state_portable ( buf, Z80_TRUE );
+} /* end GG_save_state_portable_mem */
+
+
+size_t
+GG_save_state_branch_mem (
+        		  Z80u8 *buf
+        		  )
+{
+  return save_state_portable ( buf, Z80_FALSE );
+} /* end GG_save_state_branch_mem */
+
+
+int
+GG_load_state_chunks (
+        	      const GG_StateChunks *chunks
+        	      )
+{
+  
+  _stop= Z80_FALSE;
+  if ( load_state_chunks ( chunks ) != 0 )
+    {
+      _warning ( _udata,
+        	 "error al carregar els trossos de l'estat del simulador" );
+      reset_state ();
+      return -1;
+    }
+  
+  return 0;
+  
+} /* end GG_load_state_chunks */
+
+
+uint32_t
+GG_get_rom_crc32 (void)
+{
+  
+  if ( !_rom_crc_ready )
+    {
+      _rom_crc= GG_rom_crc32 ( &_rom );
+      _rom_crc_ready= Z80_TRUE;
+    }
+  
+  return _rom_crc;
+  
+} /* end GG_get_rom_crc32 */
+
+
+GG_Hash
+GG_get_state_hash (void)
+{
+  
+  GG_Hash hash;
+  
+  
+  /* Els registres de la UCP sols es poden obtindre guardant
+     l'estat. */
+  hash= 0;
+  if ( _z80_buf != NULL && save_z80_state_mem ( _z80_buf ) != NULL )
+    hash= GG_hash_bytes ( hash, _z80_buf, _z80_state_size );
+  hash= GG_hash_mix ( hash ^ GG_mem_get_hash () );
+  hash= GG_hash_mix ( hash ^ GG_vdp_get_hash () );
+  hash= GG_hash_mix ( hash ^ GG_psg_get_hash () );
+  
+  return hash;
+  
+} /* end GG_get_state_hash */
+
+
+size_t
+GG_state_size (void)
+{
+  return (sizeof(GGSTATE)-1) + _z80_state_size + GG_mem_state_size () +
+    GG_vdp_state_size () + GG_psg_state_size ();
+} /* end GG_state_size */
+
+
+size_t
+GG_save_state_mem (
+        	   Z80u8 *buf
+        	   )
+{
+  
+  Z80u8 *p;
+  
+  
+  memcpy ( buf, GGSTATE, sizeof(GGSTATE)-1 );
+  p= buf + (sizeof(GGSTATE)-1);
+  if ( (p= save_z80_state_mem ( p )) == NULL ) return 0;
+  p= GG_mem_save_state_mem ( p );
+  p= GG_vdp_save_state_mem ( p );
+  p= GG_psg_save_state_mem ( p );
+  
+  return (size_t) (p-buf);
+  
+} /* end GG_save_state_mem */
+
+
+int
+GG_load_state_mem (
+        	   const Z80u8  *buf,
+        	   const size_t  size
+        	   )
+{
+  return load_state_mem ( buf, size, Z80_FALSE );
+} /* end GG_load_state_mem */
+
+
+int
+GG_load_state_trusted_mem (
+        		   const Z80u8  *buf,
+        		   const size_t  size
+        		   )
+{
+  return load_state_mem ( buf, size, Z80_TRUE );
+} /* end GG_load_state_trusted_mem */
+
+
+size_t
+GG_save_state_compact_mem (
+        		   Z80u8 *buf
+        		   )
+{
+  
+  Z80u8 *p, *begin;
+  uint32_t csize;
+  
+  
+  memcpy ( buf, GGSTATC, sizeof(GGSTATC)-1 );
+  begin= buf + (sizeof(GGSTATC)-1) + sizeof(csize);
+  if ( (p= save_z80_state_mem ( begin )) == NULL ) return 0;
+  p= GG_mem_save_state_mem ( p );
+  p= GG_vdp_save_state_compact_mem ( p );
+  p= GG_psg_save_state_compact_mem ( p );
+  csize= (uint32_t) (p-begin);
+  memcpy ( buf + (sizeof(GGSTATC)-1), &csize, sizeof(csize) );
+  
+  return (size_t) (p-buf);
+  
+} /* end GG_save_state_compact_mem */
+
+
+int
+GG_save_state_compact (
+        	       FILE *f
+        	       )
+{
+  
+  Z80u8 *buf;
+  size_t size;
+  int ret;
+  
+  
+  buf= (Z80u8 *) malloc ( GG_state_size () );
+  if ( buf == NULL ) return -1;
+  size= GG_save_state_compact_mem ( buf );
+  ret= (size != 0 && fwrite ( buf, size, 1, f ) == 1) ? 0 : -1;
+  free ( buf );
+  
+  return ret;
+  
+} /* end GG_save_state_compact */
@@ -22,10 +22,15 @@
  */
 
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
+#include <errno.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "GG.h"
 
@@ -45,6 +50,31 @@
 #define CHECK(COND)                             \
   if ( !(COND) ) return -1;
 
+/* Bit de la pàgina I de la SRAM en _sram_dirty. */
+#define SRAM_BIT(I) (((uint32_t) 1)<<(I))
+
+/* Marca la pàgina de l'adreça ADDR de la SRAM si el byte canvia. */
+#define SRAM_DIRTY(ADDR,OLD,NEW)        				\
+  if ( (OLD) != (NEW) )        						\
+    {        								\
+      _sram_dirty|= SRAM_BIT ( (ADDR)/GG_PAGE_SIZE );        		\
+      _sram_written= Z80_TRUE;        					\
+    }
+
+/* Format portable (veure STATE). */
+#define PUT_U8(VAL) *(buf++)= (Z80u8) (VAL)
+
+#define PUT_I32(VAL) buf= GG_state_put_u32 ( buf, (uint32_t) (VAL) )
+
+#define PUT_BYTES(PTR,SIZE)        					\
+  memcpy ( buf, (PTR), (SIZE) ); buf+= (SIZE)
+
+#define GET_U8(VAR)        						\
+  p= GG_state_get_u8 ( p, end, &u8 ); (VAR)= u8
+
+#define GET_I32(VAR)        						\
+  p= GG_state_get_u32 ( p, end, &u32 ); (VAR)= (int32_t) u32
+
 
 
 
@@ -56,6 +86,12 @@
 static Z80u8 (*_read) ( Z80u16 addr );
 static void (*_write) ( Z80u16 addr, Z80u8 data );
 
+/* Mode traça, comprovació de 'watchpoints' (veure BREAK) i registre
+   d'accessos (veure ACCLOG). */
+static Z80_Bool _trace;
+static Z80_Bool _watch;
+static Z80_Bool _log;
+
 /* Memòria. */
 static Z80u8 _ram[8192 /*8K*/];
 
@@ -94,6 +130,35 @@ static void *_udata;
 static GG_MemAccess *_mem_access;
 static GG_MapperChanged *_mapper_changed;
 
+/* Resum incremental de la RAM i la SRAM. */
+static GG_Hash _ram_hash;
+static GG_Hash _sram_hash;
+
+/* Després de carregar l'estat el resum es torna a calcular quan es
+   demana, per a no alentir les càrregues. */
+static Z80_Bool _hash_dirty;
+
+/* Pàgines compartides amb les bifurcacions (veure BRANCH). */
+static GG_Page *_ram_pages[GG_RAM_PAGES];
+static GG_Page *_sram_pages[GG_SRAM_PAGES];
+
+/* Pàgines de la SRAM modificades i si s'ha escrit en el 'frame'
+   actual. */
+static uint32_t _sram_dirty;
+static Z80_Bool _sram_written;
+static GG_SRAMChanged *_sram_changed;
+
+/* Execució especulativa (veure GG_mem_begin_speculative). */
+static struct
+{
+  
+  int      depth;
+  Z80_Bool active;       /* Hi havia SRAM al principi. */
+  uint32_t dirty;
+  Z80_Bool written;
+  Z80u8    mem[32*1024]; /* Contingut de la SRAM al principi. */
+  
+} _spec;
 
 
 
@@ -101,6 +166,56 @@ static GG_MapperChanged *_mapper_changed;
 /* FUNCIONS PRIVADES */
 /*********************/
 
+/* Torna a calcular els resums sencers. */
+static void
+rehash (void)
+{
+  
+  _ram_hash= GG_hash_area ( _ram, sizeof(_ram), GG_HASH_RAM );
+  _sram_hash= _sram.mem!=NULL ?
+    GG_hash_area ( _sram.mem, 32*1024, GG_HASH_SRAM ) : 0;
+  _hash_dirty= Z80_FALSE;
+  
+} /* end rehash */
+
+
+static void
+map_sram (void)
+{
+  
+  if ( _sram.mem != NULL ) return;
+  _sram.mem= _get_external_ram ( _udata );
+  GG_page_release ( _sram_pages, GG_SRAM_PAGES );
+  _hash_dirty= Z80_TRUE;
+  
+} /* end map_sram */
+
+
+/* Copia en la SRAM les pàgines de SRC que són distintes. */
+static void
+load_sram (
+           const Z80u8 *src
+           )
+{
+  
+  int i;
+  size_t off;
+  
+  
+  for ( i= 0; i < GG_SRAM_PAGES; ++i )
+    {
+      off= (size_t) i*GG_PAGE_SIZE;
+      if ( memcmp ( _sram.mem+off, src+off, GG_PAGE_SIZE ) )
+        {
+          memcpy ( _sram.mem+off, src+off, GG_PAGE_SIZE );
+          _sram_dirty|= SRAM_BIT ( i );
+          _sram_written= Z80_TRUE;
+        }
+    }
+  
+} /* end load_sram */
+
+
 static Z80u8
 read_notrace (
               Z80u16 addr
@@ -132,15 +247,40 @@ read_notrace (
 } /* end read_notrace */
 
 
+static Z80u8
+read_check (
+            Z80u16 addr
+            )
+{
+  
+  Z80u8 ret;
+  
+  
+  ret= read_notrace ( addr );
+  if ( _watch && addr >= 0xC000 && !_sram.onboard )
+    GG_break_ram ( GG_READ, addr&0x1FFF, ret );
+  if ( _log ) GG_acclog_access ( GG_READ, addr, ret );
+  
+  return ret;
+  
+} /* end read_check */
+
+
 static Z80u8
 read_trace (
             Z80u16 addr
             )
 {
   
+  Z80u8 ret;
+  
+  
   if ( _mem_access != NULL && addr >= 0xC000 && !_sram.onboard )
     _mem_access ( GG_READ, addr&0x1FFF, _ram[addr&0x1FFF], _udata );
-  return read_notrace ( addr );
+  ret= (_watch || _log) ? read_check ( addr ) : read_notrace ( addr );
+  if ( addr >= 0xC000 ) GG_tracer_access ( GG_READ, addr, ret );
+  
+  return ret;
   
 } /* end read_trace */
 
@@ -152,27 +292,50 @@ write_notrace (
                )
 {
   
+  Z80u16 aux;
+  
+  
   if ( addr < 0xC000 )
     {
       if ( /*_rom_write_enabled &&*/ _sram.onslot2 && addr >= 0x8000 )
-        _sram.slot2[addr&0x3FFF]= data;
+        {
+          aux= (Z80u16) ((_sram.slot2-_sram.mem) | (addr&0x3FFF));
+          GG_HASH_UPDATE ( _sram_hash, GG_HASH_SRAM, aux,
+        		_sram.slot2[addr&0x3FFF], data );
+          GG_PAGE_UNSHARE ( _sram_pages, aux );
+          SRAM_DIRTY ( aux, _sram.slot2[addr&0x3FFF], data );
+          _sram.slot2[addr&0x3FFF]= data;
+        }
       return;
     }
-  if ( _sram.onboard ) _sram.mem[addr&0x3FFF]= data;
-  else                 _ram[addr&0x1FFF]= data;
+  if ( _sram.onboard )
+    {
+      GG_HASH_UPDATE ( _sram_hash, GG_HASH_SRAM, addr&0x3FFF,
+        	    _sram.mem[addr&0x3FFF], data );
+      GG_PAGE_UNSHARE ( _sram_pages, addr&0x3FFF );
+      SRAM_DIRTY ( addr&0x3FFF, _sram.mem[addr&0x3FFF], data );
+      _sram.mem[addr&0x3FFF]= data;
+    }
+  else
+    {
+      GG_HASH_UPDATE ( _ram_hash, GG_HASH_RAM, addr&0x1FFF,
+        	    _ram[addr&0x1FFF], data );
+      GG_PAGE_UNSHARE ( _ram_pages, addr&0x1FFF );
+      _ram[addr&0x1FFF]= data;
+    }
   if ( addr < 0xFFFC ) return;
   if ( addr == 0xFFFC )
     {
       /*_rom_write_enabled= ((data&0x80)!=0);*/
       if ( data&0x10 )
         {
-          if ( _sram.mem == NULL ) _sram.mem= _get_external_ram ( _udata );
+          map_sram ();
           _sram.onboard= Z80_TRUE;
         }
       else _sram.onboard= Z80_FALSE;
       if ( data&0x08 )
         {
-          if ( _sram.mem == NULL ) _sram.mem= _get_external_ram ( _udata );
+          map_sram ();
           _sram.slot2= _sram.mem+((data&0x04)?0x4000:0);
           _sram.onslot2= Z80_TRUE;
         }
@@ -192,6 +355,21 @@ write_notrace (
 } /* end _write */
 
 
+static void
+write_check (
+             Z80u16 addr,
+             Z80u8  data
+             )
+{
+  
+  if ( _watch && addr >= 0xC000 && !_sram.onboard )
+    GG_break_ram ( GG_WRITE, addr&0x1FFF, data );
+  if ( _log ) GG_acclog_access ( GG_WRITE, addr, data );
+  write_notrace ( addr, data );
+  
+} /* end write_check */
+
+
 static void
 write_trace (
              Z80u16 addr,
@@ -199,6 +377,7 @@ write_trace (
              )
 {
   
+  GG_tracer_access ( GG_WRITE, addr, data );
   if ( addr >= 0xC000 )
     {
       if ( _mem_access != NULL && !_sram.onboard )
@@ -206,17 +385,258 @@ write_trace (
       if ( _mapper_changed && addr >= 0xFFFC )
         _mapper_changed ( _udata );
     }
-  write_notrace ( addr, data );
+  if ( _watch || _log ) write_check ( addr, data );
+  else                  write_notrace ( addr, data );
   
 } /* end write_trace */
 
 
+static void
+update_mode (void)
+{
+  
+  if ( _trace )
+    {
+      _read= read_trace;
+      _write= write_trace;
+    }
+  else if ( _watch || _log )
+    {
+      _read= read_check;
+      _write= write_check;
+    }
+  else
+    {
+      _read= read_notrace;
+      _write= write_notrace;
+    }
+  
+} /* end update_mode */
+
+
 
 
 /**********************/
 /* FUNCIONS PÚBLIQUES */
 /**********************/
 
+void
+GG_mem_branch_load (
+        	    GG_Page *const ram[GG_RAM_PAGES],
+        	    GG_Page *const sram[GG_SRAM_PAGES]
+        	    )
+{
+  
+  int i;
+  
+  
+  GG_page_restore ( _ram_pages, _ram, GG_RAM_PAGES, ram );
+  if ( sram[0] != NULL )
+    {
+      map_sram ();
+      for ( i= 0; i < GG_SRAM_PAGES; ++i )
+        if ( sram[i] != _sram_pages[i] &&
+             memcmp ( _sram.mem + i*GG_PAGE_SIZE, sram[i]->data,
+        	      GG_PAGE_SIZE ) )
+          {
+            _sram_dirty|= SRAM_BIT ( i );
+            _sram_written= Z80_TRUE;
+          }
+      GG_page_restore ( _sram_pages, _sram.mem, GG_SRAM_PAGES, sram );
+    }
+  else GG_page_release ( _sram_pages, GG_SRAM_PAGES );
+  _hash_dirty= Z80_TRUE;
+  
+} /* end GG_mem_branch_load */
+
+
+int
+GG_mem_branch_save (
+        	    GG_Page *ram[GG_RAM_PAGES],
+        	    GG_Page *sram[GG_SRAM_PAGES]
+        	    )
+{
+  
+  if ( GG_page_share ( _ram_pages, _ram, GG_RAM_PAGES, ram ) != 0 )
+    return -1;
+  if ( _sram.mem != NULL &&
+       GG_page_share ( _sram_pages, _sram.mem, GG_SRAM_PAGES, sram ) != 0 )
+    return -1;
+  
+  return 0;
+  
+} /* end GG_mem_branch_save */
+
+
+int
+GG_mem_flush_sram (
+        	   const int     fd,
+        	   const int64_t offset
+        	   )
+{
+  
+  int i, j, k, npages;
+  size_t off, n;
+  ssize_t ret;
+  
+  
+  if ( _sram.mem == NULL ) return 0;
+  npages= 0;
+  for ( i= 0; i < GG_SRAM_PAGES; i= j+1 )
+    {
+      
+      /* Pàgines modificades seguides [I,J[. */
+      for ( ; i < GG_SRAM_PAGES && !(_sram_dirty&SRAM_BIT ( i )); ++i );
+      for ( j= i; j < GG_SRAM_PAGES && (_sram_dirty&SRAM_BIT ( j )); ++j );
+      if ( i == j ) break;
+      
+      /* Escriu. */
+      off= (size_t) i*GG_PAGE_SIZE;
+      n= (size_t) (j-i)*GG_PAGE_SIZE;
+      while ( n > 0 )
+        {
+          ret= pwrite ( fd, _sram.mem + off, n, (off_t) (offset + off) );
+          if ( ret < 0 )
+            {
+              if ( errno == EINTR ) continue;
+              return -1;
+            }
+          off+= (size_t) ret;
+          n-= (size_t) ret;
+        }
+      for ( k= i; k < j; ++k )
+        _sram_dirty&= ~SRAM_BIT ( k );
+      npages+= j-i;
+      
+    }
+  
+  return npages;
+  
+} /* end GG_mem_flush_sram */
+
+
+void
+GG_mem_frame (void)
+{
+  
+  if ( !_sram_written ) return;
+  _sram_written= Z80_FALSE;
+  if ( _sram_changed != NULL ) _sram_changed ( _udata );
+  
+} /* end GG_mem_frame */
+
+
+GG_Hash
+GG_mem_get_hash (void)
+{
+  
+  int regs[7];
+  
+  
+  regs[0]= _p0;
+  regs[1]= _p1;
+  regs[2]= _p2;
+  regs[3]= _shift;
+  regs[4]= (int) _sram.onboard;
+  regs[5]= (int) _sram.onslot2;
+  regs[6]= _sram.slot2!=NULL ? (int) (_sram.slot2-_sram.mem) : -1;
+  
+  if ( _hash_dirty ) rehash ();
+  
+  return GG_hash_bytes ( _ram_hash^_sram_hash, regs, sizeof(regs) );
+  
+} /* end GG_mem_get_hash */
+
+
+int
+GG_mem_get_bank (
+        	 const Z80u16 addr
+        	 )
+{
+  
+  switch ( (addr&0xC000)>>14 )
+    {
+    case 0: return (addr&0x3FFF) < 0x400 ? 0 : _p0;
+    case 1: return _p1;
+    case 2: return _sram.onslot2 ? -1 : _p2;
+    default: return -1;
+    }
+  
+} /* end GG_mem_get_bank */
+
+
+Z80_Bool
+GG_mem_is_sram (
+        	const Z80u16 addr
+        	)
+{
+  
+  switch ( (addr&0xC000)>>14 )
+    {
+    case 2: return _sram.onslot2;
+    case 3: return _sram.onboard;
+    default: return Z80_FALSE;
+    }
+  
+} /* end GG_mem_is_sram */
+
+
+void
+GG_mem_begin_speculative (void)
+{
+  
+  if ( _spec.depth++ > 0 ) return;
+  _spec.active= (_sram.mem != NULL);
+  if ( !_spec.active ) return;
+  _spec.dirty= _sram_dirty;
+  _spec.written= _sram_written;
+  memcpy ( _spec.mem, _sram.mem, sizeof(_spec.mem) );
+  
+} /* end GG_mem_begin_speculative */
+
+
+void
+GG_mem_end_speculative (void)
+{
+  
+  int i;
+  size_t off;
+  
+  
+  if ( _spec.depth == 0 || --_spec.depth > 0 ) return;
+  if ( !_spec.active || _sram.mem == NULL ) return;
+  _sram_dirty= _spec.dirty;
+  _sram_written= _spec.written;
+  for ( i= 0; i < GG_SRAM_PAGES; ++i )
+    {
+      off= (size_t) i*GG_PAGE_SIZE;
+      if ( memcmp ( _sram.mem+off, _spec.mem+off, GG_PAGE_SIZE ) )
+        {
+          _sram_dirty|= SRAM_BIT ( i );
+          _sram_written= Z80_TRUE;
+        }
+    }
+  
+} /* end GG_mem_end_speculative */
+
+
+uint32_t
+GG_mem_get_sram_dirty (
+        	       const Z80_Bool clear
+        	       )
+{
+  
+  uint32_t ret;
+  
+  
+  ret= _sram_dirty;
+  if ( clear ) _sram_dirty= 0;
+  
+  return ret;
+  
+} /* end GG_mem_get_sram_dirty */
+
+
 void
 GG_mem_get_mapper_state (
         		 GG_MapperState *state
@@ -237,6 +657,7 @@ GG_mem_init (
              GG_GetExternalRAM *get_external_ram,
              GG_MemAccess      *mem_acces,
              GG_MapperChanged  *mapper_changed,
+             GG_SRAMChanged    *sram_changed,
              void              *udata
              )
 {
@@ -249,6 +670,7 @@ GG_mem_init (
   _udata= udata;
   _mem_access= mem_acces;
   _mapper_changed= mapper_changed;
+  _sram_changed= sram_changed;
   GG_mem_set_mode_trace ( Z80_FALSE );
   
 } /* end GG_mem_init */
@@ -259,6 +681,8 @@ GG_mem_init_state (void)
 {
   
   memset ( _ram, 0, 8192 );
+  GG_page_release ( _ram_pages, GG_RAM_PAGES );
+  GG_page_release ( _sram_pages, GG_SRAM_PAGES );
   if ( _rom.nbanks == 1 )
     _p0= _p1= _p2= 0;
   else if ( _rom.nbanks == 2 )
@@ -276,7 +700,10 @@ GG_mem_init_state (void)
   _sram.mem= NULL;
   _sram.slot2= NULL;
   _sram.onboard= _sram.onslot2= Z80_FALSE;
+  _sram_dirty= 0;
+  _sram_written= Z80_FALSE;
   /*_rom_write_enabled= Z80_TRUE;*/
+  _hash_dirty= Z80_TRUE;
   
 } /* end GG_mem_init_state */
 
@@ -287,20 +714,36 @@ GG_mem_set_mode_trace (
         	       )
 {
   
-  if ( val )
-    {
-      _read= read_trace;
-      _write= write_trace;
-    }
-  else
-    {
-      _read= read_notrace;
-      _write= write_notrace;
-    }
+  _trace= val;
+  update_mode ();
   
 } /* end GG_mem_set_mode_trace */
 
 
+void
+GG_mem_set_log (
+        	const Z80_Bool val
+        	)
+{
+  
+  _log= val;
+  update_mode ();
+  
+} /* end GG_mem_set_log */
+
+
+void
+GG_mem_set_watch (
+        	  const Z80_Bool val
+        	  )
+{
+  
+  _watch= val;
+  update_mode ();
+  
+} /* end GG_mem_set_watch */
+
+
 Z80u8
 Z80_read (
           Z80u16 addr
@@ -325,7 +768,7 @@ GG_mem_save_state (
         	   FILE *f
         	   )
 {
-
+  
   SAVE ( _ram );
   SAVE ( _sram );
   if ( _sram.mem != NULL )
@@ -349,11 +792,13 @@ GG_mem_load_state (
         	   FILE *f
         	   )
 {
-
+  
   Z80u8 *tmp;
   GG_Rom rom_fk;
   
   
+  GG_page_release ( _ram_pages, GG_RAM_PAGES );
+  GG_page_release ( _sram_pages, GG_SRAM_PAGES );
   LOAD ( _ram );
   LOAD ( _sram );
   CHECK ( !_sram.onboard || _sram.mem!=NULL );
@@ -368,6 +813,8 @@ GG_mem_load_state (
           _sram.slot2= _sram.mem + (_sram.slot2-tmp);
           CHECK ( _sram.slot2==_sram.mem || _sram.slot2==(_sram.mem+0x4000) );
         }
+      _sram_dirty= ~((uint32_t) 0);
+      _sram_written= Z80_TRUE;
       if ( fread ( _sram.mem, 32*1024, 1, f ) != 1 )
         return -1;
     }
@@ -381,7 +828,195 @@ GG_mem_load_state (
   CHECK ( _p2 >= 0 && _p2 < _rom.nbanks );
   LOAD ( _shift );
   CHECK ( _shift==0x00 || _shift==0x18 || _shift==0x10 || _shift==0x08 );
+  _hash_dirty= Z80_TRUE;
   
   return 0;
   
 } /* end GG_mem_load_state */
+
+
+size_t
+GG_mem_state_size (void)
+{
+  return sizeof(_ram) + sizeof(_sram) + 32*1024 + sizeof(_rom.nbanks) +
+    sizeof(_p0) + sizeof(_p1) + sizeof(_p2) + sizeof(_shift);
+} /* end GG_mem_state_size */
+
+
+Z80u8 *
+GG_mem_save_state_mem (
+        	       Z80u8 *buf
+        	       )
+{
+  
+  GG_SAVE_MEM ( _ram );
+  GG_SAVE_MEM ( _sram );
+  if ( _sram.mem != NULL )
+    {
+      memcpy ( buf, _sram.mem, 32*1024 );
+      buf+= 32*1024;
+    }
+  GG_SAVE_MEM ( _rom.nbanks );
+  GG_SAVE_MEM ( _p0 );
+  GG_SAVE_MEM ( _p1 );
+  GG_SAVE_MEM ( _p2 );
+  GG_SAVE_MEM ( _shift );
+  
+  return buf;
+  
+} /* end GG_mem_save_state_mem */
+
+
+const Z80u8 *
+GG_mem_load_state_mem (
+        	       const Z80u8 *buf,
+        	       const Z80u8 *end
+        	       )
+{
+  
+  Z80u8 *tmp;
+  GG_Rom rom_fk;
+  
+  
+  GG_page_release ( _ram_pages, GG_RAM_PAGES );
+  GG_page_release ( _sram_pages, GG_SRAM_PAGES );
+  GG_LOAD_MEM ( _ram );
+  GG_LOAD_MEM ( _sram );
+  GG_CHECK_MEM ( !_sram.onboard || _sram.mem!=NULL );
+  GG_CHECK_MEM ( !_sram.onslot2 || _sram.slot2!=NULL );
+  GG_CHECK_MEM ( _sram.slot2==NULL || _sram.mem!=NULL );
+  if ( _sram.mem != NULL )
+    {
+      tmp= _sram.mem;
+      _sram.mem= _get_external_ram ( _udata );
+      if ( _sram.slot2 != NULL )
+        {
+          _sram.slot2= _sram.mem + (_sram.slot2-tmp);
+          GG_CHECK_MEM ( _sram.slot2==_sram.mem ||
+        	         _sram.slot2==(_sram.mem+0x4000) );
+        }
+      GG_CHECK_MEM ( (size_t) (end-buf) >= 32*1024 );
+      load_sram ( buf );
+      buf+= 32*1024;
+    }
+  GG_LOAD_MEM ( rom_fk.nbanks );
+  GG_CHECK_MEM ( rom_fk.nbanks == _rom.nbanks );
+  GG_LOAD_MEM ( _p0 );
+  GG_CHECK_MEM ( _p0 >= 0 && _p0 < _rom.nbanks );
+  GG_LOAD_MEM ( _p1 );
+  GG_CHECK_MEM ( _p1 >= 0 && _p1 < _rom.nbanks );
+  GG_LOAD_MEM ( _p2 );
+  GG_CHECK_MEM ( _p2 >= 0 && _p2 < _rom.nbanks );
+  GG_LOAD_MEM ( _shift );
+  GG_CHECK_MEM ( _shift==0x00 || _shift==0x18 || _shift==0x10 ||
+                 _shift==0x08 );
+  _hash_dirty= Z80_TRUE;
+  
+  return buf;
+  
+} /* end GG_mem_load_state_mem */
+
+
+Z80u8 *
+GG_mem_save_state_chunks (
+        		  Z80u8          *buf,
+        		  const Z80_Bool  memories
+        		  )
+{
+  
+  Z80u8 *data;
+  
+  
+  /* Mapejador. La SRAM es guarda com la meitat on està 'slot2'. */
+  data= buf= GG_state_begin_chunk ( buf, GG_STATE_MAPR );
+  PUT_I32 ( _rom.nbanks );
+  PUT_I32 ( _p0 );
+  PUT_I32 ( _p1 );
+  PUT_I32 ( _p2 );
+  PUT_U8 ( _shift );
+  PUT_U8 ( _sram.mem != NULL );
+  PUT_U8 ( _sram.onboard );
+  PUT_U8 ( _sram.onslot2 );
+  PUT_U8 ( _sram.slot2==NULL ? 0 : (_sram.slot2==_sram.mem ? 1 : 2) );
+  buf= GG_state_end_chunk ( data, buf );
+  
+  /* Memòries. */
+  if ( !memories ) return buf;
+  data= buf= GG_state_begin_chunk ( buf, GG_STATE_RAM );
+  PUT_BYTES ( _ram, sizeof(_ram) );
+  buf= GG_state_end_chunk ( data, buf );
+  if ( _sram.mem != NULL )
+    {
+      data= buf= GG_state_begin_chunk ( buf, GG_STATE_SRAM );
+      PUT_BYTES ( _sram.mem, 32*1024 );
+      buf= GG_state_end_chunk ( data, buf );
+    }
+  
+  return buf;
+  
+} /* end GG_mem_save_state_chunks */
+
+
+int
+GG_mem_load_state_chunks (
+        		  const GG_StateChunks *chunks
+        		  )
+{
+  
+  const Z80u8 *p, *end;
+  size_t size;
+  Z80u8 u8, mapped, slot2;
+  uint32_t u32;
+  int nbanks;
+  
+  
+  u8= 0; u32= 0;
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_MAPR, &size )) != NULL )
+    {
+      end= p + size;
+      GET_I32 ( nbanks );
+      GET_I32 ( _p0 );
+      GET_I32 ( _p1 );
+      GET_I32 ( _p2 );
+      GET_U8 ( _shift );
+      GET_U8 ( mapped );
+      GET_U8 ( _sram.onboard );
+      GET_U8 ( _sram.onslot2 );
+      GET_U8 ( slot2 );
+      CHECK ( p != NULL );
+      CHECK ( nbanks == _rom.nbanks );
+      CHECK ( _p0 >= 0 && _p0 < _rom.nbanks );
+      CHECK ( _p1 >= 0 && _p1 < _rom.nbanks );
+      CHECK ( _p2 >= 0 && _p2 < _rom.nbanks );
+      CHECK ( _shift==0x00 || _shift==0x18 || _shift==0x10 || _shift==0x08 );
+      CHECK ( _sram.onboard <= 1 && _sram.onslot2 <= 1 && slot2 <= 2 );
+      CHECK ( !_sram.onslot2 || slot2 != 0 );
+      CHECK ( (!_sram.onboard && slot2 == 0) || mapped );
+      CHECK ( !mapped || _sram.mem != NULL ||
+              GG_state_get_chunk ( chunks, GG_STATE_SRAM, NULL ) != NULL );
+      if ( mapped ) map_sram ();
+      else
+        {
+          _sram.mem= NULL;
+          GG_page_release ( _sram_pages, GG_SRAM_PAGES );
+        }
+      _sram.slot2= slot2==0 ? NULL : _sram.mem + (slot2==2 ? 0x4000 : 0);
+    }
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_RAM, &size )) != NULL )
+    {
+      CHECK ( size == sizeof(_ram) );
+      GG_page_release ( _ram_pages, GG_RAM_PAGES );
+      memcpy ( _ram, p, sizeof(_ram) );
+    }
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_SRAM, &size )) != NULL )
+    {
+      CHECK ( size == 32*1024 );
+      map_sram ();
+      GG_page_release ( _sram_pages, GG_SRAM_PAGES );
+      load_sram ( p );
+    }
+  _hash_dirty= Z80_TRUE;
+  
+  return 0;
+  
+} /* end GG_mem_load_state_chunks */
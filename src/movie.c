@@ -0,0 +1,525 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  movie.c - Implementació del mòdul MOVIE.
+ *
+ *  NOTES: El 'frame' 0 comença quan es crida a GG_movie_record (pot
+ *  ser a meitat d'un 'frame' real) i cada 'frame' següent comença en
+ *  GG_movie_frame. El fotograma clau K és l'estat al principi del
+ *  'frame' (K+1)*INTERVAL.
+ *
+ *  El format del fitxer està descrit en GG.h (veure MOVIE).
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+/* Botons que es guarden. */
+#define BUTTONS_MASK (GG_UP|GG_DOWN|GG_LEFT|GG_RIGHT|GG_TL|GG_TR|GG_START)
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+typedef struct
+{
+  
+  Z80u8  *data;
+  size_t  size;
+  
+} state_t;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static GG_MovieMode _mode= GG_MOVIE_NONE;
+static int _frame;
+
+/* Pel·lícula. */
+static uint32_t _rom_crc;
+static int _interval;
+static state_t _start;
+static struct
+{
+  
+  Z80u16 *v;
+  int     N;
+  int     size;
+  
+} _input;
+static struct
+{
+  
+  state_t *v;
+  int      N;
+  int      size;
+  
+} _keys;
+static size_t _bytes;
+
+/* Buffer per a guardar l'estat abans de saber la grandària. */
+static Z80u8 *_buf= NULL;
+static size_t _buf_size= 0;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static int
+save_state (
+            state_t *state
+            )
+{
+  
+  Z80u8 *aux;
+  size_t size;
+  
+  
+  size= GG_state_size ();
+  if ( size > _buf_size )
+    {
+      aux= (Z80u8 *) realloc ( _buf, size );
+      if ( aux == NULL ) return -1;
+      _buf= aux;
+      _buf_size= size;
+    }
+  size= GG_save_state_portable_mem ( _buf );
+  if ( size == 0 ) return -1;
+  state->data= (Z80u8 *) malloc ( size );
+  if ( state->data == NULL ) return -1;
+  memcpy ( state->data, _buf, size );
+  state->size= size;
+  _bytes+= size;
+  
+  return 0;
+  
+} /* end save_state */
+
+
+static int
+push_keyframe (void)
+{
+  
+  state_t *aux;
+  int size;
+  
+  
+  if ( _keys.N == _keys.size )
+    {
+      size= _keys.size==0 ? 64 : 2*_keys.size;
+      aux= (state_t *) realloc ( _keys.v, size*sizeof(state_t) );
+      if ( aux == NULL ) return -1;
+      _keys.v= aux;
+      _keys.size= size;
+    }
+  if ( save_state ( &(_keys.v[_keys.N]) ) != 0 ) return -1;
+  ++_keys.N;
+  
+  return 0;
+  
+} /* end push_keyframe */
+
+
+/* Llig els botons, els fixa per al 'frame' actual i els guarda. */
+static int
+record_input (void)
+{
+  
+  Z80u16 *aux;
+  int size, buttons;
+  
+  
+  if ( _input.N == _input.size )
+    {
+      size= _input.size==0 ? 4096 : 2*_input.size;
+      aux= (Z80u16 *) realloc ( _input.v, size*sizeof(Z80u16) );
+      if ( aux == NULL ) return -1;
+      _input.v= aux;
+      _input.size= size;
+    }
+  buttons= GG_control_read_buttons ()&BUTTONS_MASK;
+  GG_control_set_input ( buttons, 0 );
+  _input.v[_input.N++]= (Z80u16) buttons;
+  _bytes+= sizeof(Z80u16);
+  
+  return 0;
+  
+} /* end record_input */
+
+
+static int
+write_u32 (
+           FILE           *f,
+           const uint32_t  val
+           )
+{
+  
+  Z80u8 buf[4];
+  
+  
+  GG_state_put_u32 ( buf, val );
+  
+  return fwrite ( buf, sizeof(buf), 1, f )==1 ? 0 : -1;
+  
+} /* end write_u32 */
+
+
+static int
+read_u32 (
+          FILE     *f,
+          uint32_t *val
+          )
+{
+  
+  Z80u8 buf[4];
+  
+  
+  if ( fread ( buf, sizeof(buf), 1, f ) != 1 ) return -1;
+  GG_state_get_u32 ( buf, buf+sizeof(buf), val );
+  
+  return 0;
+  
+} /* end read_u32 */
+
+
+static int
+read_state (
+            FILE    *f,
+            state_t *state
+            )
+{
+  
+  state->data= (Z80u8 *) malloc ( state->size );
+  if ( state->data == NULL ) return -1;
+  _bytes+= state->size;
+  if ( fread ( state->data, state->size, 1, f ) != 1 ) return -1;
+  
+  return 0;
+  
+} /* end read_state */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_movie_close (void)
+{
+  
+  int i;
+  
+  
+  if ( _mode == GG_MOVIE_NONE ) return;
+  GG_movie_stop ();
+  free ( _start.data );
+  free ( _input.v );
+  for ( i= 0; i < _keys.N; ++i )
+    free ( _keys.v[i].data );
+  free ( _keys.v );
+  _mode= GG_MOVIE_NONE;
+  
+} /* end GG_movie_close */
+
+
+void
+GG_movie_frame (void)
+{
+  
+  if ( _mode == GG_MOVIE_RECORDING )
+    {
+      ++_frame;
+      if ( (_frame%_interval == 0 && push_keyframe () != 0) ||
+           record_input () != 0 )
+        GG_movie_stop ();
+    }
+  else if ( _mode == GG_MOVIE_PLAYING )
+    {
+      if ( ++_frame == _input.N ) GG_movie_stop ();
+      else GG_control_set_input ( _input.v[_frame], 0 );
+    }
+  
+} /* end GG_movie_frame */
+
+
+void
+GG_movie_get_info (
+        	   GG_MovieInfo *info
+        	   )
+{
+  
+  info->mode= _mode;
+  if ( _mode == GG_MOVIE_NONE )
+    {
+      info->frame= info->nframes= info->nkeyframes= info->interval= 0;
+      info->rom_crc= 0;
+      info->size= 0;
+      return;
+    }
+  info->frame= _frame;
+  info->nframes= _input.N;
+  info->nkeyframes= _keys.N;
+  info->interval= _interval;
+  info->rom_crc= _rom_crc;
+  info->size= _bytes;
+  
+} /* end GG_movie_get_info */
+
+
+int
+GG_movie_load (
+               FILE *f
+               )
+{
+  
+  char magic[8];
+  uint32_t version, crc, interval, nframes, nkeys, size;
+  Z80u8 buf[2];
+  size_t max;
+  int i;
+  
+  
+  GG_movie_close ();
+  
+  /* Capçalera. */
+  if ( fread ( magic, sizeof(magic), 1, f ) != 1 ||
+       memcmp ( magic, GG_MOVIE_MAGIC, sizeof(magic) ) ) return -1;
+  if ( read_u32 ( f, &version ) != 0 || version == 0 ||
+       version > GG_MOVIE_VERSION ) return -1;
+  if ( read_u32 ( f, &crc ) != 0 || crc != GG_get_rom_crc32 () ) return -1;
+  if ( read_u32 ( f, &interval ) != 0 || interval == 0 ||
+       interval > INT32_MAX ) return -1;
+  if ( read_u32 ( f, &nframes ) != 0 || nframes == 0 ||
+       nframes > INT32_MAX ) return -1;
+  if ( read_u32 ( f, &nkeys ) != 0 || nkeys > nframes/interval ) return -1;
+  max= GG_state_size ();
+  if ( read_u32 ( f, &size ) != 0 || size == 0 || size > max ) return -1;
+  
+  /* Reserva. */
+  _mode= GG_MOVIE_STOPPED;
+  _frame= 0;
+  _rom_crc= crc;
+  _interval= (int) interval;
+  _bytes= 0;
+  _start.data= NULL;
+  _start.size= size;
+  _input.v= (Z80u16 *) malloc ( nframes*sizeof(Z80u16) );
+  _input.N= _input.size= 0;
+  _keys.v= (state_t *) calloc ( nkeys>0 ? nkeys : 1, sizeof(state_t) );
+  _keys.N= _keys.size= 0;
+  if ( _input.v == NULL || _keys.v == NULL ) goto error;
+  _input.size= (int) nframes;
+  _keys.size= (int) nkeys;
+  
+  /* Dades. */
+  for ( i= 0; i < (int) nkeys; ++i )
+    {
+      if ( read_u32 ( f, &size ) != 0 || size == 0 || size > max )
+        goto error;
+      _keys.v[i].size= size;
+    }
+  for ( i= 0; i < (int) nframes; ++i )
+    {
+      if ( fread ( buf, sizeof(buf), 1, f ) != 1 ) goto error;
+      _input.v[i]= (Z80u16) ((buf[0] | (buf[1]<<8))&BUTTONS_MASK);
+    }
+  _input.N= (int) nframes;
+  _bytes+= nframes*sizeof(Z80u16);
+  if ( read_state ( f, &_start ) != 0 ) goto error;
+  for ( ; _keys.N < (int) nkeys; ++_keys.N )
+    if ( read_state ( f, &(_keys.v[_keys.N]) ) != 0 )
+      {
+        ++_keys.N;
+        goto error;
+      }
+  
+  return 0;
+  
+ error:
+  GG_movie_close ();
+  return -1;
+  
+} /* end GG_movie_load */
+
+
+int
+GG_movie_play (void)
+{
+  
+  if ( _mode == GG_MOVIE_NONE ) return -1;
+  
+  return GG_movie_seek ( 0 );
+  
+} /* end GG_movie_play */
+
+
+int
+GG_movie_record (
+        	 const int interval
+        	 )
+{
+  
+  GG_movie_close ();
+  if ( interval <= 0 ) return -1;
+  _mode= GG_MOVIE_STOPPED;
+  _frame= 0;
+  _rom_crc= GG_get_rom_crc32 ();
+  _interval= interval;
+  _bytes= 0;
+  _start.data= NULL;
+  _input.v= NULL;
+  _input.N= _input.size= 0;
+  _keys.v= NULL;
+  _keys.N= _keys.size= 0;
+  if ( save_state ( &_start ) != 0 || record_input () != 0 )
+    {
+      GG_movie_close ();
+      return -1;
+    }
+  _mode= GG_MOVIE_RECORDING;
+  
+  return 0;
+  
+} /* end GG_movie_record */
+
+
+int
+GG_movie_save (
+               FILE *f
+               )
+{
+  
+  Z80u8 buf[2];
+  int i;
+  
+  
+  if ( _mode == GG_MOVIE_NONE ) return -1;
+  if ( fwrite ( GG_MOVIE_MAGIC, 8, 1, f ) != 1 ) return -1;
+  if ( write_u32 ( f, GG_MOVIE_VERSION ) != 0 ||
+       write_u32 ( f, _rom_crc ) != 0 ||
+       write_u32 ( f, (uint32_t) _interval ) != 0 ||
+       write_u32 ( f, (uint32_t) _input.N ) != 0 ||
+       write_u32 ( f, (uint32_t) _keys.N ) != 0 ||
+       write_u32 ( f, (uint32_t) _start.size ) != 0 )
+    return -1;
+  for ( i= 0; i < _keys.N; ++i )
+    if ( write_u32 ( f, (uint32_t) _keys.v[i].size ) != 0 ) return -1;
+  for ( i= 0; i < _input.N; ++i )
+    {
+      GG_state_put_u16 ( buf, _input.v[i] );
+      if ( fwrite ( buf, sizeof(buf), 1, f ) != 1 ) return -1;
+    }
+  if ( fwrite ( _start.data, _start.size, 1, f ) != 1 ) return -1;
+  for ( i= 0; i < _keys.N; ++i )
+    if ( fwrite ( _keys.v[i].data, _keys.v[i].size, 1, f ) != 1 )
+      return -1;
+  
+  return 0;
+  
+} /* end GG_movie_save */
+
+
+int
+GG_movie_seek (
+               const int frame
+               )
+{
+  
+  const state_t *state;
+  int k;
+  Z80_Bool show, mute;
+  
+  
+  if ( _mode == GG_MOVIE_NONE || frame < 0 || frame >= _input.N )
+    return -1;
+  GG_movie_stop ();
+  
+  /* Fotograma clau anterior. */
+  k= frame/_interval;
+  if ( k > _keys.N ) k= _keys.N;
+  state= k>0 ? &(_keys.v[k-1]) : &_start;
+  GG_mem_begin_speculative ();
+  if ( GG_load_state_mem ( state->data, state->size ) != 0 )
+    {
+      GG_mem_end_speculative ();
+      return -1;
+    }
+  _frame= k*_interval;
+  _mode= GG_MOVIE_PLAYING;
+  GG_control_set_input ( _input.v[_frame], 0 );
+  
+  /* Avança. */
+  if ( _frame < frame )
+    {
+      show= GG_get_show_frame ();
+      mute= GG_psg_get_mute ();
+      GG_set_show_frame ( Z80_FALSE );
+      GG_psg_set_mute ( Z80_TRUE );
+      while ( _frame < frame )
+        {
+          GG_run_frame ();
+          GG_control_set_input ( _input.v[++_frame], 0 );
+        }
+      GG_psg_set_mute ( mute );
+      GG_set_show_frame ( show );
+    }
+  GG_mem_end_speculative ();
+  
+  return 0;
+  
+} /* end GG_movie_seek */
+
+
+void
+GG_movie_stop (void)
+{
+  
+  if ( _mode == GG_MOVIE_RECORDING || _mode == GG_MOVIE_PLAYING )
+    {
+      GG_control_release_input ();
+      _mode= GG_MOVIE_STOPPED;
+    }
+  
+} /* end GG_movie_stop */
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  pacing.c - Implementació del mòdul PACING.
+ *
+ *  NOTES: El vídeo marca el ritme (un 'frame' cada
+ *  GG_CICLES_PER_FRAME/GG_CICLES_PER_SEC segons de rellotge real) i
+ *  l'àudio s'adapta. Com el rellotge de la targeta de so mai coincideix
+ *  exactament amb el del sistema, la relació de remostreig es corregeix
+ *  contínuament (com a molt MAX_DELTA) en funció de com de ple està el
+ *  buffer circular respecte a l'objectiu.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* Màxima correcció de la relació de remostreig (0.5%). */
+static const double MAX_DELTA= 0.005;
+
+/* Pes de les noves mesures en les mitjanes exponencials. */
+static const double ALPHA= 0.05;
+
+/* Si es va més endarrere que açò (en segons) es torna a sincronitzar
+   en compte d'intentar recuperar. */
+static const double MAX_LAG= 0.1;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Buffer on s'escriu. */
+static GG_AudioRing *_ring;
+
+/* Remostreig. */
+static struct
+{
+
+  double base;        /* Mostres del PSG per 'frame' del 'host'. */
+  double ratio;       /* Relació actual. */
+  double pos;         /* Posició fraccionària dins del buffer del PSG. */
+  double target;      /* Ompliment objectiu en 'frames'. */
+  double fill;        /* Ompliment mitjà en 'frames'. */
+  int    freq;        /* Freqüència del 'host'. */
+  double chunk[2*GG_PSG_BUFFER_SIZE];
+
+} _resampler;
+
+/* Temporització del vídeo. */
+static struct
+{
+
+  double   period;      /* Segons per 'frame'. */
+  double   deadline;    /* Instant en què acaba l'actual 'frame'. */
+  double   last;        /* Instant en què va començar l'últim 'frame'. */
+  double   jitter;      /* Desviació mitjana del període. */
+  Z80_Bool started;
+
+} _video;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+update_ratio (void)
+{
+
+  double delta;
+
+
+  _resampler.fill+=
+    ALPHA*(GG_audio_ring_get_fill ( _ring ) - _resampler.fill);
+  delta= MAX_DELTA*(_resampler.fill-_resampler.target)/_resampler.target;
+  if ( delta > MAX_DELTA ) delta= MAX_DELTA;
+  else if ( delta < -MAX_DELTA ) delta= -MAX_DELTA;
+  _resampler.ratio= _resampler.base*(1.0+delta);
+
+} /* end update_ratio */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_pacing_frame (void)
+{
+
+  double now, period;
+
+
+  now= GG_clock_get ();
+  if ( !_video.started )
+    {
+      _video.started= Z80_TRUE;
+      _video.deadline= now + _video.period;
+      _video.last= now;
+      return;
+    }
+  if ( now < _video.deadline )
+    {
+      GG_clock_sleep_until ( _video.deadline );
+      _video.deadline+= _video.period;
+      now= GG_clock_get ();
+    }
+  else if ( now - _video.deadline > MAX_LAG )
+    _video.deadline= now + _video.period;
+  else _video.deadline+= _video.period;
+  
+  /* Període real entre dos 'frames' consecutius. */
+  period= now - _video.last;
+  _video.last= now;
+  _video.jitter+= ALPHA*((period>_video.period ?
+        		  period-_video.period :
+        		  _video.period-period) - _video.jitter);
+
+} /* end GG_pacing_frame */
+
+
+double
+GG_pacing_get_ratio (void)
+{
+  return _resampler.ratio;
+} /* end GG_pacing_get_ratio */
+
+
+void
+GG_pacing_get_stats (
+        	     GG_PacingStats *stats
+        	     )
+{
+
+  stats->target_latency= _resampler.target / _resampler.freq;
+  stats->latency= _resampler.fill / _resampler.freq;
+  stats->jitter= _video.jitter;
+  stats->ratio= _resampler.ratio / _resampler.base;
+
+} /* end GG_pacing_get_stats */
+
+
+void
+GG_pacing_init (
+        	GG_AudioRing *ring,
+        	const int     freq,
+        	const double  target_latency
+        	)
+{
+
+  _ring= ring;
+  _resampler.freq= freq;
+  _resampler.base= GG_PSG_SAMPLES_PER_SEC / (double) freq;
+  _resampler.ratio= _resampler.base;
+  _resampler.pos= 0.0;
+  _resampler.target= target_latency*freq;
+  if ( _resampler.target < 1.0 ) _resampler.target= 1.0;
+  _resampler.fill= _resampler.target;
+  _video.period= GG_CICLES_PER_FRAME / (double) GG_CICLES_PER_SEC;
+  _video.jitter= 0.0;
+  _video.started= Z80_FALSE;
+
+} /* end GG_pacing_init */
+
+
+void
+GG_pacing_play_sound (
+        	      const double left[GG_PSG_BUFFER_SIZE],
+        	      const double right[GG_PSG_BUFFER_SIZE]
+        	      )
+{
+
+  int n, j;
+
+
+  update_ratio ();
+  n= 0;
+  j= (int) (_resampler.pos + 0.5);
+  while ( j < GG_PSG_BUFFER_SIZE )
+    {
+      if ( n == 2*GG_PSG_BUFFER_SIZE )
+        {
+          GG_audio_ring_write ( _ring, _resampler.chunk, n/2 );
+          n= 0;
+        }
+      _resampler.chunk[n++]= left[j];
+      _resampler.chunk[n++]= right[j];
+      _resampler.pos+= _resampler.ratio;
+      j= (int) (_resampler.pos + 0.5);
+    }
+  _resampler.pos-= GG_PSG_BUFFER_SIZE;
+  GG_audio_ring_write ( _ring, _resampler.chunk, n/2 );
+
+} /* end GG_pacing_play_sound */
+
+
+void
+GG_pacing_reset (void)
+{
+
+  _video.started= Z80_FALSE;
+  _resampler.fill= _resampler.target;
+
+} /* end GG_pacing_reset */
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  perf.c - Implementació del mòdul PERF.
+ *
+ *  NOTES: Cada part acumula en _frame i al final del 'frame' es
+ *  calcula el temps de la UCP com el que falta i s'afig a _stats.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Instant en què va començar cada part. */
+static uint64_t _begin[GG_PERF_NCOUNTERS];
+
+/* 'Frame' actual. */
+static GG_PerfValue _frame[GG_PERF_NCOUNTERS];
+static uint64_t _frame_begin= 0;
+
+static GG_PerfStats _stats;
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_perf_begin (
+               const GG_PerfCounter counter
+               )
+{
+  _begin[counter]= GG_clock_get_ns ();
+} /* end GG_perf_begin */
+
+
+void
+GG_perf_count (
+               const GG_PerfCounter counter
+               )
+{
+  ++_frame[counter].calls;
+} /* end GG_perf_count */
+
+
+void
+GG_perf_end (
+             const GG_PerfCounter counter
+             )
+{
+  
+  ++_frame[counter].calls;
+  _frame[counter].ns+= GG_clock_get_ns () - _begin[counter];
+  
+} /* end GG_perf_end */
+
+
+void
+GG_perf_frame (void)
+{
+  
+  uint64_t now, ns, others;
+  int i;
+  
+  
+  now= GG_clock_get_ns ();
+  if ( _frame_begin != 0 )
+    {
+      ns= now - _frame_begin;
+      for ( others= 0, i= 0; i < GG_PERF_NCOUNTERS; ++i )
+        if ( i != GG_PERF_CPU ) others+= _frame[i].ns;
+      _frame[GG_PERF_CPU].ns= ns > others ? ns-others : 0;
+      for ( i= 0; i < GG_PERF_NCOUNTERS; ++i )
+        {
+          _stats.total[i].calls+= _frame[i].calls;
+          _stats.total[i].ns+= _frame[i].ns;
+          _stats.last[i]= _frame[i];
+        }
+      ++_stats.frames;
+      _stats.frame_ns+= ns;
+      _stats.last_frame_ns= ns;
+    }
+  memset ( _frame, 0, sizeof(_frame) );
+  _frame_begin= now;
+  
+} /* end GG_perf_frame */
+
+
+void
+GG_perf_get_stats (
+        	   GG_PerfStats *stats
+        	   )
+{
+  *stats= _stats;
+} /* end GG_perf_get_stats */
+
+
+Z80_Bool
+GG_perf_is_available (void)
+{
+#ifdef GG_PERF
+  return Z80_TRUE;
+#else
+  return Z80_FALSE;
+#endif
+} /* end GG_perf_is_available */
+
+
+void
+GG_perf_reset (void)
+{
+  
+  memset ( &_stats, 0, sizeof(_stats) );
+  memset ( _frame, 0, sizeof(_frame) );
+  _frame_begin= 0;
+  
+} /* end GG_perf_reset */
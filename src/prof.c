@@ -0,0 +1,314 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  prof.c - Implementació del mòdul PROF.
+ *
+ *  NOTES: Els comptadors de cada banc de ROM es reserven la primera
+ *  vegada que s'executa codi del banc. El codi que no està en ROM
+ *  (RAM o SRAM, que sols poden estar en les àrees 2 i 3) es compta
+ *  per adreça del processador.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+#define BANK_SIZE 0x4000
+
+/* Adreces de l'àrea 2 i 3. */
+#define OTHER_SIZE 0x8000
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static GG_ProfMode _mode= GG_PROF_OFF;
+static int _period;
+
+/* Cicles des de l'última mostra. */
+static int _cc;
+
+/* Comptadors. */
+static GG_ProfCounter *_banks[256];
+static GG_ProfCounter *_other;
+static GG_ProfStats _stats;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static GG_ProfCounter *
+get_counter (
+             const Z80u16 pc
+             )
+{
+  
+  GG_ProfCounter **table;
+  size_t size;
+  int bank;
+  
+  
+  bank= GG_mem_get_bank ( pc );
+  if ( bank == -1 ) { table= &_other; size= OTHER_SIZE; }
+  else              { table= &_banks[bank]; size= BANK_SIZE; }
+  if ( *table == NULL )
+    {
+      *table= (GG_ProfCounter *) calloc ( size, sizeof(GG_ProfCounter) );
+      if ( *table == NULL ) return NULL;
+    }
+  
+  return &((*table)[bank==-1 ? (pc&(OTHER_SIZE-1)) : (pc&(BANK_SIZE-1))]);
+  
+} /* end get_counter */
+
+
+/* Compta N instruccions o mostres en PC que sumen CC cicles. */
+static void
+count (
+       const Z80u16 pc,
+       const int    n,
+       const int    cc
+       )
+{
+  
+  GG_ProfCounter *c;
+  
+  
+  c= get_counter ( pc );
+  if ( c == NULL ) { _stats.dropped+= n; return; }
+  c->count+= n;
+  c->cycles+= cc;
+  _stats.count+= n;
+  _stats.cycles+= cc;
+  
+} /* end count */
+
+
+/* Torna l'adreça del següent pas. */
+static Z80u16
+next_pc (void)
+{
+  
+  Z80_Step step;
+  Z80u16 addr;
+  
+  
+  addr= Z80_decode_next_step ( &step );
+  if ( step.type == Z80_STEP_INST ) addr-= step.val.inst.nbytes;
+  
+  return addr;
+  
+} /* end next_pc */
+
+
+static void
+write_table (
+             FILE                 *f,
+             const GG_ProfCounter *table,
+             const size_t          size,
+             const char           *fmt,
+             const unsigned long   base,
+             const Z80_Bool        cycles
+             )
+{
+  
+  size_t i;
+  uint64_t val;
+  
+  
+  for ( i= 0; i < size; ++i )
+    {
+      val= cycles ? table[i].cycles : table[i].count;
+      if ( val == 0 ) continue;
+      fprintf ( f, fmt, base+i, (unsigned long long) val );
+    }
+  
+} /* end write_table */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_prof_clear (void)
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < 256; ++i )
+    {
+      free ( _banks[i] );
+      _banks[i]= NULL;
+    }
+  free ( _other );
+  _other= NULL;
+  memset ( &_stats, 0, sizeof(_stats) );
+  
+} /* end GG_prof_clear */
+
+
+void
+GG_prof_close (void)
+{
+  
+  _mode= GG_PROF_OFF;
+  GG_prof_clear ();
+  
+} /* end GG_prof_close */
+
+
+int
+GG_prof_get (
+             const int       bank,
+             const Z80u16    addr,
+             GG_ProfCounter *counter
+             )
+{
+  
+  const GG_ProfCounter *table;
+  
+  
+  if ( bank < -1 || bank > 255 ) return -1;
+  table= bank == -1 ? _other : _banks[bank];
+  if ( table == NULL ) memset ( counter, 0, sizeof(GG_ProfCounter) );
+  else if ( bank == -1 ) *counter= table[addr&(OTHER_SIZE-1)];
+  else                   *counter= table[addr&(BANK_SIZE-1)];
+  
+  return 0;
+  
+} /* end GG_prof_get */
+
+
+GG_ProfMode
+GG_prof_get_mode (void)
+{
+  return _mode;
+} /* end GG_prof_get_mode */
+
+
+void
+GG_prof_get_stats (
+        	   GG_ProfStats *stats
+        	   )
+{
+  *stats= _stats;
+} /* end GG_prof_get_stats */
+
+
+int
+GG_prof_run (void)
+{
+  
+  Z80u16 pc;
+  int cc, n;
+  
+  
+  if ( _mode == GG_PROF_EXACT )
+    {
+      pc= next_pc ();
+      cc= Z80_run ();
+      count ( pc, 1, cc );
+    }
+  else
+    {
+      cc= Z80_run ();
+      /* Un pas pot durar més d'un període (per exemple amb PERIOD
+         xicotet o amb LDIR), totes les mostres que cauen dins van a
+         la mateixa adreça. */
+      if ( _mode == GG_PROF_SAMPLING && (_cc+= cc) >= _period )
+        {
+          n= _cc/_period;
+          _cc%= _period;
+          count ( next_pc (), n, n*_period );
+        }
+    }
+  
+  return cc;
+  
+} /* end GG_prof_run */
+
+
+int
+GG_prof_start (
+               const GG_ProfMode mode,
+               const int         period
+               )
+{
+  
+  if ( mode == GG_PROF_SAMPLING && period <= 0 ) return -1;
+  _mode= mode;
+  _period= period;
+  _cc= 0;
+  
+  return 0;
+  
+} /* end GG_prof_start */
+
+
+void
+GG_prof_stop (void)
+{
+  _mode= GG_PROF_OFF;
+} /* end GG_prof_stop */
+
+
+int
+GG_prof_write (
+               FILE           *f,
+               const Z80_Bool  cycles
+               )
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < 256; ++i )
+    if ( _banks[i] != NULL )
+      write_table ( f, _banks[i], BANK_SIZE, "rom:%06lX %llu\n",
+        	    (unsigned long) i*BANK_SIZE, cycles );
+  if ( _other != NULL )
+    write_table ( f, _other, OTHER_SIZE, "ram:%04lX %llu\n",
+        	  0x8000, cycles );
+  
+  return ferror ( f ) ? -1 : 0;
+  
+} /* end GG_prof_write */
@@ -23,12 +23,22 @@
  *  FA QUE DESAPAREGA UN SOROLL EN EL JOC DE TENIS. PERÒ CREC QUE HI
  *  HA UNA ERRADA EN ALGUN ALTRE LLOC.
  *
+ *  CAPTURA: L'eixida WAV es remostreja en el fil del simulador i es
+ *  passa a un fil escriptor mitjançant un GG_AudioRing, de manera que
+ *  el simulador mai espera al disc. El registre VGM és xicotet i
+ *  s'escriu directament (amb el buffer de stdio).
+ *
  */
 
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "GG.h"
 
@@ -48,6 +58,31 @@
 #define CHECK(COND)                             \
   if ( !(COND) ) return -1;
 
+/* Format portable (veure STATE). */
+#define PUT_U8(VAL) *(buf++)= (Z80u8) (VAL)
+
+#define PUT_U16(VAL) buf= GG_state_put_u16 ( buf, (Z80u16) (VAL) )
+
+#define PUT_I32(VAL) buf= GG_state_put_u32 ( buf, (uint32_t) (VAL) )
+
+#define GET_U8(VAR)        						\
+  p= GG_state_get_u8 ( p, end, &u8 ); (VAR)= u8
+
+#define GET_U16(VAR)        						\
+  p= GG_state_get_u16 ( p, end, &u16 ); (VAR)= u16
+
+#define GET_I32(VAR)        						\
+  p= GG_state_get_u32 ( p, end, &u32 ); (VAR)= (int32_t) u32
+
+/* Freqüència a la que es mesuren els temps en VGM. */
+#define VGM_FREQ 44100
+
+/* Grandària de la capçalera VGM (versió 1.50). */
+#define VGM_HEADER_SIZE 0x40
+
+/* Grandària de la capçalera WAV. */
+#define WAV_HEADER_SIZE 44
+
 
 
 
@@ -137,6 +172,44 @@ static int _right_mask;
 static GG_PlaySound *_play_sound;
 static void *_udata;
 
+/* Si està actiu no es genera eixida (ni es crida a _play_sound ni es
+   captura). No forma part de l'estat. */
+static Z80_Bool _mute;
+
+/* Si està actiu tampoc es calculen les mostres, sols s'avança l'estat
+   dels canals. No forma part de l'estat. */
+static Z80_Bool _fast;
+
+/* Captura WAV. */
+static struct
+{
+  
+  Z80_Bool          enabled;
+  FILE             *f;
+  GG_AudioRing     *ring;
+  pthread_t         thread;
+  volatile Z80_Bool stop;       /* Demana al fil escriptor que pare. */
+  Z80_Bool          error;      /* Sols el modifica el fil escriptor. */
+  unsigned long     nframes;    /* 'Frames' escrits. */
+  int               freq;
+  double            ratio;
+  double            pos;
+  double            chunk[2*GG_PSG_BUFFER_SIZE];
+  
+} _wav;
+
+/* Captura VGM. */
+static struct
+{
+  
+  FILE               *f;
+  unsigned long long  cc;         /* Cicles des de l'inici. */
+  unsigned long       samples;    /* Mostres (a VGM_FREQ) ja
+        			     esperades. */
+  unsigned long       size;       /* Bytes escrits. */
+  
+} _vgm;
+
 
 
 
@@ -227,6 +300,67 @@ render_noise_channel (
 } /* end render_noise_channel */
 
 
+/* Com render_tone_channel però sense generar les N mostres. */
+static tone_channel_t
+skip_tone_channel (
+        	   tone_channel_t channel,
+        	   const int      n
+        	   )
+{
+  
+  int first, rest;
+  
+  
+  first= channel.counter == 0 ? 1 : channel.counter;
+  if ( n < first ) { channel.counter-= n; return channel; }
+  if ( channel.reg <= 1 ) { channel.counter= channel.reg; return channel; }
+  rest= n-first;
+  if ( (1 + rest/channel.reg)&0x1 ) channel.out^= 0x1;
+  channel.counter= channel.reg - rest%channel.reg;
+  
+  return channel;
+  
+} /* end skip_tone_channel */
+
+
+/* Com render_noise_channel però sense generar les N mostres. */
+static void
+skip_noise_channel (
+        	    int n
+        	    )
+{
+  
+  int first;
+  Z80_Bool clk;
+  
+  
+  for (;;)
+    {
+      first= _noise_channel.counter == 0 ? 1 : _noise_channel.counter;
+      if ( n < first ) { _noise_channel.counter-= n; break; }
+      n-= first;
+      if ( _noise_channel.reg <= 1 ) clk= (_noise_channel.out == 0);
+      else                           clk= ((_noise_channel.out^= 1)==1);
+      if ( clk )
+        _noise_channel.shift=
+          (_noise_channel.shift<<1) |
+          (_noise_channel.white ?
+           (((_noise_channel.shift>>15)^(_noise_channel.shift>>12))&0x1) :
+           (_noise_channel.shift>>15));
+      switch ( _noise_channel.sel_len )
+        {
+        case 0: _noise_channel.reg= 0x10; break;
+        case 1: _noise_channel.reg= 0x20; break;
+        case 2: _noise_channel.reg= 0x40; break;
+        case 3: _noise_channel.reg= _tone_channels[2].reg; break;
+        default: break;
+        }
+      _noise_channel.counter= _noise_channel.reg;
+    }
+  
+} /* end skip_noise_channel */
+
+
 static void
 join_channels (
                int     mask,
@@ -250,6 +384,243 @@ join_channels (
 } /* end join_channels */
 
 
+static void
+write_u16 (
+           Z80u8          *p,
+           const unsigned  val
+           )
+{
+  
+  p[0]= (Z80u8) val;
+  p[1]= (Z80u8) (val>>8);
+  
+} /* end write_u16 */
+
+
+static void
+write_u32 (
+           Z80u8               *p,
+           const unsigned long  val
+           )
+{
+  
+  p[0]= (Z80u8) val;
+  p[1]= (Z80u8) (val>>8);
+  p[2]= (Z80u8) (val>>16);
+  p[3]= (Z80u8) (val>>24);
+  
+} /* end write_u32 */
+
+
+static int
+wav_write_header (
+        	  FILE                *f,
+        	  const int            freq,
+        	  const unsigned long  nframes
+        	  )
+{
+  
+  Z80u8 h[WAV_HEADER_SIZE];
+  
+  
+  memcpy ( h, "RIFF", 4 );
+  write_u32 ( h+4, 36 + nframes*4 );
+  memcpy ( h+8, "WAVEfmt ", 8 );
+  write_u32 ( h+16, 16 );
+  write_u16 ( h+20, 1 ); /* PCM. */
+  write_u16 ( h+22, 2 ); /* Estèreo. */
+  write_u32 ( h+24, freq );
+  write_u32 ( h+28, freq*4 );
+  write_u16 ( h+32, 4 );
+  write_u16 ( h+34, 16 );
+  memcpy ( h+36, "data", 4 );
+  write_u32 ( h+40, nframes*4 );
+  if ( fwrite ( h, sizeof(h), 1, f ) != 1 ) return -1;
+  
+  return 0;
+  
+} /* end wav_write_header */
+
+
+/* Converteix i escriu tot el que hi ha en el buffer circular. */
+static void
+wav_flush (void)
+{
+  
+  double frames[2*512];
+  Z80u8 out[4*512];
+  int n, i, j, val;
+  
+  
+  while ( (n= GG_audio_ring_read ( _wav.ring, frames, 512 )) > 0 )
+    {
+      for ( i= j= 0; i < 2*n; ++i, j+= 2 )
+        {
+          val= (int) (frames[i]*32767.0 + 0.5);
+          if ( val > 32767 ) val= 32767;
+          write_u16 ( out+j, (unsigned) val );
+        }
+      if ( !_wav.error && fwrite ( out, 4*n, 1, _wav.f ) != 1 )
+        _wav.error= Z80_TRUE;
+      _wav.nframes+= n;
+      if ( n < 512 ) break;
+    }
+  
+} /* end wav_flush */
+
+
+static void *
+wav_writer (
+            void *data
+            )
+{
+  
+  static const struct timespec ts= { 0, 10000000 }; /* 10ms. */
+  
+  
+  (void) data;
+  while ( !_wav.stop )
+    {
+      wav_flush ();
+      nanosleep ( &ts, NULL );
+    }
+  wav_flush ();
+  
+  return NULL;
+  
+} /* end wav_writer */
+
+
+/* Remostreja i passa el buffer al fil escriptor. */
+static void
+wav_capture (void)
+{
+  
+  int n, j;
+  
+  
+  n= 0;
+  j= (int) (_wav.pos + 0.5);
+  while ( j < GG_PSG_BUFFER_SIZE )
+    {
+      if ( n == 2*GG_PSG_BUFFER_SIZE )
+        {
+          GG_audio_ring_write ( _wav.ring, _wav.chunk, n/2 );
+          n= 0;
+        }
+      _wav.chunk[n++]= _left[j];
+      _wav.chunk[n++]= _right[j];
+      _wav.pos+= _wav.ratio;
+      j= (int) (_wav.pos + 0.5);
+    }
+  _wav.pos-= GG_PSG_BUFFER_SIZE;
+  GG_audio_ring_write ( _wav.ring, _wav.chunk, n/2 );
+  
+} /* end wav_capture */
+
+
+static void
+vgm_write (
+           const Z80u8 *data,
+           const int    n
+           )
+{
+  
+  if ( fwrite ( data, n, 1, _vgm.f ) == 1 )
+    _vgm.size+= n;
+  
+} /* end vgm_write */
+
+
+/* Escriu les esperes necessàries fins a l'instant actual. */
+static void
+vgm_sync (void)
+{
+  
+  unsigned long now, wait;
+  Z80u8 cmd[3];
+  
+  
+  now= (unsigned long)
+    ((_vgm.cc*VGM_FREQ + GG_CICLES_PER_SEC/2) / GG_CICLES_PER_SEC);
+  while ( now > _vgm.samples )
+    {
+      wait= now - _vgm.samples;
+      if ( wait > 0xFFFF ) wait= 0xFFFF;
+      if ( wait <= 16 )
+        {
+          cmd[0]= (Z80u8) (0x70 | (wait-1));
+          vgm_write ( cmd, 1 );
+        }
+      else if ( wait == 735 ) { cmd[0]= 0x62; vgm_write ( cmd, 1 ); }
+      else if ( wait == 882 ) { cmd[0]= 0x63; vgm_write ( cmd, 1 ); }
+      else
+        {
+          cmd[0]= 0x61;
+          write_u16 ( cmd+1, (unsigned) wait );
+          vgm_write ( cmd, 3 );
+        }
+      _vgm.samples+= wait;
+    }
+  
+} /* end vgm_sync */
+
+
+static void
+vgm_cmd (
+         const Z80u8 cmd,
+         const Z80u8 data
+         )
+{
+  
+  Z80u8 buf[2];
+  
+  
+  vgm_sync ();
+  buf[0]= cmd;
+  buf[1]= data;
+  vgm_write ( buf, 2 );
+  
+} /* end vgm_cmd */
+
+
+/* Escriu els comandaments necessaris per a reproduir l'estat actual
+ * del xip.
+ */
+static void
+vgm_dump_state (void)
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < 3; ++i )
+    {
+      vgm_cmd ( 0x50, (Z80u8) (0x80|(i<<5)|(_tone_channels[i].reg&0xF)) );
+      vgm_cmd ( 0x50, (Z80u8) ((_tone_channels[i].reg>>4)&0x3F) );
+      vgm_cmd ( 0x50, (Z80u8) (0x90|(i<<5)|_tone_channels[i].vol) );
+    }
+  vgm_cmd ( 0x50, (Z80u8) (0xE0 | (_noise_channel.white ? 0x4 : 0x0) |
+        		   _noise_channel.sel_len) );
+  vgm_cmd ( 0x50, (Z80u8) (0xF0|_noise_channel.vol) );
+  vgm_cmd ( 0x4F, (Z80u8) ((_left_mask<<4)|_right_mask) );
+  
+  /* Deixa el latch com estava. */
+  if ( _latch_type == DATA )
+    vgm_cmd ( 0x50, (Z80u8) (0x80|(_latch_channel<<5) |
+        		     (_latch_channel==3 ?
+        		      ((_noise_channel.white ? 0x4 : 0x0) |
+        		       _noise_channel.sel_len) :
+        		      (_tone_channels[_latch_channel].reg&0xF))) );
+  else
+    vgm_cmd ( 0x50, (Z80u8) (0x90|(_latch_channel<<5) |
+        		     (_latch_channel==3 ?
+        		      _noise_channel.vol :
+        		      _tone_channels[_latch_channel].vol)) );
+  
+} /* end vgm_dump_state */
+
+
 static void
 run (
      const int begin,
@@ -260,23 +631,41 @@ run (
   int i;
   
   
+  /* Les mostres no calculades es deixen en silenci. */
+  GG_PERF_BEGIN ( GG_PERF_SYNTH );
+  if ( _fast )
+    {
+      for ( i= 0; i < 3; ++i )
+        _tone_channels[i]= skip_tone_channel ( _tone_channels[i], end-begin );
+      skip_noise_channel ( end-begin );
+      for ( i= 0; i < 4; ++i )
+        memset ( &(_buffer[i][begin]), 0xf, end-begin );
+      GG_PERF_END ( GG_PERF_SYNTH );
+      return;
+    }
   for ( i= 0; i < 3; ++i )
     _tone_channels[i]=
       render_tone_channel ( _tone_channels[i], _buffer[i], begin, end );
   render_noise_channel ( _buffer[3], begin, end );
+  GG_PERF_END ( GG_PERF_SYNTH );
   
-  if ( end == GG_PSG_BUFFER_SIZE )
+  if ( end == GG_PSG_BUFFER_SIZE && !_mute )
     {
+      GG_PERF_BEGIN ( GG_PERF_MIX );
       join_channels ( _left_mask, _left );
       join_channels ( _right_mask, _right );
+      GG_PERF_END ( GG_PERF_MIX );
+      if ( _wav.enabled ) wav_capture ();
+      GG_PERF_BEGIN ( GG_PERF_PLAY_SOUND );
       _play_sound ( _left, _right, _udata );
+      GG_PERF_END ( GG_PERF_PLAY_SOUND );
     }
   
 } /* end run */
 
 
 static void
-clock (void)
+clock_psg (void)
 {
   
   int npos;
@@ -300,7 +689,53 @@ clock (void)
   if ( _timing.cctoFrame <= 0 )
     _timing.cctoFrame= (GG_PSG_BUFFER_SIZE-_timing.pos)*16;
   
-} /* end clock */
+} /* end clock_psg */
+
+
+
+/* Comprova que l'estat acabat de carregar és coherent. */
+static int
+check_state (void)
+{
+  
+  int i;
+  
+  
+  CHECK ( _latch_channel >= 0 && _latch_channel <= 3 );
+  for ( i= 0; i < 3; ++i )
+    {
+      CHECK ( (_tone_channels[i].vol&0xF) == _tone_channels[i].vol );
+    }
+  CHECK ( (_noise_channel.vol&0xF) == _noise_channel.vol );
+  CHECK ( _timing.pos >= 0 && _timing.pos < GG_PSG_BUFFER_SIZE );
+  CHECK ( _timing.cc >= 0 );
+  
+  return 0;
+  
+} /* end check_state */
+
+
+static int
+check_buffers (void)
+{
+  
+  int i;
+  const Z80u8 *p;
+  
+  
+  for ( p= &(_buffer[0][0]), i= 0; i < 4*GG_PSG_BUFFER_SIZE; ++i, ++p )
+    if ( (*p&0xF) != *p )
+      return -1;
+  for ( i= 0; i < GG_PSG_BUFFER_SIZE; ++i )
+    if ( _left[i] < 0.0 || _left[i] > 1.0 )
+      return -1;
+  for ( i= 0; i < GG_PSG_BUFFER_SIZE; ++i )
+    if ( _right[i] < 0.0 || _right[i] > 1.0 )
+      return -1;
+  
+  return 0;
+  
+} /* end check_buffers */
 
 
 
@@ -309,14 +744,29 @@ clock (void)
 /* FUNCIONS PÚBLIQUES */
 /**********************/
 
+int
+GG_psg_cc_to_event (void)
+{
+  
+  int ret;
+  
+  
+  ret= _timing.cctoFrame - _timing.cc - 1;
+  
+  return ret > 0 ? ret : 0;
+  
+} /* end GG_psg_cc_to_event */
+
+
 void
 GG_psg_clock (
               const int cc
               )
 {
   
+  if ( _vgm.f != NULL && !_mute ) _vgm.cc+= cc;
   if ( (_timing.cc+= cc) >= _timing.cctoFrame )
-    clock ();
+    clock_psg ();
   
 } /* end GG_psg_clock */
 
@@ -327,7 +777,8 @@ GG_psg_control (
         	)
 {
   
-  clock ();
+  clock_psg ();
+  if ( _vgm.f != NULL && !_mute ) vgm_cmd ( 0x50, data );
   
   /* LATCH/DATA byte. */
   if ( data&0x80 )
@@ -397,6 +848,8 @@ GG_psg_init (
   GG_psg_init_state ();
   _play_sound= play_sound;
   _udata= udata;
+  _mute= Z80_FALSE;
+  _fast= Z80_FALSE;
   
 } /* end GG_psg_init */
 
@@ -445,6 +898,8 @@ GG_psg_init_state (void)
   _left_mask= 0xf;
   _right_mask= 0xf;
   
+  if ( _vgm.f != NULL && !_mute ) vgm_dump_state ();
+  
 } /* end GG_psg_init_state */
 
 
@@ -454,7 +909,8 @@ GG_psg_stereo (
                )
 {
   
-  clock ();
+  clock_psg ();
+  if ( _vgm.f != NULL && !_mute ) vgm_cmd ( 0x4F, data );
   _right_mask= data&0xf;
   _left_mask= data>>4;
   
@@ -488,39 +944,440 @@ GG_psg_load_state (
         	   FILE *f
         	   )
 {
-
-  int i;
-  const Z80u8 *p;
-  
   
   LOAD ( _latch_channel );
-  CHECK ( _latch_channel >= 0 && _latch_channel <= 3 );
   LOAD ( _latch_type );
   LOAD ( _tone_channels );
-  for ( i= 0; i < 3; ++i )
-    {
-      CHECK ( (_tone_channels[i].vol&0xF) == _tone_channels[i].vol );
-    }
   LOAD ( _noise_channel );
-  CHECK ( (_noise_channel.vol&0xF) == _noise_channel.vol );
   LOAD ( _buffer );
-  for ( p= &(_buffer[0][0]), i= 0; i < 4*GG_PSG_BUFFER_SIZE; ++i, ++p )
-    if ( (*p&0xF) != *p )
-      return -1;
   LOAD ( _timing );
-  CHECK ( _timing.pos >= 0 && _timing.pos < GG_PSG_BUFFER_SIZE );
-  CHECK ( _timing.cc >= 0 );
   LOAD ( _left );
-  for ( i= 0; i < GG_PSG_BUFFER_SIZE; ++i )
-    if ( _left[i] < 0.0 || _left[i] > 1.0 )
-      return -1;
   LOAD ( _right );
-  for ( i= 0; i < GG_PSG_BUFFER_SIZE; ++i )
-    if ( _right[i] < 0.0 || _right[i] > 1.0 )
-      return -1;
   LOAD ( _left_mask );
   LOAD ( _right_mask );
+  CHECK ( check_state () == 0 );
+  CHECK ( check_buffers () == 0 );
+  
+  if ( _vgm.f != NULL && !_mute ) vgm_dump_state ();
   
   return 0;
   
 } /* end GG_psg_load_state */
+
+
+size_t
+GG_psg_state_size (void)
+{
+  return sizeof(_latch_channel) + sizeof(_latch_type) +
+    sizeof(_tone_channels) + sizeof(_noise_channel) + sizeof(_buffer) +
+    sizeof(_timing) + sizeof(_left) + sizeof(_right) +
+    sizeof(_left_mask) + sizeof(_right_mask);
+} /* end GG_psg_state_size */
+
+
+Z80u8 *
+GG_psg_save_state_mem (
+        	       Z80u8 *buf
+        	       )
+{
+  
+  GG_SAVE_MEM ( _latch_channel );
+  GG_SAVE_MEM ( _latch_type );
+  GG_SAVE_MEM ( _tone_channels );
+  GG_SAVE_MEM ( _noise_channel );
+  GG_SAVE_MEM ( _buffer );
+  GG_SAVE_MEM ( _timing );
+  GG_SAVE_MEM ( _left );
+  GG_SAVE_MEM ( _right );
+  GG_SAVE_MEM ( _left_mask );
+  GG_SAVE_MEM ( _right_mask );
+  
+  return buf;
+  
+} /* end GG_psg_save_state_mem */
+
+
+const Z80u8 *
+GG_psg_load_state_mem (
+        	       const Z80u8    *buf,
+        	       const Z80u8    *end,
+        	       const Z80_Bool  trusted
+        	       )
+{
+  
+  GG_LOAD_MEM ( _latch_channel );
+  GG_LOAD_MEM ( _latch_type );
+  GG_LOAD_MEM ( _tone_channels );
+  GG_LOAD_MEM ( _noise_channel );
+  GG_LOAD_MEM ( _buffer );
+  GG_LOAD_MEM ( _timing );
+  GG_LOAD_MEM ( _left );
+  GG_LOAD_MEM ( _right );
+  GG_LOAD_MEM ( _left_mask );
+  GG_LOAD_MEM ( _right_mask );
+  GG_CHECK_MEM ( check_state () == 0 );
+  GG_CHECK_MEM ( trusted || check_buffers () == 0 );
+  
+  if ( _vgm.f != NULL && !_mute ) vgm_dump_state ();
+  
+  return buf;
+  
+} /* end GG_psg_load_state_mem */
+
+
+Z80u8 *
+GG_psg_save_state_compact_mem (
+        		       Z80u8 *buf
+        		       )
+{
+  
+  int i;
+  
+  
+  GG_SAVE_MEM ( _latch_channel );
+  GG_SAVE_MEM ( _latch_type );
+  GG_SAVE_MEM ( _tone_channels );
+  GG_SAVE_MEM ( _noise_channel );
+  GG_SAVE_MEM ( _timing );
+  GG_SAVE_MEM ( _left_mask );
+  GG_SAVE_MEM ( _right_mask );
+  
+  /* Sols les mostres ja generades del buffer actual. _left i _right
+     es calculen a partir d'elles quan s'ompli el buffer. */
+  for ( i= 0; i < 4; ++i )
+    {
+      memcpy ( buf, _buffer[i], _timing.pos );
+      buf+= _timing.pos;
+    }
+  
+  return buf;
+  
+} /* end GG_psg_save_state_compact_mem */
+
+
+const Z80u8 *
+GG_psg_load_state_compact_mem (
+        		       const Z80u8 *buf,
+        		       const Z80u8 *end
+        		       )
+{
+  
+  int i, j;
+  
+  
+  GG_LOAD_MEM ( _latch_channel );
+  GG_LOAD_MEM ( _latch_type );
+  GG_LOAD_MEM ( _tone_channels );
+  GG_LOAD_MEM ( _noise_channel );
+  GG_LOAD_MEM ( _timing );
+  GG_LOAD_MEM ( _left_mask );
+  GG_LOAD_MEM ( _right_mask );
+  GG_CHECK_MEM ( check_state () == 0 );
+  GG_CHECK_MEM ( (size_t) (end-buf) >= 4*(size_t) _timing.pos );
+  for ( i= 0; i < 4; ++i )
+    {
+      memcpy ( _buffer[i], buf, _timing.pos );
+      buf+= _timing.pos;
+      for ( j= 0; j < _timing.pos; ++j )
+        GG_CHECK_MEM ( (_buffer[i][j]&0xF) == _buffer[i][j] );
+    }
+  
+  if ( _vgm.f != NULL && !_mute ) vgm_dump_state ();
+  
+  return buf;
+  
+} /* end GG_psg_load_state_compact_mem */
+
+
+Z80u8 *
+GG_psg_save_state_chunks (
+        		  Z80u8 *buf
+        		  )
+{
+  
+  Z80u8 *data;
+  int i;
+  
+  
+  data= buf= GG_state_begin_chunk ( buf, GG_STATE_PSG );
+  PUT_U8 ( _latch_channel );
+  PUT_U8 ( _latch_type==DATA );
+  for ( i= 0; i < 3; ++i )
+    {
+      PUT_U16 ( _tone_channels[i].reg );
+      PUT_U16 ( _tone_channels[i].counter );
+      PUT_U8 ( _tone_channels[i].out );
+      PUT_U8 ( _tone_channels[i].vol );
+    }
+  PUT_U8 ( _noise_channel.sel_len );
+  PUT_U8 ( _noise_channel.white );
+  PUT_U16 ( _noise_channel.counter );
+  PUT_U16 ( _noise_channel.shift );
+  PUT_U8 ( _noise_channel.vol );
+  PUT_U8 ( _noise_channel.out );
+  PUT_U8 ( _noise_channel.reg );
+  PUT_I32 ( _timing.pos );
+  PUT_I32 ( _timing.cc );
+  PUT_I32 ( _timing.cctoFrame );
+  PUT_U8 ( (_left_mask<<4) | _right_mask );
+  
+  /* Mostres ja generades del buffer actual. */
+  for ( i= 0; i < 4; ++i )
+    {
+      memcpy ( buf, _buffer[i], _timing.pos );
+      buf+= _timing.pos;
+    }
+  buf= GG_state_end_chunk ( data, buf );
+  
+  return buf;
+  
+} /* end GG_psg_save_state_chunks */
+
+
+int
+GG_psg_load_state_chunks (
+        		  const GG_StateChunks *chunks
+        		  )
+{
+  
+  const Z80u8 *p, *end;
+  size_t size;
+  Z80u8 u8, type, mask;
+  Z80u16 u16;
+  uint32_t u32;
+  int i, j;
+  
+  
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_PSG, &size )) == NULL )
+    return 0;
+  u8= 0; u16= 0; u32= 0;
+  end= p + size;
+  GET_U8 ( _latch_channel );
+  GET_U8 ( type );
+  for ( i= 0; i < 3; ++i )
+    {
+      GET_U16 ( _tone_channels[i].reg );
+      GET_U16 ( _tone_channels[i].counter );
+      GET_U8 ( _tone_channels[i].out );
+      GET_U8 ( _tone_channels[i].vol );
+    }
+  GET_U8 ( _noise_channel.sel_len );
+  GET_U8 ( _noise_channel.white );
+  GET_U16 ( _noise_channel.counter );
+  GET_U16 ( _noise_channel.shift );
+  GET_U8 ( _noise_channel.vol );
+  GET_U8 ( _noise_channel.out );
+  GET_U8 ( _noise_channel.reg );
+  GET_I32 ( _timing.pos );
+  GET_I32 ( _timing.cc );
+  GET_I32 ( _timing.cctoFrame );
+  GET_U8 ( mask );
+  CHECK ( p != NULL && type <= 1 );
+  _latch_type= type ? DATA : VOL;
+  _left_mask= mask>>4;
+  _right_mask= mask&0xF;
+  CHECK ( check_state () == 0 );
+  CHECK ( (size_t) (end-p) == 4*(size_t) _timing.pos );
+  for ( i= 0; i < 4; ++i )
+    {
+      memcpy ( _buffer[i], p, _timing.pos );
+      p+= _timing.pos;
+      for ( j= 0; j < _timing.pos; ++j )
+        CHECK ( (_buffer[i][j]&0xF) == _buffer[i][j] );
+    }
+  
+  if ( _vgm.f != NULL && !_mute ) vgm_dump_state ();
+  
+  return 0;
+  
+} /* end GG_psg_load_state_chunks */
+
+
+int
+GG_psg_capture_vgm_start (
+        		  const char *fn
+        		  )
+{
+  
+  Z80u8 h[VGM_HEADER_SIZE];
+  
+  
+  if ( _vgm.f != NULL ) GG_psg_capture_vgm_stop ();
+  _vgm.f= fopen ( fn, "wb" );
+  if ( _vgm.f == NULL ) return -1;
+  
+  /* Capçalera provisional, es completa al acabar. */
+  memset ( h, 0, sizeof(h) );
+  memcpy ( h, "Vgm ", 4 );
+  write_u32 ( h+0x08, 0x150 );
+  write_u32 ( h+0x0C, GG_CICLES_PER_SEC );
+  write_u32 ( h+0x24, 60 );
+  write_u16 ( h+0x28, 0x0009 ); /* Realimentació SEGA. */
+  h[0x2A]= 16; /* Registre de desplaçament. */
+  write_u32 ( h+0x34, VGM_HEADER_SIZE-0x34 );
+  if ( fwrite ( h, sizeof(h), 1, _vgm.f ) != 1 )
+    {
+      fclose ( _vgm.f );
+      _vgm.f= NULL;
+      return -1;
+    }
+  _vgm.cc= 0;
+  _vgm.samples= 0;
+  _vgm.size= VGM_HEADER_SIZE;
+  vgm_dump_state ();
+  
+  return 0;
+  
+} /* end GG_psg_capture_vgm_start */
+
+
+int
+GG_psg_capture_vgm_stop (void)
+{
+  
+  Z80u8 buf[4];
+  int ret;
+  
+  
+  if ( _vgm.f == NULL ) return 0;
+  vgm_sync ();
+  buf[0]= 0x66;
+  vgm_write ( buf, 1 );
+  ret= 0;
+  write_u32 ( buf, _vgm.size-4 );
+  if ( fseek ( _vgm.f, 0x04, SEEK_SET ) != 0 ||
+       fwrite ( buf, 4, 1, _vgm.f ) != 1 ) ret= -1;
+  write_u32 ( buf, _vgm.samples );
+  if ( fseek ( _vgm.f, 0x18, SEEK_SET ) != 0 ||
+       fwrite ( buf, 4, 1, _vgm.f ) != 1 ) ret= -1;
+  if ( ferror ( _vgm.f ) ) ret= -1;
+  if ( fclose ( _vgm.f ) != 0 ) ret= -1;
+  _vgm.f= NULL;
+  
+  return ret;
+  
+} /* end GG_psg_capture_vgm_stop */
+
+
+int
+GG_psg_capture_wav_start (
+        		  const char *fn,
+        		  const int   freq
+        		  )
+{
+  
+  if ( _wav.enabled ) GG_psg_capture_wav_stop ();
+  if ( freq <= 0 || freq > GG_PSG_SAMPLES_PER_SEC ) return -1;
+  _wav.f= fopen ( fn, "wb" );
+  if ( _wav.f == NULL ) return -1;
+  if ( wav_write_header ( _wav.f, freq, 0 ) != 0 ) goto error;
+  
+  /* Un segon de marge per si el disc es para. */
+  _wav.ring= GG_audio_ring_new ( freq );
+  if ( _wav.ring == NULL ) goto error;
+  _wav.freq= freq;
+  _wav.ratio= GG_PSG_SAMPLES_PER_SEC / (double) freq;
+  _wav.pos= 0.0;
+  _wav.nframes= 0;
+  _wav.stop= Z80_FALSE;
+  _wav.error= Z80_FALSE;
+  if ( pthread_create ( &_wav.thread, NULL, wav_writer, NULL ) != 0 )
+    {
+      GG_audio_ring_free ( _wav.ring );
+      goto error;
+    }
+  _wav.enabled= Z80_TRUE;
+  
+  return 0;
+  
+ error:
+  fclose ( _wav.f );
+  return -1;
+  
+} /* end GG_psg_capture_wav_start */
+
+
+int
+GG_psg_capture_wav_stop (void)
+{
+  
+  GG_AudioRingStats stats;
+  int ret;
+  
+  
+  if ( !_wav.enabled ) return 0;
+  _wav.enabled= Z80_FALSE;
+  _wav.stop= Z80_TRUE;
+  pthread_join ( _wav.thread, NULL );
+  GG_audio_ring_get_stats ( _wav.ring, &stats );
+  GG_audio_ring_free ( _wav.ring );
+  ret= (_wav.error || stats.overruns > 0) ? -1 : 0;
+  if ( fseek ( _wav.f, 0, SEEK_SET ) != 0 ||
+       wav_write_header ( _wav.f, _wav.freq, _wav.nframes ) != 0 )
+    ret= -1;
+  if ( fclose ( _wav.f ) != 0 ) ret= -1;
+  
+  return ret;
+  
+} /* end GG_psg_capture_wav_stop */
+
+
+const Z80u8 *
+GG_psg_get_channel_buffer (
+        		   const int channel
+        		   )
+{
+  return _buffer[channel&0x3];
+} /* end GG_psg_get_channel_buffer */
+
+
+GG_Hash
+GG_psg_get_hash (void)
+{
+  
+  GG_Hash hash;
+  
+  
+  hash= GG_hash_bytes ( 0, &_latch_channel, sizeof(_latch_channel) );
+  hash= GG_hash_bytes ( hash, &_latch_type, sizeof(_latch_type) );
+  hash= GG_hash_bytes ( hash, _tone_channels, sizeof(_tone_channels) );
+  hash= GG_hash_bytes ( hash, &_noise_channel, sizeof(_noise_channel) );
+  hash= GG_hash_bytes ( hash, &_timing, sizeof(_timing) );
+  hash= GG_hash_bytes ( hash, &_left_mask, sizeof(_left_mask) );
+  hash= GG_hash_bytes ( hash, &_right_mask, sizeof(_right_mask) );
+  
+  return hash;
+  
+} /* end GG_psg_get_hash */
+
+
+const double *
+GG_psg_get_volume_table (void)
+{
+  return _volume_table;
+} /* end GG_psg_get_volume_table */
+
+
+void
+GG_psg_set_fast (
+        	 const Z80_Bool fast
+        	 )
+{
+  _fast= fast;
+} /* end GG_psg_set_fast */
+
+
+void
+GG_psg_set_mute (
+        	 const Z80_Bool mute
+        	 )
+{
+  _mute= mute;
+} /* end GG_psg_set_mute */
+
+
+Z80_Bool
+GG_psg_get_mute (void)
+{
+  return _mute;
+} /* end GG_psg_get_mute */
@@ -0,0 +1,434 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  rewind.c - Implementació del mòdul REWIND.
+ *
+ *  NOTES: Es guarda sencera sols l'última captura (en format
+ *  compacte). Cada vegada que se'n fa una nova, es calcula l'XOR amb
+ *  l'anterior, es comprimeix amb RLE (quasi tot són zeros perquè la
+ *  RAM, la VRAM i la SRAM canvien poc d'un 'frame' a l'altre) i es
+ *  guarda en un buffer circular de bytes. Per a tornar arrere es
+ *  trau l'últim delta i es fa l'XOR amb la captura actual. Quan el
+ *  buffer s'ompli s'esborren els deltes més antics.
+ *
+ *  Format d'una entrada del buffer circular:
+ *
+ *    uint32_t len     - Bytes del delta comprimit.
+ *    uint32_t size    - Grandària de la captura que es recupera.
+ *    delta            - 'len' bytes.
+ *    uint32_t len     - Repetit per a poder recórrer cap arrere.
+ *
+ *  Format del delta: una seqüència de parells (uint16_t zeros,
+ *  uint16_t lits) seguits de 'lits' bytes literals.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+/* Bytes extra de cada entrada. */
+#define ENTRY_OVERHEAD (3*sizeof(uint32_t))
+
+/* Mínim de zeros seguits per a tallar una seqüència de literals. */
+#define MIN_ZEROS 4
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80_Bool _enabled= Z80_FALSE;
+
+/* Captures. */
+static struct
+{
+  
+  Z80u8  *cur;         /* Última captura. */
+  size_t  cur_size;
+  Z80u8  *next;        /* Captura en curs. */
+  size_t  next_size;
+  Z80u8  *delta;       /* Delta comprimit. */
+  size_t  max_size;    /* Grandària dels buffers 'cur' i 'next'. */
+  
+} _snap;
+
+/* Buffer circular de deltes. */
+static struct
+{
+  
+  Z80u8  *v;
+  size_t  size;
+  size_t  begin;       /* Posició (sense màscara) de l'entrada més
+        		  antiga. */
+  size_t  end;         /* Posició (sense màscara) on comença la
+        		  següent entrada. */
+  int     N;           /* Entrades. */
+  
+} _ring;
+
+/* Freqüència de captura. */
+static int _interval;
+static int _frames;    /* 'Frames' des de l'última captura. */
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+ring_write (
+            size_t       pos,
+            const void  *data,
+            const size_t n
+            )
+{
+  
+  size_t begin, n1;
+  
+  
+  begin= pos%_ring.size;
+  n1= _ring.size - begin;
+  if ( n1 > n ) n1= n;
+  memcpy ( _ring.v + begin, data, n1 );
+  if ( n1 < n )
+    memcpy ( _ring.v, ((const Z80u8 *) data) + n1, n-n1 );
+  
+} /* end ring_write */
+
+
+static void
+ring_read (
+           size_t       pos,
+           void        *data,
+           const size_t n
+           )
+{
+  
+  size_t begin, n1;
+  
+  
+  begin= pos%_ring.size;
+  n1= _ring.size - begin;
+  if ( n1 > n ) n1= n;
+  memcpy ( data, _ring.v + begin, n1 );
+  if ( n1 < n )
+    memcpy ( ((Z80u8 *) data) + n1, _ring.v, n-n1 );
+  
+} /* end ring_read */
+
+
+/* Esborra l'entrada més antiga. */
+static void
+ring_drop (void)
+{
+  
+  uint32_t len;
+  
+  
+  ring_read ( _ring.begin, &len, sizeof(len) );
+  _ring.begin+= len + ENTRY_OVERHEAD;
+  --_ring.N;
+  
+} /* end ring_drop */
+
+
+static void
+ring_clear (void)
+{
+  
+  _ring.begin= _ring.end= 0;
+  _ring.N= 0;
+  
+} /* end ring_clear */
+
+
+/* Comprimeix l'XOR de 'cur' i 'next' en 'delta' i torna la grandària. */
+static size_t
+encode_delta (void)
+{
+  
+  const Z80u8 *a, *b;
+  Z80u8 *out, *tok;
+  size_t i, n, zeros, lits, j;
+  uint16_t aux;
+  
+  
+  a= _snap.cur;
+  b= _snap.next;
+  n= _snap.cur_size>_snap.next_size ? _snap.cur_size : _snap.next_size;
+  out= _snap.delta;
+  i= 0;
+  while ( i < n )
+    {
+  
+      /* Zeros. */
+      for ( zeros= 0; i < n && zeros < 0xFFFF && a[i] == b[i]; ++i, ++zeros );
+  
+      /* Literals. Les seqüències curtes de zeros es queden dins. */
+      for ( lits= 0; i+lits < n && lits < 0xFFFF; ++lits )
+        if ( a[i+lits] == b[i+lits] )
+          {
+            for ( j= 1;
+        	  j < MIN_ZEROS && i+lits+j < n &&
+        	    a[i+lits+j] == b[i+lits+j];
+        	  ++j );
+            if ( j == MIN_ZEROS || i+lits+j == n ) break;
+          }
+      tok= out;
+      aux= (uint16_t) zeros; memcpy ( tok, &aux, sizeof(aux) );
+      aux= (uint16_t) lits; memcpy ( tok+2, &aux, sizeof(aux) );
+      out+= 4;
+      for ( j= 0; j < lits; ++j )
+        *(out++)= a[i+j]^b[i+j];
+      i+= lits;
+  
+    }
+  
+  return (size_t) (out-_snap.delta);
+  
+} /* end encode_delta */
+
+
+/* Aplica sobre 'cur' el delta de LEN bytes. */
+static void
+apply_delta (
+             const size_t len
+             )
+{
+  
+  const Z80u8 *p, *end;
+  Z80u8 *q;
+  uint16_t zeros, lits;
+  
+  
+  p= _snap.delta;
+  end= p + len;
+  q= _snap.cur;
+  while ( p < end )
+    {
+      memcpy ( &zeros, p, sizeof(zeros) );
+      memcpy ( &lits, p+2, sizeof(lits) );
+      p+= 4;
+      q+= zeros;
+      while ( lits-- )
+        *(q++)^= *(p++);
+    }
+  
+} /* end apply_delta */
+
+
+/* Fa una captura i guarda el delta respecte a l'anterior. */
+static void
+take_snapshot (void)
+{
+  
+  size_t len, n;
+  uint32_t aux;
+  Z80u8 *tmp;
+  
+  
+  n= GG_save_state_compact_mem ( _snap.next );
+  if ( n == 0 ) return;
+  if ( n < _snap.next_size )
+    memset ( _snap.next + n, 0, _snap.next_size - n );
+  _snap.next_size= n;
+  
+  /* Primera captura. */
+  if ( _snap.cur_size == 0 )
+    {
+      tmp= _snap.cur; _snap.cur= _snap.next; _snap.next= tmp;
+      _snap.cur_size= n;
+      _snap.next_size= 0;
+      return;
+    }
+  
+  /* Delta per a tornar de 'next' a 'cur'. */
+  len= encode_delta ();
+  if ( len + ENTRY_OVERHEAD > _ring.size ) ring_clear ();
+  else
+    {
+      while ( (_ring.end-_ring.begin) + len + ENTRY_OVERHEAD > _ring.size )
+        ring_drop ();
+      aux= (uint32_t) len;
+      ring_write ( _ring.end, &aux, sizeof(aux) );
+      aux= (uint32_t) _snap.cur_size;
+      ring_write ( _ring.end + sizeof(aux), &aux, sizeof(aux) );
+      ring_write ( _ring.end + 2*sizeof(aux), _snap.delta, len );
+      aux= (uint32_t) len;
+      ring_write ( _ring.end + 2*sizeof(aux) + len, &aux, sizeof(aux) );
+      _ring.end+= len + ENTRY_OVERHEAD;
+      ++_ring.N;
+    }
+  tmp= _snap.cur; _snap.cur= _snap.next; _snap.next= tmp;
+  n= _snap.cur_size; _snap.cur_size= _snap.next_size; _snap.next_size= n;
+  
+} /* end take_snapshot */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_rewind_clear (void)
+{
+  
+  if ( !_enabled ) return;
+  ring_clear ();
+  memset ( _snap.cur, 0, _snap.max_size );
+  memset ( _snap.next, 0, _snap.max_size );
+  _snap.cur_size= _snap.next_size= 0;
+  _frames= 0;
+  
+} /* end GG_rewind_clear */
+
+
+void
+GG_rewind_close (void)
+{
+  
+  if ( !_enabled ) return;
+  free ( _snap.cur );
+  free ( _snap.next );
+  free ( _snap.delta );
+  free ( _ring.v );
+  _enabled= Z80_FALSE;
+  
+} /* end GG_rewind_close */
+
+
+void
+GG_rewind_frame (void)
+{
+  
+  if ( !_enabled ) return;
+  if ( ++_frames >= _interval || _snap.cur_size == 0 )
+    {
+      take_snapshot ();
+      _frames= 0;
+    }
+  
+} /* end GG_rewind_frame */
+
+
+void
+GG_rewind_get_stats (
+        	     GG_RewindStats *stats
+        	     )
+{
+  
+  if ( !_enabled )
+    {
+      memset ( stats, 0, sizeof(*stats) );
+      return;
+    }
+  stats->nsnapshots= _ring.N + (_snap.cur_size!=0);
+  stats->seconds= ((double) _ring.N*_interval*GG_CICLES_PER_FRAME) /
+    GG_CICLES_PER_SEC;
+  stats->used= (_ring.end-_ring.begin) + _snap.cur_size;
+  stats->capacity= _ring.size;
+  stats->bytes_per_sec=
+    stats->seconds>0.0 ? (_ring.end-_ring.begin)/stats->seconds : 0.0;
+  
+} /* end GG_rewind_get_stats */
+
+
+int
+GG_rewind_init (
+        	const int    interval,
+        	const size_t capacity
+        	)
+{
+  
+  GG_rewind_close ();
+  if ( interval <= 0 || capacity == 0 ) return -1;
+  _snap.max_size= GG_state_size ();
+  _snap.cur= (Z80u8 *) calloc ( _snap.max_size, 1 );
+  _snap.next= (Z80u8 *) calloc ( _snap.max_size, 1 );
+  /* Cas pitjor de la codificació. */
+  _snap.delta= (Z80u8 *) malloc ( _snap.max_size + _snap.max_size/4 + 16 );
+  _ring.v= (Z80u8 *) malloc ( capacity );
+  if ( _snap.cur == NULL || _snap.next == NULL ||
+       _snap.delta == NULL || _ring.v == NULL )
+    {
+      free ( _snap.cur );
+      free ( _snap.next );
+      free ( _snap.delta );
+      free ( _ring.v );
+      return -1;
+    }
+  _ring.size= capacity;
+  _interval= interval;
+  _enabled= Z80_TRUE;
+  GG_rewind_clear ();
+  
+  return 0;
+  
+} /* end GG_rewind_init */
+
+
+int
+GG_rewind_step (void)
+{
+  
+  uint32_t len, size;
+  size_t begin;
+  
+  
+  if ( !_enabled || _snap.cur_size == 0 ) return -1;
+  
+  /* Si encara no ha passat cap 'frame' des de l'última captura es
+     torna a l'anterior. */
+  if ( _frames == 0 )
+    {
+      if ( _ring.N == 0 ) return -1;
+      ring_read ( _ring.end - sizeof(len), &len, sizeof(len) );
+      begin= _ring.end - (len + ENTRY_OVERHEAD);
+      ring_read ( begin + sizeof(len), &size, sizeof(size) );
+      ring_read ( begin + 2*sizeof(len), _snap.delta, len );
+      apply_delta ( len );
+      if ( size < _snap.cur_size )
+        memset ( _snap.cur + size, 0, _snap.cur_size - size );
+      _snap.cur_size= size;
+      _ring.end= begin;
+      --_ring.N;
+    }
+  _frames= 0;
+  
+  return GG_load_state_mem ( _snap.cur, _snap.cur_size );
+  
+} /* end GG_rewind_step */
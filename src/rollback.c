@@ -0,0 +1,288 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  rollback.c - Implementació del mòdul ROLLBACK.
+ *
+ *  NOTES: Abans d'executar el 'frame' F es guarda l'estat en la
+ *  posició F%WINDOW. Si encara no ha arribat l'entrada remota de F
+ *  es prediu repetint l'última confirmada. Quan arriba una entrada
+ *  remota distinta a la predita per a un 'frame' ja executat, es
+ *  carrega l'estat d'eixe 'frame' i es tornen a executar (sense
+ *  dibuixar ni so) tots els posteriors. Mai es pot anar més de
+ *  WINDOW 'frames' per davant de l'última entrada confirmada.
+ *
+ *  Les entrades es guarden en buffers més grans perquè l'altre
+ *  extrem pot anar fins a WINDOW+1 'frames' per davant.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define INPUT_SLOTS (2*_window+2)
+#define ISLOT(FRAME) ((FRAME)%INPUT_SLOTS)
+#define SSLOT(FRAME) ((FRAME)%_window)
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80_Bool _enabled= Z80_FALSE;
+
+/* Configuració. */
+static int _local;     /* Jugador local (0 o 1). */
+static int _window;
+
+/* Estats. */
+static Z80u8 *_states;
+static size_t *_sizes;
+static size_t _state_size;
+
+/* Entrades. */
+static int *_local_input;
+static int *_remote_input;
+static int _last_remote;   /* Última entrada remota confirmada. */
+
+/* 'Frames'. */
+static int _frame;         /* Següent 'frame' a executar. */
+static int _confirmed;     /* Primer 'frame' sense entrada remota
+        		      confirmada. */
+static int _rollback;      /* Primer 'frame' a tornar a executar, o
+        		      -1. */
+
+/* Estadístiques. */
+static GG_RollbackStats _stats;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+run_frame (
+           const int frame
+           )
+{
+  
+  int remote;
+  
+  
+  remote= _remote_input[ISLOT(frame)];
+  if ( _local == 0 )
+    GG_control_set_input ( _local_input[ISLOT(frame)], remote );
+  else
+    GG_control_set_input ( remote, _local_input[ISLOT(frame)] );
+  _sizes[SSLOT(frame)]=
+    GG_save_state_compact_mem ( _states + SSLOT(frame)*_state_size );
+  GG_run_frame ();
+  
+} /* end run_frame */
+
+
+/* Torna a executar des de _rollback fins a _frame. */
+static void
+resimulate (void)
+{
+  
+  int f, depth;
+  Z80_Bool show, mute;
+  
+  
+  depth= _frame - _rollback;
+  GG_mem_begin_speculative ();
+  if ( GG_load_state_mem ( _states + SSLOT(_rollback)*_state_size,
+        		   _sizes[SSLOT(_rollback)] ) != 0 )
+    {
+      GG_mem_end_speculative ();
+      _rollback= -1;
+      return;
+    }
+  show= GG_get_show_frame ();
+  mute= GG_psg_get_mute ();
+  GG_set_show_frame ( Z80_FALSE );
+  GG_psg_set_mute ( Z80_TRUE );
+  for ( f= _rollback; f < _frame; ++f )
+    {
+      /* Millor predicció amb la nova informació. */
+      if ( f >= _confirmed )
+        _remote_input[ISLOT(f)]= _last_remote;
+      run_frame ( f );
+    }
+  GG_mem_end_speculative ();
+  GG_psg_set_mute ( mute );
+  GG_set_show_frame ( show );
+  _rollback= -1;
+  
+  ++_stats.rollbacks;
+  _stats.resimulated+= depth;
+  if ( depth > _stats.max_depth ) _stats.max_depth= depth;
+  
+} /* end resimulate */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+int
+GG_rollback_add_remote_input (
+        		      const int frame,
+        		      const int buttons
+        		      )
+{
+  
+  if ( !_enabled || frame != _confirmed ||
+       frame > _frame + _window + 1 ) return -1;
+  if ( frame < _frame && buttons != _remote_input[ISLOT(frame)] &&
+       (_rollback == -1 || frame < _rollback) )
+    _rollback= frame;
+  _remote_input[ISLOT(frame)]= buttons;
+  _last_remote= buttons;
+  ++_confirmed;
+  
+  return 0;
+  
+} /* end GG_rollback_add_remote_input */
+
+
+int
+GG_rollback_advance (
+        	     const int buttons
+        	     )
+{
+  
+  int frame;
+  
+  
+  if ( !_enabled || _frame - _confirmed >= _window ) return -1;
+  if ( _rollback != -1 ) resimulate ();
+  frame= _frame;
+  _local_input[ISLOT(frame)]= buttons;
+  if ( frame >= _confirmed )
+    _remote_input[ISLOT(frame)]= _last_remote;
+  run_frame ( frame );
+  ++_frame;
+  ++_stats.frames;
+  
+  return frame;
+  
+} /* end GG_rollback_advance */
+
+
+void
+GG_rollback_close (void)
+{
+  
+  if ( !_enabled ) return;
+  free ( _states );
+  free ( _sizes );
+  free ( _local_input );
+  free ( _remote_input );
+  GG_control_release_input ();
+  _enabled= Z80_FALSE;
+  
+} /* end GG_rollback_close */
+
+
+int
+GG_rollback_get_confirmed (void)
+{
+  return _confirmed;
+} /* end GG_rollback_get_confirmed */
+
+
+int
+GG_rollback_get_frame (void)
+{
+  return _frame;
+} /* end GG_rollback_get_frame */
+
+
+void
+GG_rollback_get_stats (
+        	       GG_RollbackStats *stats
+        	       )
+{
+  *stats= _stats;
+} /* end GG_rollback_get_stats */
+
+
+int
+GG_rollback_init (
+        	  const int local_player,
+        	  const int window
+        	  )
+{
+  
+  GG_rollback_close ();
+  if ( (local_player != 0 && local_player != 1) || window <= 0 )
+    return -1;
+  _state_size= GG_state_size ();
+  _states= (Z80u8 *) malloc ( _state_size*window );
+  _sizes= (size_t *) calloc ( window, sizeof(size_t) );
+  _local_input= (int *) calloc ( 2*window+2, sizeof(int) );
+  _remote_input= (int *) calloc ( 2*window+2, sizeof(int) );
+  if ( _states == NULL || _sizes == NULL ||
+       _local_input == NULL || _remote_input == NULL )
+    {
+      free ( _states );
+      free ( _sizes );
+      free ( _local_input );
+      free ( _remote_input );
+      return -1;
+    }
+  _local= local_player;
+  _window= window;
+  _last_remote= 0;
+  _frame= 0;
+  _confirmed= 0;
+  _rollback= -1;
+  memset ( &_stats, 0, sizeof(_stats) );
+  _enabled= Z80_TRUE;
+  
+  return 0;
+  
+} /* end GG_rollback_init */
+
+
+void
+GG_rollback_sync (void)
+{
+  
+  if ( _enabled && _rollback != -1 ) resimulate ();
+  
+} /* end GG_rollback_sync */
@@ -23,6 +23,7 @@
 
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -31,10 +32,41 @@
 
 
 
+/*********/
+/* ESTAT */
+/*********/
+
+/* Taula del CRC-32. Es calcula la primera vegada. */
+static uint32_t _crc_table[256];
+static Z80_Bool _crc_table_ready= Z80_FALSE;
+
+
+
+
 /*********************/
 /* FUNCIONS PRIVADES */
 /*********************/
 
+static void
+init_crc_table (void)
+{
+  
+  uint32_t c;
+  int i, j;
+  
+  
+  for ( i= 0; i < 256; ++i )
+    {
+      c= (uint32_t) i;
+      for ( j= 0; j < 8; ++j )
+        c= (c&1) ? (0xEDB88320u^(c>>1)) : (c>>1);
+      _crc_table[i]= c;
+    }
+  _crc_table_ready= Z80_TRUE;
+  
+} /* end init_crc_table */
+
+
 static int
 get_region (
             const unsigned char code
@@ -107,6 +139,28 @@ search_rom_header (
 /* FUNCIONS PÚBLIQUES */
 /**********************/
 
+uint32_t
+GG_rom_crc32 (
+              const GG_Rom *rom
+              )
+{
+  
+  const Z80u8 *p, *end;
+  uint32_t crc;
+  
+  
+  if ( !_crc_table_ready ) init_crc_table ();
+  p= (const Z80u8 *) rom->banks;
+  end= p + (size_t) rom->nbanks*GG_BANK_SIZE;
+  crc= 0xFFFFFFFFu;
+  for ( ; p != end; ++p )
+    crc= _crc_table[(crc^*p)&0xFF] ^ (crc>>8);
+  
+  return crc^0xFFFFFFFFu;
+  
+} /* end GG_rom_crc32 */
+
+
 int
 GG_rom_get_header (
         	   const GG_Rom *rom,
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  runahead.c - Implementació del mòdul RUNAHEAD.
+ *
+ *  NOTES: La línia de temps real s'executa amb el so però sense
+ *  dibuixar. Al final de cada 'frame' es guarda l'estat, s'executen
+ *  N 'frames' més sense so (sols es dibuixa l'últim, que és el que
+ *  veu l'usuari) i es torna a carregar l'estat. D'aquesta manera
+ *  l'efecte de l'entrada es veu N 'frames' abans.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* Pes de les noves mesures en les mitjanes exponencials. */
+static const double ALPHA= 0.05;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80_Bool _enabled= Z80_FALSE;
+static int _nframes;
+
+/* Estat guardat abans d'avançar. */
+static Z80u8 *_state;
+
+/* Estadístiques. */
+static struct
+{
+  
+  unsigned long frames;
+  double        cpu;          /* Mitjana per 'frame' mostrat. */
+  double        runahead;     /* Part de 'cpu' emprada en avançar. */
+  double        last;         /* Temps de UCP al final de l'últim
+        			 'frame'. */
+  Z80_Bool      started;
+  
+} _stats;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static double
+get_cpu_time (void)
+{
+  
+  struct timespec ts;
+  
+  
+  clock_gettime ( CLOCK_THREAD_CPUTIME_ID, &ts );
+  
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+  
+} /* end get_cpu_time */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_runahead_close (void)
+{
+  
+  if ( !_enabled ) return;
+  free ( _state );
+  _enabled= Z80_FALSE;
+  GG_set_show_frame ( Z80_TRUE );
+  
+} /* end GG_runahead_close */
+
+
+int
+GG_runahead_frame (void)
+{
+  
+  size_t size;
+  double t0, t1;
+  int i;
+  Z80_Bool mute;
+  
+  
+  if ( !_enabled ) return 0;
+  
+  t0= get_cpu_time ();
+  size= GG_save_state_compact_mem ( _state );
+  if ( size == 0 ) return 0;
+  GG_mem_begin_speculative ();
+  mute= GG_psg_get_mute ();
+  GG_psg_set_mute ( Z80_TRUE );
+  for ( i= 1; i <= _nframes; ++i )
+    {
+      GG_set_show_frame ( i == _nframes );
+      GG_run_frame ();
+    }
+  GG_set_show_frame ( Z80_FALSE );
+  if ( GG_load_state_mem ( _state, size ) != 0 )
+    {
+      GG_mem_end_speculative ();
+      GG_psg_set_mute ( mute );
+      GG_runahead_close ();
+      return -1;
+    }
+  GG_mem_end_speculative ();
+  GG_psg_set_mute ( mute );
+  t1= get_cpu_time ();
+  
+  /* Estadístiques. */
+  if ( _stats.started )
+    {
+      _stats.cpu+= ALPHA*((t1-_stats.last) - _stats.cpu);
+      _stats.runahead+= ALPHA*((t1-t0) - _stats.runahead);
+    }
+  else
+    {
+      _stats.started= Z80_TRUE;
+      _stats.cpu= _stats.runahead= t1-t0;
+    }
+  _stats.last= t1;
+  ++_stats.frames;
+  
+  return 0;
+  
+} /* end GG_runahead_frame */
+
+
+void
+GG_runahead_get_stats (
+        	       GG_RunaheadStats *stats
+        	       )
+{
+  
+  stats->nframes= _enabled ? _nframes : 0;
+  stats->frames= _stats.frames;
+  stats->cpu= _stats.cpu;
+  stats->runahead= _stats.runahead;
+  
+} /* end GG_runahead_get_stats */
+
+
+int
+GG_runahead_init (
+        	  const int nframes
+        	  )
+{
+  
+  GG_runahead_close ();
+  if ( nframes == 0 ) return 0;
+  if ( nframes < 0 ) return -1;
+  _state= (Z80u8 *) malloc ( GG_state_size () );
+  if ( _state == NULL ) return -1;
+  _nframes= nframes;
+  memset ( &_stats, 0, sizeof(_stats) );
+  _enabled= Z80_TRUE;
+  GG_set_show_frame ( Z80_FALSE );
+  
+  return 0;
+  
+} /* end GG_runahead_init */
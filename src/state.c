@@ -0,0 +1,234 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  state.c - Implementació del mòdul STATE.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+int
+GG_state_index (
+        	const Z80u8    *buf,
+        	const size_t    size,
+        	GG_StateChunks *chunks
+        	)
+{
+  
+  const Z80u8 *p, *end;
+  uint32_t id, csize;
+  
+  
+  if ( size < GG_STATE_HEADER_SIZE ||
+       memcmp ( buf, GG_STATE_MAGIC, 8 ) ) return -1;
+  p= GG_state_get_u32 ( buf+8, buf+size, &(chunks->version) );
+  p= GG_state_get_u32 ( p, buf+size, &csize );
+  if ( chunks->version == 0 || chunks->version > GG_STATE_VERSION ||
+       csize > size-GG_STATE_HEADER_SIZE ) return -1;
+  end= p + csize;
+  chunks->N= 0;
+  while ( p != end )
+    {
+      if ( (p= GG_state_get_u32 ( p, end, &id )) == NULL ) return -1;
+      if ( (p= GG_state_get_u32 ( p, end, &csize )) == NULL ) return -1;
+      if ( csize > (size_t) (end-p) ) return -1;
+      if ( chunks->N == GG_STATE_MAX_CHUNKS ) return -1;
+      chunks->v[chunks->N].id= id;
+      chunks->v[chunks->N].size= csize;
+      chunks->v[chunks->N].data= p;
+      ++(chunks->N);
+      p+= csize;
+    }
+  
+  return 0;
+  
+} /* end GG_state_index */
+
+
+const Z80u8 *
+GG_state_get_chunk (
+        	    const GG_StateChunks *chunks,
+        	    const uint32_t        id,
+        	    size_t               *size
+        	    )
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < chunks->N; ++i )
+    if ( chunks->v[i].id == id )
+      {
+        if ( size != NULL ) *size= chunks->v[i].size;
+        return chunks->v[i].data;
+      }
+  
+  return NULL;
+  
+} /* end GG_state_get_chunk */
+
+
+Z80u8 *
+GG_state_begin (
+        	Z80u8 *buf
+        	)
+{
+  
+  memcpy ( buf, GG_STATE_MAGIC, 8 );
+  GG_state_put_u32 ( buf+8, GG_STATE_VERSION );
+  
+  return buf + GG_STATE_HEADER_SIZE;
+  
+} /* end GG_state_begin */
+
+
+size_t
+GG_state_end (
+              Z80u8       *buf,
+              const Z80u8 *end
+              )
+{
+  
+  GG_state_put_u32 ( buf+12, (uint32_t) (end-buf-GG_STATE_HEADER_SIZE) );
+  
+  return (size_t) (end-buf);
+  
+} /* end GG_state_end */
+
+
+Z80u8 *
+GG_state_begin_chunk (
+        	      Z80u8          *buf,
+        	      const uint32_t  id
+        	      )
+{
+  
+  buf= GG_state_put_u32 ( buf, id );
+  
+  return GG_state_put_u32 ( buf, 0 );
+  
+} /* end GG_state_begin_chunk */
+
+
+Z80u8 *
+GG_state_end_chunk (
+        	    Z80u8 *data,
+        	    Z80u8 *end
+        	    )
+{
+  
+  GG_state_put_u32 ( data-4, (uint32_t) (end-data) );
+  
+  return end;
+  
+} /* end GG_state_end_chunk */
+
+
+Z80u8 *
+GG_state_put_u16 (
+        	  Z80u8        *buf,
+        	  const Z80u16  val
+        	  )
+{
+  
+  buf[0]= (Z80u8) val;
+  buf[1]= (Z80u8) (val>>8);
+  
+  return buf+2;
+  
+} /* end GG_state_put_u16 */
+
+
+Z80u8 *
+GG_state_put_u32 (
+        	  Z80u8          *buf,
+        	  const uint32_t  val
+        	  )
+{
+  
+  buf[0]= (Z80u8) val;
+  buf[1]= (Z80u8) (val>>8);
+  buf[2]= (Z80u8) (val>>16);
+  buf[3]= (Z80u8) (val>>24);
+  
+  return buf+4;
+  
+} /* end GG_state_put_u32 */
+
+
+const Z80u8 *
+GG_state_get_u8 (
+        	 const Z80u8 *buf,
+        	 const Z80u8 *end,
+        	 Z80u8       *val
+        	 )
+{
+  
+  if ( buf == NULL || end-buf < 1 ) return NULL;
+  *val= buf[0];
+  
+  return buf+1;
+  
+} /* end GG_state_get_u8 */
+
+
+const Z80u8 *
+GG_state_get_u16 (
+        	  const Z80u8 *buf,
+        	  const Z80u8 *end,
+        	  Z80u16      *val
+        	  )
+{
+  
+  if ( buf == NULL || end-buf < 2 ) return NULL;
+  *val= (Z80u16) (buf[0] | (buf[1]<<8));
+  
+  return buf+2;
+  
+} /* end GG_state_get_u16 */
+
+
+const Z80u8 *
+GG_state_get_u32 (
+        	  const Z80u8 *buf,
+        	  const Z80u8 *end,
+        	  uint32_t    *val
+        	  )
+{
+  
+  if ( buf == NULL || end-buf < 4 ) return NULL;
+  *val= ((uint32_t) buf[0]) | (((uint32_t) buf[1])<<8) |
+    (((uint32_t) buf[2])<<16) | (((uint32_t) buf[3])<<24);
+  
+  return buf+4;
+  
+} /* end GG_state_get_u32 */
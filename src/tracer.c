@@ -0,0 +1,255 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  tracer.c - Implementació del mòdul TRACER.
+ *
+ *  NOTES: El comptador de registres de la capçalera s'incrementa
+ *  després d'escriure el registre, per tant un lector en un altre
+ *  procés sols veu registres complets (excepte si el buffer ha donat
+ *  la volta mentre llegia).
+ *
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "GG.h"
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Buffer. */
+static GG_TracerHeader *_hdr= NULL;
+static GG_TraceRecord *_records;
+static size_t _map_size;
+static uint64_t _mask;
+
+/* Registre actual, NULL fora d'un pas. */
+static GG_TraceRecord *_rec= NULL;
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_tracer_access (
+        	  const GG_MemAccessType type,
+        	  const Z80u16           addr,
+        	  const Z80u8            data
+        	  )
+{
+  
+  GG_TraceAccess *acc;
+  
+  
+  if ( _rec == NULL ) return;
+  if ( _rec->nacc == GG_TRACER_NACC )
+    {
+      _rec->flags|= GG_TRACER_ACC_LOST;
+      return;
+    }
+  acc= &(_rec->acc[_rec->nacc++]);
+  acc->addr= addr;
+  acc->data= data;
+  acc->type= (Z80u8) type;
+  
+} /* end GG_tracer_access */
+
+
+void
+GG_tracer_begin (
+        	 const Z80_Step *step,
+        	 const Z80u16    nextaddr
+        	 )
+{
+  
+  GG_TraceRecord *rec;
+  int bank, n;
+  
+  
+  if ( _hdr == NULL ) return;
+  rec= &(_records[_hdr->count&_mask]);
+  memset ( rec, 0, sizeof(GG_TraceRecord) );
+  rec->type= (Z80u8) step->type;
+  if ( step->type == Z80_STEP_INST )
+    {
+      n= step->val.inst.nbytes;
+      rec->pc= (Z80u16) (nextaddr-n);
+      rec->nbytes= (Z80u8) n;
+      memcpy ( rec->bytes, step->val.inst.bytes, n );
+    }
+  else
+    {
+      rec->pc= nextaddr;
+      if ( step->type == Z80_STEP_IRQ ) rec->bytes[0]= step->val.bus;
+    }
+  bank= GG_mem_get_bank ( rec->pc );
+  rec->bank= bank == -1 ? 0xFF : (Z80u8) bank;
+  _rec= rec;
+  
+} /* end GG_tracer_begin */
+
+
+void
+GG_tracer_close (void)
+{
+  
+  if ( _hdr == NULL ) return;
+  munmap ( _hdr, _map_size );
+  _hdr= NULL;
+  _rec= NULL;
+  
+} /* end GG_tracer_close */
+
+
+void
+GG_tracer_end (
+               const int cc
+               )
+{
+  
+  if ( _rec == NULL ) return;
+  _rec->cc= cc > 0xFF ? 0xFF : (Z80u8) cc;
+  _rec= NULL;
+  ++(_hdr->count);
+  
+} /* end GG_tracer_end */
+
+
+void
+GG_tracer_get_stats (
+        	     GG_TracerStats *stats
+        	     )
+{
+  
+  if ( _hdr == NULL )
+    {
+      memset ( stats, 0, sizeof(GG_TracerStats) );
+      return;
+    }
+  stats->capacity= _hdr->capacity;
+  stats->count= _hdr->count;
+  stats->lost= _hdr->count > _hdr->capacity ?
+    _hdr->count-_hdr->capacity : 0;
+  
+} /* end GG_tracer_get_stats */
+
+
+Z80_Bool
+GG_tracer_is_open (void)
+{
+  return _hdr != NULL;
+} /* end GG_tracer_is_open */
+
+
+int
+GG_tracer_open (
+        	const size_t  nrecords,
+        	const char   *fname
+        	)
+{
+  
+  void *mem;
+  uint64_t cap;
+  size_t size;
+  int fd;
+  
+  
+  GG_tracer_close ();
+  for ( cap= 1; cap < nrecords; cap<<= 1 );
+  size= sizeof(GG_TracerHeader) + cap*sizeof(GG_TraceRecord);
+  if ( fname == NULL )
+    mem= mmap ( NULL, size, PROT_READ|PROT_WRITE,
+        	MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+  else
+    {
+      fd= open ( fname, O_RDWR|O_CREAT|O_TRUNC, 0644 );
+      if ( fd == -1 ) return -1;
+      if ( ftruncate ( fd, (off_t) size ) == -1 )
+        {
+          close ( fd );
+          return -1;
+        }
+      mem= mmap ( NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0 );
+      close ( fd );
+    }
+  if ( mem == MAP_FAILED ) return -1;
+  
+  _hdr= (GG_TracerHeader *) mem;
+  memset ( _hdr, 0, sizeof(GG_TracerHeader) );
+  memcpy ( _hdr->magic, GG_TRACER_MAGIC, sizeof(GG_TRACER_MAGIC) );
+  _hdr->version= GG_TRACER_VERSION;
+  _hdr->record_size= sizeof(GG_TraceRecord);
+  _hdr->capacity= cap;
+  _records= (GG_TraceRecord *) (_hdr+1);
+  _map_size= size;
+  _mask= cap-1;
+  _rec= NULL;
+  
+  return 0;
+  
+} /* end GG_tracer_open */
+
+
+size_t
+GG_tracer_read (
+        	uint64_t       *pos,
+        	GG_TraceRecord *out,
+        	const size_t    n
+        	)
+{
+  
+  uint64_t count, first, avail;
+  size_t ret, i, m;
+  
+  
+  if ( _hdr == NULL ) return 0;
+  count= _hdr->count;
+  first= count > _hdr->capacity ? count-_hdr->capacity : 0;
+  if ( *pos < first ) *pos= first;
+  avail= *pos < count ? count-*pos : 0;
+  ret= avail < n ? (size_t) avail : n;
+  
+  /* Com a molt dos trossos. */
+  for ( i= 0; i < ret; i+= m )
+    {
+      m= (size_t) (_hdr->capacity - ((*pos+i)&_mask));
+      if ( m > ret-i ) m= ret-i;
+      memcpy ( out+i, &(_records[(*pos+i)&_mask]),
+               m*sizeof(GG_TraceRecord) );
+    }
+  *pos+= ret;
+  
+  return ret;
+  
+} /* end GG_tracer_read */
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  turbo.c - Implementació del mòdul TURBO.
+ *
+ *  NOTES: La velocitat es limita amb un termini per 'frame' (com en
+ *  PACING però dividint el període per la velocitat), i la velocitat
+ *  aconseguida es mesura en finestres de WINDOW segons.
+ *
+ */
+
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* Segons que dura un 'frame' a velocitat real. */
+static const double FRAME_TIME=
+  GG_CICLES_PER_FRAME / (double) GG_CICLES_PER_SEC;
+
+/* Segons de cada mesura de la velocitat aconseguida. */
+static const double WINDOW= 0.5;
+
+/* Si es va més endarrere que açò (en segons) es torna a sincronitzar
+   en compte d'intentar recuperar. */
+static const double MAX_LAG= 0.1;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80_Bool _enabled= Z80_FALSE;
+static int _nth;
+static int _count;
+static Z80_Bool _show;      /* Es mostra l'actual 'frame'. */
+
+/* Limitació de la velocitat. */
+static double _period;      /* Segons per 'frame', 0 sense límit. */
+static double _deadline;    /* Instant en què acaba l'actual 'frame'. */
+
+/* Mesura de la velocitat. */
+static struct
+{
+  
+  double begin;
+  int    frames;
+  
+} _window;
+
+static GG_TurboStats _stats;
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+GG_turbo_disable (void)
+{
+  
+  GG_RunaheadStats runahead;
+  
+  
+  if ( !_enabled ) return;
+  _enabled= Z80_FALSE;
+  GG_psg_set_fast ( Z80_FALSE );
+  GG_runahead_get_stats ( &runahead );
+  GG_set_show_frame ( runahead.nframes == 0 );
+  
+} /* end GG_turbo_disable */
+
+
+int
+GG_turbo_enable (
+        	 const double speed,
+        	 const int    nth
+        	 )
+{
+  
+  if ( speed < 0.0 || nth < 1 ) return -1;
+  _period= speed == GG_TURBO_MAX ? 0.0 : FRAME_TIME/speed;
+  _nth= nth;
+  if ( !_enabled )
+    {
+      _enabled= Z80_TRUE;
+      _count= 1;
+      memset ( &_stats, 0, sizeof(_stats) );
+      _window.begin= _deadline= GG_clock_get ();
+      _window.frames= 0;
+      _show= nth == 1;
+      GG_psg_set_fast ( Z80_TRUE );
+      GG_set_show_frame ( _show );
+    }
+  
+  return 0;
+  
+} /* end GG_turbo_enable */
+
+
+void
+GG_turbo_frame (void)
+{
+  
+  double now;
+  
+  
+  if ( !_enabled ) return;
+  
+  /* Límit. */
+  now= GG_clock_get ();
+  if ( _period > 0.0 )
+    {
+      _deadline+= _period;
+      if ( now < _deadline )
+        {
+          GG_clock_sleep_until ( _deadline );
+          now= GG_clock_get ();
+        }
+      else if ( now - _deadline > MAX_LAG ) _deadline= now;
+    }
+  
+  /* Estadístiques. */
+  ++_stats.frames;
+  ++_window.frames;
+  if ( now - _window.begin >= WINDOW )
+    {
+      _stats.speed= _window.frames*FRAME_TIME / (now - _window.begin);
+      _window.begin= now;
+      _window.frames= 0;
+    }
+  
+  /* Sols es mostra un de cada _nth. */
+  if ( _show ) ++_stats.shown;
+  _show= (++_count >= _nth);
+  if ( _show ) _count= 0;
+  GG_set_show_frame ( _show );
+  
+} /* end GG_turbo_frame */
+
+
+void
+GG_turbo_get_stats (
+        	    GG_TurboStats *stats
+        	    )
+{
+  *stats= _stats;
+} /* end GG_turbo_get_stats */
+
+
+Z80_Bool
+GG_turbo_is_enabled (void)
+{
+  return _enabled;
+} /* end GG_turbo_is_enabled */
@@ -49,6 +49,7 @@
 
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -71,6 +72,22 @@
 #define CHECK(COND)        			\
   if ( !(COND) ) return -1;
 
+/* Format portable (veure STATE). */
+#define PUT_U8(VAL) *(buf++)= (Z80u8) (VAL)
+
+#define PUT_U16(VAL) buf= GG_state_put_u16 ( buf, (Z80u16) (VAL) )
+
+#define PUT_I32(VAL) buf= GG_state_put_u32 ( buf, (uint32_t) (VAL) )
+
+#define GET_U8(VAR)        						\
+  p= GG_state_get_u8 ( p, end, &u8 ); (VAR)= u8
+
+#define GET_U16(VAR)        						\
+  p= GG_state_get_u16 ( p, end, &u16 ); (VAR)= u16
+
+#define GET_I32(VAR)        						\
+  p= GG_state_get_u32 ( p, end, &u32 ); (VAR)= (int32_t) u32
+
 #define FFLAG 0x80
 #define S9FLAG 0x40
 #define CFLAG 0x20
@@ -181,6 +198,15 @@
 static Z80u8 _vram[16384 /*16K*/];
 static Z80u8 _cram[64 /*32 words*/];
 
+/* Resum incremental de la VRAM i la CRAM. */
+static GG_Hash _mem_hash;
+
+/* Cal tornar a calcular el resum (després de carregar l'estat). */
+static Z80_Bool _hash_dirty;
+
+/* Pàgines compartides amb les bifurcacions (veure BRANCH). */
+static GG_Page *_vram_pages[GG_VRAM_PAGES];
+
 
 /* Registre d'estat. */
 static Z80u8 _status;
@@ -332,6 +358,16 @@ static struct
 } _spr_buffer;
 
 
+/* Si està actiu no es dibuixen els píxels, sols el necessari per a
+   calcular els flags. No forma part de l'estat. */
+static Z80_Bool _frame_skip;
+
+
+/* Comprova els 'watchpoints' de VRAM (veure GG_vdp_set_watch). No
+   forma part de l'estat. */
+static Z80_Bool _watch;
+
+
 /* Dades de l'usari. */
 static GG_UpdateScreen *_update_screen;
 static void *_udata;
@@ -431,6 +467,7 @@ sat_evaluation (
   Z80u8 y;
   
   
+  GG_PERF_BEGIN ( GG_PERF_SAT );
   _spr_buffer.N= 0;
   _spr_buffer.SIZE= _regs.SIZE;
   _spr_buffer.DSIZE= _regs.DSIZE;
@@ -452,6 +489,7 @@ sat_evaluation (
           ++_spr_buffer.N;
         }
     }
+  GG_PERF_END ( GG_PERF_SAT );
   
 } /* end sat_evaluation */
 
@@ -532,7 +570,14 @@ render_line (void)
   int x, color, color_bg, color_spr, aux, i;
   
   
-  if ( _regs.BLANK )
+  GG_PERF_BEGIN ( GG_PERF_RENDER );
+  if ( _frame_skip )
+    {
+      /* Els sprites es necessiten per al flag de col·lisió. */
+      if ( !_regs.BLANK ) render_line_spr ();
+      _render.p+= 160;
+    }
+  else if ( _regs.BLANK )
     {
       color= ((int) _regs.ob_color|0x10)<<1;
       aux= (_cram[color] | (((int) _cram[color|0x1])<<8))&0xFFF;
@@ -558,6 +603,7 @@ render_line (void)
             (_cram[color] | (((int) _cram[color|0x1])<<8))&0xFFF;
         }
     }
+  GG_PERF_END ( GG_PERF_RENDER );
   sat_evaluation ( _render.lines );
   ++_render.lines;
   _regs.BLANK= _regs.BLANKl;
@@ -1010,7 +1056,7 @@ clock (void)
   
   int newH, newV;
   
-
+  
   /* NOTA:
    * Count = 4/3CC
    * En _timing.cc tinc guardat els 1/3CC.
@@ -1047,16 +1093,162 @@ clock (void)
         _timing.cctoFInt=
           4*((191-_timing.V)*COUNTSPERLINE + COUNTSTOILINE - _timing.H);
     }
-
+  
 } /* end clock */
 
 
 
+/* Torna a calcular el resum sencer de la VRAM i la CRAM. */
+static void
+rehash (void)
+{
+  
+  _mem_hash= GG_hash_area ( _vram, sizeof(_vram), GG_HASH_VRAM ) ^
+    GG_hash_area ( _cram, sizeof(_cram), GG_HASH_CRAM );
+  _hash_dirty= Z80_FALSE;
+  
+} /* end rehash */
+
+
+/* Comprova que l'estat acabat de carregar és coherent. */
+static int
+check_state (void)
+{
+  
+  int n;
+  
+  
+  CHECK ( (_addr&0x3FFF) == _addr );
+  CHECK ( (_regs.nt_addr&0x3800) == _regs.nt_addr );
+  CHECK ( (_regs.sat_addr&0x3F00) == _regs.sat_addr );
+  CHECK ( (_regs.spg_addr&0x2000) == _regs.spg_addr );
+  CHECK ( (_regs.ob_color&0xF) == _regs.ob_color );
+  CHECK ( (_regs.col&0x1F) == _regs.col );
+  CHECK ( (_regs.coll&0x1F) == _regs.coll );
+  CHECK ( (_regs.fx&0x7) == _regs.fx );
+  CHECK ( (_regs.fxl&0x7) == _regs.fxl );
+  CHECK ( (_regs.row&0x1F) == _regs.row );
+  CHECK ( (_regs.row_tmp&0x1F) == _regs.row_tmp );
+  CHECK ( (_regs.fy&0x7) == _regs.fy );
+  CHECK ( (_regs.fy_tmp&0x7) == _regs.fy_tmp );
+  CHECK ( _regs.line_counter >= 0 );
+  CHECK ( _timing.H < COUNTSPERLINE );
+  CHECK ( _timing.V < 262 );
+  CHECK ( _timing.cc >= 0 );
+  CHECK ( _line_int_counter >= 0 );
+  CHECK ( ((&(_render.fb[0])) - _render.p) <= 160*144 );
+  CHECK ( (&(_render.fb[0]) + (_render.lines-24)*160) == _render.p );
+  CHECK ( _spr_buffer.N < NUM_SPRITES );
+  for ( n= 0; n < _spr_buffer.N; ++n )
+    {
+      CHECK ( _spr_buffer.v[n].ind >= 0 && _spr_buffer.v[n].ind < 64 );
+      if ( _regs.DSIZE )
+        {
+          CHECK ( (_spr_buffer.v[n].baddr&0x3FE)==_spr_buffer.v[n].baddr );
+        }
+      else
+        {
+          CHECK ( (_spr_buffer.v[n].baddr&0x7FC)==_spr_buffer.v[n].baddr );
+        }
+    }
+  
+  return 0;
+  
+} /* end check_state */
+
+
+static int
+check_fb (void)
+{
+  
+  int n;
+  
+  
+  for ( n= 0; n < 160*144; ++n )
+    if ( _render.fb[n] < 0 || _render.fb[n] > 4095 )
+      return -1;
+  
+  return 0;
+  
+} /* end check_fb */
+
+
+/* Píxels del 'frame' actual ja renderitzats però que encara no s'han
+ * passat al 'frontend'.
+ */
+static int
+get_pending_pixels (void)
+{
+  return (_render.lines>=24 && _render.lines<168) ?
+    (_render.lines-24)*160 : 0;
+} /* end get_pending_pixels */
+
+
+
 
 /**********************/
 /* FUNCIONS PÚBLIQUES */
 /**********************/
 
+void
+GG_vdp_branch_load (
+        	    GG_Page *const vram[GG_VRAM_PAGES]
+        	    )
+{
+  
+  GG_page_restore ( _vram_pages, _vram, GG_VRAM_PAGES, vram );
+  _hash_dirty= Z80_TRUE;
+  
+} /* end GG_vdp_branch_load */
+
+
+int
+GG_vdp_branch_save (
+        	    GG_Page *vram[GG_VRAM_PAGES]
+        	    )
+{
+  return GG_page_share ( _vram_pages, _vram, GG_VRAM_PAGES, vram );
+} /* end GG_vdp_branch_save */
+
+
+int
+GG_vdp_cc_to_event (
+        	    const Z80_Bool line
+        	    )
+{
+  
+  int ret, aux, pos;
+  
+  
+  /* En 1/3CC des de l'últim clock. */
+  ret= _timing.cctoFInt;
+  if ( !_line_int_pending_flag && _timing.cctoLInt < ret )
+    ret= _timing.cctoLInt;
+  ret-= _timing.cc;
+  
+  /* Posició actual, que pot estar més enllà de V i H perquè sols
+     s'actualitzen en clock. Cal parar al començament de la línia 168,
+     que és on es mostra la pantalla. */
+  pos= 4*(_timing.V*COUNTSPERLINE + _timing.H) + _timing.cc;
+  aux= 4*168*COUNTSPERLINE - pos;
+  while ( aux <= 0 ) aux+= 4*262*COUNTSPERLINE;
+  if ( aux < ret ) ret= aux;
+  if ( line )
+    {
+      /* Dins de la línia el comptador V canvia en COUNTSTOILINE i els
+         flags d'estat en COUNTSTORENDERLINE. */
+      pos%= 4*COUNTSPERLINE;
+      if ( pos < 4*COUNTSTORENDERLINE )  aux= 4*COUNTSTORENDERLINE - pos;
+      else if ( pos < 4*COUNTSTOILINE )  aux= 4*COUNTSTOILINE - pos;
+      else                               aux= 4*COUNTSPERLINE - pos;
+      if ( aux < ret ) ret= aux;
+    }
+  
+  return ret > 0 ? (ret-1)/3 : 0;
+  
+} /* end GG_vdp_cc_to_event */
+
+
 void
 GG_vdp_clock (
               const int cc
@@ -1175,6 +1367,47 @@ GG_vdp_get_cram (void)
 } /* end GG_vdp_get_cram */
 
 
+GG_Hash
+GG_vdp_get_hash (void)
+{
+  
+  GG_Hash hash;
+  int i;
+  
+  
+  if ( _hash_dirty ) rehash ();
+  hash= _mem_hash;
+  hash= GG_hash_bytes ( hash, &_status, sizeof(_status) );
+  hash= GG_hash_bytes ( hash, &_control_flag, sizeof(_control_flag) );
+  hash= GG_hash_bytes ( hash, &_addr, sizeof(_addr) );
+  hash= GG_hash_bytes ( hash, &_aux_byte, sizeof(_aux_byte) );
+  hash= GG_hash_bytes ( hash, &_code, sizeof(_code) );
+  hash= GG_hash_bytes ( hash, &_buffer, sizeof(_buffer) );
+  hash= GG_hash_bytes ( hash, &_cram_latch, sizeof(_cram_latch) );
+  hash= GG_hash_bytes ( hash, &_H, sizeof(_H) );
+  hash= GG_hash_bytes ( hash, &_line_int_pending_flag,
+        		sizeof(_line_int_pending_flag) );
+  hash= GG_hash_bytes ( hash, &_regs, sizeof(_regs) );
+  hash= GG_hash_bytes ( hash, &_timing, sizeof(_timing) );
+  hash= GG_hash_bytes ( hash, &_line_int_counter,
+        		sizeof(_line_int_counter) );
+  hash= GG_hash_bytes ( hash, &_spr_buffer.N, sizeof(_spr_buffer.N) );
+  hash= GG_hash_bytes ( hash, &_spr_buffer.SIZE, sizeof(_spr_buffer.SIZE) );
+  hash= GG_hash_bytes ( hash, &_spr_buffer.DSIZE,
+        		sizeof(_spr_buffer.DSIZE) );
+  for ( i= 0; i < _spr_buffer.N; ++i )
+    {
+      hash= GG_hash_bytes ( hash, &_spr_buffer.v[i].ind,
+        		    sizeof(_spr_buffer.v[i].ind) );
+      hash= GG_hash_bytes ( hash, &_spr_buffer.v[i].baddr,
+        		    sizeof(_spr_buffer.v[i].baddr) );
+    }
+  
+  return hash;
+  
+} /* end GG_vdp_get_hash */
+
+
 void
 GG_vdp_get_vram (
         	 GG_VRAMState *state
@@ -1236,10 +1469,11 @@ GG_vdp_init (
              void            *udata
              )
 {
-
+  
   GG_vdp_init_state ();
   _update_screen= update_screen;
   _udata= udata;
+  _frame_skip= Z80_FALSE;
   
 } /* end GG_vdp_init */
 
@@ -1250,6 +1484,8 @@ GG_vdp_init_state (void)
   
   memset ( _vram, 0, 16384 );
   memset ( _cram, 0, 64 );
+  GG_page_release ( _vram_pages, GG_VRAM_PAGES );
+  _hash_dirty= Z80_TRUE;
   _status= 0x00;
   _control_flag= Z80_FALSE;
   _addr= 0x0000;
@@ -1323,6 +1559,7 @@ GG_vdp_read_data (void)
   
   ret= _buffer;
   _buffer= _vram[_addr];
+  if ( _watch ) GG_break_vram ( GG_READ, _addr, _buffer );
   INC_ADDR;
   _control_flag= Z80_FALSE;
   
@@ -1373,12 +1610,22 @@ GG_vdp_write_data (
       if ( _addr&0x1 ) /* Imparell. */
         {
           addr= _addr&0x3f;
+          GG_HASH_UPDATE ( _mem_hash, GG_HASH_CRAM, addr,
+        		   _cram[addr], byte&0xF );
           _cram[addr]= byte&0xF;
+          GG_HASH_UPDATE ( _mem_hash, GG_HASH_CRAM, addr-1,
+        		   _cram[addr-1], _cram_latch );
           _cram[addr-1]= _cram_latch;
         }
       else _cram_latch= byte;
     }
-  else _vram[_addr]= byte;
+  else
+    {
+      if ( _watch ) GG_break_vram ( GG_WRITE, _addr, byte );
+      GG_HASH_UPDATE ( _mem_hash, GG_HASH_VRAM, _addr, _vram[_addr], byte );
+      GG_PAGE_UNSHARE ( _vram_pages, _addr );
+      _vram[_addr]= byte;
+    }
   INC_ADDR;
   
 } /* end GG_vdp_write_data */
@@ -1389,11 +1636,11 @@ GG_vdp_save_state (
         	   FILE *f
         	   )
 {
-
+  
   int *aux;
   size_t ret;
   
-
+  
   SAVE ( _vram );
   SAVE ( _cram );
   SAVE ( _status );
@@ -1408,7 +1655,7 @@ GG_vdp_save_state (
   SAVE ( _regs );
   SAVE ( _timing );
   SAVE ( _line_int_counter );
-
+  
   /* En render es fa un tractament especial del punter.  */
   aux= _render.p;
   _render.p= (void *) (_render.p-&(_render.fb[0]));
@@ -1428,16 +1675,13 @@ GG_vdp_load_state (
         	   FILE *f
         	   )
 {
-
-  int n;
-
   
+  GG_page_release ( _vram_pages, GG_VRAM_PAGES );
   LOAD ( _vram );
   LOAD ( _cram );
   LOAD ( _status );
   LOAD ( _control_flag );
   LOAD ( _addr );
-  CHECK ( (_addr&0x3FFF) == _addr );
   LOAD ( _aux_byte );
   LOAD ( _code );
   LOAD ( _buffer );
@@ -1445,50 +1689,409 @@ GG_vdp_load_state (
   LOAD ( _H );
   LOAD ( _line_int_pending_flag );
   LOAD ( _regs );
-  CHECK ( (_regs.nt_addr&0x3800) == _regs.nt_addr );
-  CHECK ( (_regs.sat_addr&0x3F00) == _regs.sat_addr );
-  CHECK ( (_regs.spg_addr&0x2000) == _regs.spg_addr );
-  CHECK ( (_regs.ob_color&0xF) == _regs.ob_color );
-  CHECK ( (_regs.col&0x1F) == _regs.col );
-  CHECK ( (_regs.coll&0x1F) == _regs.coll );
-  CHECK ( (_regs.fx&0x7) == _regs.fx );
-  CHECK ( (_regs.fxl&0x7) == _regs.fxl );
-  CHECK ( (_regs.row&0x1F) == _regs.row );
-  CHECK ( (_regs.row_tmp&0x1F) == _regs.row_tmp );
-  CHECK ( (_regs.fy&0x7) == _regs.fy );
-  CHECK ( (_regs.fy_tmp&0x7) == _regs.fy_tmp );
-  CHECK ( _regs.line_counter >= 0 );
   LOAD ( _timing );
-  CHECK ( _timing.H < COUNTSPERLINE );
-  CHECK ( _timing.V < 262 );
-  CHECK ( _timing.cc >= 0 );
   LOAD ( _line_int_counter );
-  CHECK ( _line_int_counter >= 0 );
   
   /* En render es fa un tractament especial del punter.  */
   LOAD ( _render );
   _render.p= &(_render.fb[0]) + (ptrdiff_t) _render.p;
-  CHECK ( ((&(_render.fb[0])) - _render.p) <= 160*144 );
-  CHECK ( (&(_render.fb[0]) + (_render.lines-24)*160) == _render.p );
-  for ( n= 0; n < 160*144; ++n )
-    if ( _render.fb[n] < 0 || _render.fb[n] > 4095 )
-      return -1;
   
   LOAD ( _spr_buffer );
-  CHECK ( _spr_buffer.N < NUM_SPRITES );
-  for ( n= 0; n < _spr_buffer.N; ++n )
+  CHECK ( check_state () == 0 );
+  CHECK ( check_fb () == 0 );
+  _hash_dirty= Z80_TRUE;
+  
+  return 0;
+  
+} /* end GG_vdp_load_state */
+
+
+size_t
+GG_vdp_state_size (void)
+{
+  return sizeof(_vram) + sizeof(_cram) + sizeof(_status) +
+    sizeof(_control_flag) + sizeof(_addr) + sizeof(_aux_byte) +
+    sizeof(_code) + sizeof(_buffer) + sizeof(_cram_latch) + sizeof(_H) +
+    sizeof(_line_int_pending_flag) + sizeof(_regs) + sizeof(_timing) +
+    sizeof(_line_int_counter) + sizeof(_render) + sizeof(_spr_buffer);
+} /* end GG_vdp_state_size */
+
+
+Z80u8 *
+GG_vdp_save_state_mem (
+        	       Z80u8 *buf
+        	       )
+{
+  
+  int *aux;
+  
+  
+  GG_SAVE_MEM ( _vram );
+  GG_SAVE_MEM ( _cram );
+  GG_SAVE_MEM ( _status );
+  GG_SAVE_MEM ( _control_flag );
+  GG_SAVE_MEM ( _addr );
+  GG_SAVE_MEM ( _aux_byte );
+  GG_SAVE_MEM ( _code );
+  GG_SAVE_MEM ( _buffer );
+  GG_SAVE_MEM ( _cram_latch );
+  GG_SAVE_MEM ( _H );
+  GG_SAVE_MEM ( _line_int_pending_flag );
+  GG_SAVE_MEM ( _regs );
+  GG_SAVE_MEM ( _timing );
+  GG_SAVE_MEM ( _line_int_counter );
+  
+  /* En render es fa un tractament especial del punter.  */
+  aux= _render.p;
+  _render.p= (void *) (_render.p-&(_render.fb[0]));
+  GG_SAVE_MEM ( _render );
+  _render.p= aux;
+  
+  GG_SAVE_MEM ( _spr_buffer );
+  
+  return buf;
+  
+} /* end GG_vdp_save_state_mem */
+
+
+const Z80u8 *
+GG_vdp_load_state_mem (
+        	       const Z80u8    *buf,
+        	       const Z80u8    *end,
+        	       const Z80_Bool  trusted
+        	       )
+{
+  
+  GG_page_release ( _vram_pages, GG_VRAM_PAGES );
+  GG_LOAD_MEM ( _vram );
+  GG_LOAD_MEM ( _cram );
+  GG_LOAD_MEM ( _status );
+  GG_LOAD_MEM ( _control_flag );
+  GG_LOAD_MEM ( _addr );
+  GG_LOAD_MEM ( _aux_byte );
+  GG_LOAD_MEM ( _code );
+  GG_LOAD_MEM ( _buffer );
+  GG_LOAD_MEM ( _cram_latch );
+  GG_LOAD_MEM ( _H );
+  GG_LOAD_MEM ( _line_int_pending_flag );
+  GG_LOAD_MEM ( _regs );
+  GG_LOAD_MEM ( _timing );
+  GG_LOAD_MEM ( _line_int_counter );
+  
+  /* En render es fa un tractament especial del punter.  */
+  GG_LOAD_MEM ( _render );
+  _render.p= &(_render.fb[0]) + (ptrdiff_t) _render.p;
+  
+  GG_LOAD_MEM ( _spr_buffer );
+  GG_CHECK_MEM ( check_state () == 0 );
+  GG_CHECK_MEM ( trusted || check_fb () == 0 );
+  _hash_dirty= Z80_TRUE;
+  
+  return buf;
+  
+} /* end GG_vdp_load_state_mem */
+
+
+Z80u8 *
+GG_vdp_save_state_compact_mem (
+        		       Z80u8 *buf
+        		       )
+{
+  
+  int n, i;
+  Z80u16 pixel;
+  
+  
+  GG_SAVE_MEM ( _vram );
+  GG_SAVE_MEM ( _cram );
+  GG_SAVE_MEM ( _status );
+  GG_SAVE_MEM ( _control_flag );
+  GG_SAVE_MEM ( _addr );
+  GG_SAVE_MEM ( _aux_byte );
+  GG_SAVE_MEM ( _code );
+  GG_SAVE_MEM ( _buffer );
+  GG_SAVE_MEM ( _cram_latch );
+  GG_SAVE_MEM ( _H );
+  GG_SAVE_MEM ( _line_int_pending_flag );
+  GG_SAVE_MEM ( _regs );
+  GG_SAVE_MEM ( _timing );
+  GG_SAVE_MEM ( _line_int_counter );
+  
+  /* De render sols es guarden les línies pendents del 'frame'
+     actual. Els colors són de 12 bits. */
+  GG_SAVE_MEM ( _render.lines );
+  n= get_pending_pixels ();
+  for ( i= 0; i < n; ++i )
     {
-      CHECK ( _spr_buffer.v[n].ind >= 0 && _spr_buffer.v[n].ind < 64 );
-      if ( _regs.DSIZE )
+      pixel= (Z80u16) _render.fb[i];
+      GG_SAVE_MEM ( pixel );
+    }
+  
+  GG_SAVE_MEM ( _spr_buffer );
+  
+  return buf;
+  
+} /* end GG_vdp_save_state_compact_mem */
+
+
+const Z80u8 *
+GG_vdp_load_state_compact_mem (
+        		       const Z80u8 *buf,
+        		       const Z80u8 *end
+        		       )
+{
+  
+  int n, i;
+  Z80u16 pixel;
+  
+  
+  GG_page_release ( _vram_pages, GG_VRAM_PAGES );
+  GG_LOAD_MEM ( _vram );
+  GG_LOAD_MEM ( _cram );
+  GG_LOAD_MEM ( _status );
+  GG_LOAD_MEM ( _control_flag );
+  GG_LOAD_MEM ( _addr );
+  GG_LOAD_MEM ( _aux_byte );
+  GG_LOAD_MEM ( _code );
+  GG_LOAD_MEM ( _buffer );
+  GG_LOAD_MEM ( _cram_latch );
+  GG_LOAD_MEM ( _H );
+  GG_LOAD_MEM ( _line_int_pending_flag );
+  GG_LOAD_MEM ( _regs );
+  GG_LOAD_MEM ( _timing );
+  GG_LOAD_MEM ( _line_int_counter );
+  
+  /* La resta del 'frame buffer' i les línies auxiliars es tornen a
+     calcular abans de fer-se servir. */
+  GG_LOAD_MEM ( _render.lines );
+  GG_CHECK_MEM ( _render.lines >= 24 && _render.lines <= 168 );
+  n= get_pending_pixels ();
+  for ( i= 0; i < n; ++i )
+    {
+      GG_LOAD_MEM ( pixel );
+      GG_CHECK_MEM ( (pixel&0xFFF) == pixel );
+      _render.fb[i]= pixel;
+    }
+  _render.p= &(_render.fb[0]) + (_render.lines-24)*160;
+  
+  GG_LOAD_MEM ( _spr_buffer );
+  GG_CHECK_MEM ( check_state () == 0 );
+  _hash_dirty= Z80_TRUE;
+  
+  return buf;
+  
+} /* end GG_vdp_load_state_compact_mem */
+
+
+Z80u8 *
+GG_vdp_save_state_chunks (
+        		  Z80u8          *buf,
+        		  const Z80_Bool  memories
+        		  )
+{
+  
+  Z80u8 *data;
+  int n, i;
+  
+  
+  /* Memòries. */
+  if ( memories )
+    {
+      data= buf= GG_state_begin_chunk ( buf, GG_STATE_VRAM );
+      memcpy ( buf, _vram, sizeof(_vram) );
+      buf= GG_state_end_chunk ( data, buf + sizeof(_vram) );
+    }
+  data= buf= GG_state_begin_chunk ( buf, GG_STATE_CRAM );
+  memcpy ( buf, _cram, sizeof(_cram) );
+  buf= GG_state_end_chunk ( data, buf + sizeof(_cram) );
+  
+  /* Registres i temporització. */
+  data= buf= GG_state_begin_chunk ( buf, GG_STATE_VDP );
+  PUT_U8 ( _status );
+  PUT_U8 ( _control_flag );
+  PUT_U16 ( _addr );
+  PUT_U8 ( _aux_byte );
+  PUT_U8 ( _code );
+  PUT_U8 ( _buffer );
+  PUT_U8 ( _cram_latch );
+  PUT_U8 ( _H );
+  PUT_U8 ( _line_int_pending_flag );
+  PUT_U8 ( _regs.M2 );
+  PUT_U8 ( _regs.M4 );
+  PUT_U8 ( _regs.EC );
+  PUT_U8 ( _regs.IE1 );
+  PUT_U8 ( _regs.MVS );
+  PUT_U8 ( _regs.DSIZE );
+  PUT_U8 ( _regs.SIZE );
+  PUT_U8 ( _regs.M3 );
+  PUT_U8 ( _regs.M1 );
+  PUT_U8 ( _regs.IE );
+  PUT_U8 ( _regs.BLANK );
+  PUT_U8 ( _regs.BLANKl );
+  PUT_U16 ( _regs.nt_addr );
+  PUT_U16 ( _regs.sat_addr );
+  PUT_U16 ( _regs.spg_addr );
+  PUT_U8 ( _regs.ob_color );
+  PUT_U8 ( _regs.col );
+  PUT_U8 ( _regs.fx );
+  PUT_U8 ( _regs.coll );
+  PUT_U8 ( _regs.fxl );
+  PUT_U8 ( _regs.row );
+  PUT_U8 ( _regs.fy );
+  PUT_U8 ( _regs.row_tmp );
+  PUT_U8 ( _regs.fy_tmp );
+  PUT_I32 ( _regs.line_counter );
+  PUT_I32 ( _timing.H );
+  PUT_I32 ( _timing.V );
+  PUT_I32 ( _timing.cc );
+  PUT_I32 ( _timing.cctoLInt );
+  PUT_I32 ( _timing.cctoFInt );
+  PUT_I32 ( _line_int_counter );
+  PUT_I32 ( _render.lines );
+  PUT_U8 ( _spr_buffer.N );
+  PUT_U8 ( _spr_buffer.SIZE );
+  PUT_U8 ( _spr_buffer.DSIZE );
+  for ( i= 0; i < _spr_buffer.N; ++i )
+    {
+      PUT_U8 ( _spr_buffer.v[i].ind );
+      PUT_U16 ( _spr_buffer.v[i].baddr );
+    }
+  buf= GG_state_end_chunk ( data, buf );
+  
+  /* Línies pendents del 'frame' actual. */
+  data= buf= GG_state_begin_chunk ( buf, GG_STATE_FB );
+  n= get_pending_pixels ();
+  for ( i= 0; i < n; ++i )
+    PUT_U16 ( _render.fb[i] );
+  buf= GG_state_end_chunk ( data, buf );
+  
+  return buf;
+  
+} /* end GG_vdp_save_state_chunks */
+
+
+int
+GG_vdp_load_state_chunks (
+        		  const GG_StateChunks *chunks
+        		  )
+{
+  
+  const Z80u8 *p, *end;
+  size_t size;
+  Z80u8 u8;
+  Z80u16 u16;
+  uint32_t u32;
+  int n, i;
+  
+  
+  u8= 0; u16= 0; u32= 0;
+  
+  /* Memòries. */
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_VRAM, &size )) != NULL )
+    {
+      CHECK ( size == sizeof(_vram) );
+      GG_page_release ( _vram_pages, GG_VRAM_PAGES );
+      memcpy ( _vram, p, sizeof(_vram) );
+    }
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_CRAM, &size )) != NULL )
+    {
+      CHECK ( size == sizeof(_cram) );
+      memcpy ( _cram, p, sizeof(_cram) );
+    }
+  _hash_dirty= Z80_TRUE;
+  
+  /* Registres i temporització. */
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_VDP, &size )) != NULL )
+    {
+      end= p + size;
+      GET_U8 ( _status );
+      GET_U8 ( _control_flag );
+      GET_U16 ( _addr );
+      GET_U8 ( _aux_byte );
+      GET_U8 ( _code );
+      GET_U8 ( _buffer );
+      GET_U8 ( _cram_latch );
+      GET_U8 ( _H );
+      GET_U8 ( _line_int_pending_flag );
+      GET_U8 ( _regs.M2 );
+      GET_U8 ( _regs.M4 );
+      GET_U8 ( _regs.EC );
+      GET_U8 ( _regs.IE1 );
+      GET_U8 ( _regs.MVS );
+      GET_U8 ( _regs.DSIZE );
+      GET_U8 ( _regs.SIZE );
+      GET_U8 ( _regs.M3 );
+      GET_U8 ( _regs.M1 );
+      GET_U8 ( _regs.IE );
+      GET_U8 ( _regs.BLANK );
+      GET_U8 ( _regs.BLANKl );
+      GET_U16 ( _regs.nt_addr );
+      GET_U16 ( _regs.sat_addr );
+      GET_U16 ( _regs.spg_addr );
+      GET_U8 ( _regs.ob_color );
+      GET_U8 ( _regs.col );
+      GET_U8 ( _regs.fx );
+      GET_U8 ( _regs.coll );
+      GET_U8 ( _regs.fxl );
+      GET_U8 ( _regs.row );
+      GET_U8 ( _regs.fy );
+      GET_U8 ( _regs.row_tmp );
+      GET_U8 ( _regs.fy_tmp );
+      GET_I32 ( _regs.line_counter );
+      GET_I32 ( _timing.H );
+      GET_I32 ( _timing.V );
+      GET_I32 ( _timing.cc );
+      GET_I32 ( _timing.cctoLInt );
+      GET_I32 ( _timing.cctoFInt );
+      GET_I32 ( _line_int_counter );
+      GET_I32 ( _render.lines );
+      GET_U8 ( _spr_buffer.N );
+      GET_U8 ( _spr_buffer.SIZE );
+      GET_U8 ( _spr_buffer.DSIZE );
+      CHECK ( p != NULL && _spr_buffer.N < NUM_SPRITES );
+      for ( i= 0; i < _spr_buffer.N; ++i )
         {
-          CHECK ( (_spr_buffer.v[n].baddr&0x3FE)==_spr_buffer.v[n].baddr );
+          GET_U8 ( _spr_buffer.v[i].ind );
+          GET_U16 ( _spr_buffer.v[i].baddr );
         }
-      else
+      CHECK ( p == end );
+      CHECK ( _code <= 3 );
+      CHECK ( _render.lines >= 24 && _render.lines <= 168 );
+      _render.p= &(_render.fb[0]) + (_render.lines-24)*160;
+      CHECK ( check_state () == 0 );
+    }
+  
+  /* Línies pendents. */
+  if ( (p= GG_state_get_chunk ( chunks, GG_STATE_FB, &size )) != NULL )
+    {
+      end= p + size;
+      n= get_pending_pixels ();
+      CHECK ( size == 2*(size_t) n );
+      for ( i= 0; i < n; ++i )
         {
-          CHECK ( (_spr_buffer.v[n].baddr&0x7FC)==_spr_buffer.v[n].baddr );
+          GET_U16 ( _render.fb[i] );
+          CHECK ( (_render.fb[i]&0xFFF) == _render.fb[i] );
         }
     }
   
   return 0;
   
-} /* end GG_vdp_load_state */
+} /* end GG_vdp_load_state_chunks */
+
+
+void
+GG_vdp_set_frame_skip (
+        	       const Z80_Bool skip
+        	       )
+{
+  _frame_skip= skip;
+} /* end GG_vdp_set_frame_skip */
+
+
+void
+GG_vdp_set_watch (
+        	  const Z80_Bool val
+        	  )
+{
+  _watch= val;
+} /* end GG_vdp_set_watch */
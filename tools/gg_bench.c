@@ -0,0 +1,377 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  gg_bench.c - Executa un nombre fix de 'frames' sense vídeo ni so i
+ *               mesura la velocitat del simulador.
+ *
+ *  NOTES: Sempre comença des de l'estat inicial (o des de l'estat
+ *  inicial de la pel·lícula) i para just al final del 'frame' FRAMES,
+ *  per tant els resums finals serveixen per a comprovar que una
+ *  optimització no canvia el comportament. Perquè no depenguen de la
+ *  màquina (ordre dels bytes, grandària dels enters...) no es resumeixen
+ *  les estructures internes sinó el 'frame' passat a 16 bits en
+ *  'little-endian' i l'estat en format portable (veure STATE), sense
+ *  el tros de la UCP, que la llibreria Z80 guarda tal qual. Qualsevol
+ *  diferència en la UCP acaba reflectint-se en la memòria o el VDP.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* 'Frames' per defecte. */
+static const int NFRAMES= 3000;
+
+static const char *PERF_NAMES[GG_PERF_NCOUNTERS]=
+  {
+    "cpu", "render", "sat", "synth", "mix", "update_screen",
+    "play_sound", "check", "check_buttons"
+  };
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80u8 _sram[32*1024];
+static int _frames;
+static int _nframes;
+static int _checkpoint;
+static GG_Hash _frame_hash;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+warning (
+         void       *udata,
+         const char *format,
+         ...
+         )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  fprintf ( stderr, "Warning: " );
+  vfprintf ( stderr, format, ap );
+  putc ( '\n', stderr );
+  va_end ( ap );
+  
+} /* end warning */
+
+
+static Z80u8 *
+get_external_ram (
+        	  void *udata
+        	  )
+{
+  return &(_sram[0]);
+} /* end get_external_ram */
+
+
+/* Cada color (12 bits) es passa a 16 bits en 'little-endian' abans
+   de resumir-lo. */
+static GG_Hash
+hash_frame (
+            const int fb[23040]
+            )
+{
+  
+  static Z80u8 buf[23040*2];
+  
+  int i;
+  
+  
+  for ( i= 0; i < 23040; ++i )
+    {
+      buf[2*i]= (Z80u8) (fb[i]&0xFF);
+      buf[2*i+1]= (Z80u8) ((fb[i]>>8)&0xFF);
+    }
+  
+  return GG_hash_bytes ( 0, buf, sizeof(buf) );
+  
+} /* end hash_frame */
+
+
+/* Resumeix tros a tros l'estat en format portable, excepte el de la
+   UCP. Torna 0 en cas d'error. */
+static GG_Hash
+hash_state (void)
+{
+  
+  GG_StateChunks chunks;
+  GG_Hash hash;
+  Z80u8 *buf;
+  size_t size;
+  int i;
+  
+  
+  buf= (Z80u8 *) malloc ( GG_state_size () );
+  if ( buf == NULL ) return 0;
+  hash= 0;
+  size= GG_save_state_portable_mem ( buf );
+  if ( size != 0 && GG_state_index ( buf, size, &chunks ) == 0 )
+    for ( i= 0; i < chunks.N; ++i )
+      {
+        if ( chunks.v[i].id == GG_STATE_Z80 ) continue;
+        hash= GG_hash_mix ( hash ^ chunks.v[i].id );
+        hash= GG_hash_bytes ( hash, chunks.v[i].data, chunks.v[i].size );
+      }
+  free ( buf );
+  
+  return hash;
+  
+} /* end hash_state */
+
+
+/* Mostra el resum cada _checkpoint 'frames' i para GG_loop al final
+   de l'últim 'frame'. */
+static void
+update_screen (
+               const int  fb[23040],
+               void      *udata
+               )
+{
+  
+  GG_Hash hash;
+  
+  
+  ++_frames;
+  if ( _checkpoint > 0 && _frames%_checkpoint == 0 && _frames != _nframes )
+    {
+      hash= hash_frame ( fb );
+      printf ( "checkpoint         %d %016llx\n",
+               _frames, (unsigned long long) hash );
+    }
+  if ( _frames == _nframes )
+    {
+      _frame_hash= hash_frame ( fb );
+      GG_stop ();
+    }
+  
+} /* end update_screen */
+
+
+static int
+check_buttons (
+               void *udata
+               )
+{
+  return 0;
+} /* end check_buttons */
+
+
+static void
+play_sound (
+            const double  left[GG_PSG_BUFFER_SIZE],
+            const double  right[GG_PSG_BUFFER_SIZE],
+            void         *udata
+            )
+{
+} /* end play_sound */
+
+
+static int
+load_rom (
+          const char *fn,
+          GG_Rom     *rom
+          )
+{
+  
+  FILE *f;
+  long size;
+  
+  
+  f= fopen ( fn, "rb" );
+  if ( f == NULL ) return -1;
+  if ( fseek ( f, 0, SEEK_END ) != 0 ) goto error;
+  size= ftell ( f );
+  if ( size <= 0 || size%GG_BANK_SIZE != 0 ) goto error;
+  rewind ( f );
+  rom->nbanks= (int) (size/GG_BANK_SIZE);
+  GG_rom_alloc ( *rom );
+  if ( rom->banks == NULL ) goto error;
+  if ( fread ( rom->banks, size, 1, f ) != 1 ) goto error;
+  fclose ( f );
+  
+  return 0;
+  
+ error:
+  fclose ( f );
+  return -1;
+  
+} /* end load_rom */
+
+
+static int
+play_movie (
+            const char *fn
+            )
+{
+  
+  FILE *f;
+  int ret;
+  
+  
+  f= fopen ( fn, "rb" );
+  if ( f == NULL ) return -1;
+  ret= GG_movie_load ( f );
+  fclose ( f );
+  if ( ret != 0 ) return -1;
+  
+  return GG_movie_play ();
+  
+} /* end play_movie */
+
+
+static void
+report_perf (void)
+{
+  
+  GG_PerfStats stats;
+  double total;
+  int i;
+  
+  
+  if ( !GG_perf_is_available () )
+    {
+      printf ( "perf               not available (build with -DGG_PERF)\n" );
+      return;
+    }
+  GG_perf_get_stats ( &stats );
+  if ( stats.frames == 0 ) return;
+  total= (double) stats.frame_ns;
+  for ( i= 0; i < GG_PERF_NCOUNTERS; ++i )
+    printf ( "perf.%-13s %10.0f ns/frame %6.2f %% %12.1f calls/frame\n",
+             PERF_NAMES[i],
+             stats.total[i].ns / (double) stats.frames,
+             total > 0.0 ? 100.0*stats.total[i].ns/total : 0.0,
+             stats.total[i].calls / (double) stats.frames );
+  
+} /* end report_perf */
+
+
+
+
+/******************/
+/* PUNT D'ENTRADA */
+/******************/
+
+int
+main (
+      int   argc,
+      char *argv[]
+      )
+{
+  
+  static const GG_Frontend frontend=
+    {
+      warning,
+      get_external_ram,
+      update_screen,
+      NULL,
+      check_buttons,
+      play_sound,
+      NULL,
+      NULL
+    };
+  
+  GG_Rom rom;
+  GG_MovieInfo info;
+  double t;
+  
+  
+  _checkpoint= 0;
+  if ( argc >= 3 && strcmp ( argv[1], "-c" ) == 0 )
+    {
+      _checkpoint= atoi ( argv[2] );
+      argv+= 2; argc-= 2;
+    }
+  if ( argc < 2 || argc > 4 )
+    {
+      fprintf ( stderr, "Usage: %s [-c N] ROM [FRAMES [MOVIE]]\n",
+        	argv[0] );
+      return EXIT_FAILURE;
+    }
+  _nframes= argc>=3 ? atoi ( argv[2] ) : NFRAMES;
+  if ( _nframes <= 0 ) _nframes= NFRAMES;
+  rom.banks= NULL;
+  if ( load_rom ( argv[1], &rom ) != 0 )
+    {
+      fprintf ( stderr, "Error: no s'ha pogut llegir '%s'\n", argv[1] );
+      return EXIT_FAILURE;
+    }
+  GG_init ( &rom, &frontend, NULL );
+  if ( argc == 4 && play_movie ( argv[3] ) != 0 )
+    {
+      fprintf ( stderr, "Error: no s'ha pogut reproduir '%s'\n", argv[3] );
+      GG_rom_free ( rom );
+      return EXIT_FAILURE;
+    }
+  
+  _frames= 0;
+  GG_perf_reset ();
+  t= GG_clock_get ();
+  GG_loop ();
+  t= GG_clock_get ()-t;
+  
+  printf ( "rom                %08lx\n", (unsigned long) GG_get_rom_crc32 () );
+  if ( argc == 4 )
+    {
+      GG_movie_get_info ( &info );
+      printf ( "movie              %d frames\n", info.nframes );
+    }
+  printf ( "frames             %d\n", _frames );
+  printf ( "time               %.6f s\n", t );
+  printf ( "fps                %.2f\n", _frames/t );
+  printf ( "ns/frame           %.0f\n", 1e9*t/_frames );
+  printf ( "speed              %.2fx\n",
+           _frames*GG_CICLES_PER_FRAME / (t*GG_CICLES_PER_SEC) );
+  report_perf ();
+  printf ( "frame_hash         %016llx\n", (unsigned long long) _frame_hash );
+  printf ( "state_hash         %016llx\n",
+           (unsigned long long) hash_state () );
+  GG_rom_free ( rom );
+  
+  return EXIT_SUCCESS;
+  
+} /* end main */
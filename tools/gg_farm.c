@@ -0,0 +1,531 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  gg_farm.c - Executa gg_bench sobre totes les ROMs d'un directori en
+ *              paral·lel i escriu un informe que es pot comparar entre
+ *              versions.
+ *
+ *  NOTES: El simulador és un objecte únic amb estat global, per tant
+ *  cada ROM s'executa en un procés gg_bench distint. Els fils sols
+ *  llancen els processos i arrepleguen l'eixida; agafen la següent ROM
+ *  d'una cua compartida quan acaben l'anterior, així les ROMs lentes no
+ *  deixen nuclis parats. L'informe sempre està ordenat per nom de ROM
+ *  i, amb -n, sols conté resums portables (veure gg_bench.c), per tant
+ *  es pot comparar amb un generat en una altra màquina.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+static const char *GG_BENCH= "./gg_bench";
+
+/* 'Frames' per defecte per ROM i entre resums intermedis. */
+static const int NFRAMES= 3000;
+static const int CHECKPOINT= 600;
+
+/* Temps màxim per defecte per ROM en segons. */
+static const int TIMEOUT= 300;
+
+/* Línies d'avisos que es guarden per ROM. */
+#define MAX_WARNINGS 64
+
+#define LINE_SIZE 1024
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+typedef struct
+{
+  
+  char   *rom;         /* Camí de la ROM. */
+  char   *movie;       /* Camí de la pel·lícula o NULL. */
+  char   *name;        /* Nom en l'informe. */
+  char   *out;         /* Eixida estàndard de gg_bench. */
+  char   *err;         /* Eixida d'errors de gg_bench. */
+  double  time;        /* Temps real en segons. */
+  int     status;      /* Estat retornat per waitpid. */
+  int     spawned;     /* 0 si no s'ha pogut llançar. */
+  
+} job_t;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static job_t *_jobs;
+static int _njobs;
+static int _next;
+static pthread_mutex_t _lock= PTHREAD_MUTEX_INITIALIZER;
+
+/* Opcions. */
+static const char *_bench;
+static int _nframes;
+static int _checkpoint;
+static int _timeout;
+static int _show_times;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static char *
+str_dup (
+         const char *s
+         )
+{
+  
+  char *ret;
+  
+  
+  ret= malloc ( strlen ( s ) + 1 );
+  if ( ret == NULL ) { perror ( "malloc" ); exit ( EXIT_FAILURE ); }
+  strcpy ( ret, s );
+  
+  return ret;
+  
+} /* end str_dup */
+
+
+static char *
+path_join (
+           const char *dir,
+           const char *name
+           )
+{
+  
+  char *ret;
+  size_t len;
+  
+  
+  len= strlen ( dir ) + strlen ( name ) + 2;
+  ret= malloc ( len );
+  if ( ret == NULL ) { perror ( "malloc" ); exit ( EXIT_FAILURE ); }
+  snprintf ( ret, len, "%s/%s", dir, name );
+  
+  return ret;
+  
+} /* end path_join */
+
+
+/* Llig tot el contingut d'un fitxer temporal. */
+static char *
+read_all (
+          FILE *f
+          )
+{
+  
+  char *ret;
+  long size;
+  
+  
+  if ( fseek ( f, 0, SEEK_END ) != 0 ) return str_dup ( "" );
+  size= ftell ( f );
+  rewind ( f );
+  ret= malloc ( size + 1 );
+  if ( ret == NULL ) { perror ( "malloc" ); exit ( EXIT_FAILURE ); }
+  if ( size > 0 && fread ( ret, size, 1, f ) != 1 ) size= 0;
+  ret[size]= '\0';
+  
+  return ret;
+  
+} /* end read_all */
+
+
+static int
+cmp_jobs (
+          const void *a,
+          const void *b
+          )
+{
+  return strcmp ( ((const job_t *) a)->name, ((const job_t *) b)->name );
+} /* end cmp_jobs */
+
+
+/* Afegeix una tasca per cada fitxer '.gg' de DIR. Si existeix un
+   fitxer amb el mateix nom i extensió '.ggm' s'utilitza com a
+   pel·lícula. */
+static int
+scan_dir (
+          const char *dir
+          )
+{
+  
+  DIR *d;
+  struct dirent *e;
+  size_t len;
+  int size;
+  char *movie;
+  job_t *job;
+  
+  
+  d= opendir ( dir );
+  if ( d == NULL ) return -1;
+  _njobs= size= 0;
+  _jobs= NULL;
+  while ( (e= readdir ( d )) != NULL )
+    {
+      len= strlen ( e->d_name );
+      if ( len < 4 || strcmp ( e->d_name+len-3, ".gg" ) != 0 ) continue;
+      if ( _njobs == size )
+        {
+          size= size ? 2*size : 64;
+          _jobs= realloc ( _jobs, size*sizeof(job_t) );
+          if ( _jobs == NULL ) { perror ( "realloc" ); exit ( EXIT_FAILURE ); }
+        }
+      job= &_jobs[_njobs++];
+      memset ( job, 0, sizeof(job_t) );
+      job->name= str_dup ( e->d_name );
+      job->rom= path_join ( dir, e->d_name );
+      movie= malloc ( strlen ( job->rom ) + 2 );
+      if ( movie == NULL ) { perror ( "malloc" ); exit ( EXIT_FAILURE ); }
+      sprintf ( movie, "%sm", job->rom );
+      if ( access ( movie, R_OK ) == 0 ) job->movie= movie;
+      else free ( movie );
+    }
+  closedir ( d );
+  qsort ( _jobs, _njobs, sizeof(job_t), cmp_jobs );
+  
+  return 0;
+  
+} /* end scan_dir */
+
+
+/* Llança gg_bench amb les eixides redirigides a fitxers temporals i
+   espera que acabe. Entre fork i exec sols es criden funcions segures
+   en un procés amb fils. */
+static void
+run_job (
+         job_t *job
+         )
+{
+  
+  char frames[16], checkpoint[16];
+  char *argv[8];
+  FILE *out, *err;
+  pid_t pid;
+  int n;
+  
+  
+  snprintf ( frames, sizeof(frames), "%d", _nframes );
+  snprintf ( checkpoint, sizeof(checkpoint), "%d", _checkpoint );
+  n= 0;
+  argv[n++]= (char *) _bench;
+  argv[n++]= "-c";
+  argv[n++]= checkpoint;
+  argv[n++]= job->rom;
+  argv[n++]= frames;
+  if ( job->movie != NULL ) argv[n++]= job->movie;
+  argv[n]= NULL;
+  
+  out= tmpfile ();
+  err= tmpfile ();
+  if ( out == NULL || err == NULL ) goto error;
+  job->time= GG_clock_get ();
+  pid= fork ();
+  if ( pid == -1 ) goto error;
+  if ( pid == 0 )
+    {
+      if ( dup2 ( fileno ( out ), 1 ) == -1 ||
+           dup2 ( fileno ( err ), 2 ) == -1 )
+        _exit ( 127 );
+      /* SIGALRM mata el procés si no acaba a temps. */
+      if ( _timeout > 0 ) alarm ( _timeout );
+      execv ( _bench, argv );
+      _exit ( 127 );
+    }
+  while ( waitpid ( pid, &job->status, 0 ) == -1 )
+    if ( errno != EINTR ) goto error;
+  job->time= GG_clock_get () - job->time;
+  job->spawned= 1;
+  job->out= read_all ( out );
+  job->err= read_all ( err );
+  fclose ( out );
+  fclose ( err );
+  
+  return;
+  
+ error:
+  job->err= str_dup ( strerror ( errno ) );
+  if ( out != NULL ) fclose ( out );
+  if ( err != NULL ) fclose ( err );
+  
+} /* end run_job */
+
+
+static void *
+worker (
+        void *arg
+        )
+{
+  
+  int i;
+  
+  
+  (void) arg;
+  for (;;)
+    {
+      pthread_mutex_lock ( &_lock );
+      i= _next < _njobs ? _next++ : -1;
+      pthread_mutex_unlock ( &_lock );
+      if ( i == -1 ) break;
+      run_job ( &_jobs[i] );
+      fprintf ( stderr, "[%d/%d] %s\n", i+1, _njobs, _jobs[i].name );
+    }
+  
+  return NULL;
+  
+} /* end worker */
+
+
+/* Escriu les línies de gg_bench que no depenen de la màquina. Els
+   resums els calcula gg_bench sobre el 'frame' en 'little-endian' i
+   sobre l'estat en format portable, per tant es poden comparar entre
+   màquines i ABIs distintes; el temps i els comptadors de PERF no
+   (sols s'escriuen sense -n). */
+static void
+report_out (
+            FILE        *f,
+            const job_t *job
+            )
+{
+  
+  char line[LINE_SIZE];
+  const char *p, *q;
+  size_t len;
+  
+  
+  for ( p= job->out; *p != '\0'; p= *q ? q+1 : q )
+    {
+      q= strchr ( p, '\n' );
+      if ( q == NULL ) q= p + strlen ( p );
+      len= (size_t) (q-p) < sizeof(line) ? (size_t) (q-p) : sizeof(line)-1;
+      memcpy ( line, p, len );
+      line[len]= '\0';
+      if ( strncmp ( line, "checkpoint ", 11 ) == 0 ||
+           strncmp ( line, "frame_hash ", 11 ) == 0 ||
+           strncmp ( line, "state_hash ", 11 ) == 0 ||
+           strncmp ( line, "frames ", 7 ) == 0 )
+        fprintf ( f, "%s %s\n", job->name, line );
+      else if ( _show_times &&
+        	(strncmp ( line, "fps ", 4 ) == 0 ||
+        	 strncmp ( line, "perf.", 5 ) == 0) )
+        fprintf ( f, "%s %s\n", job->name, line );
+    }
+  
+} /* end report_out */
+
+
+/* Cada línia de l'eixida d'errors és un avís o un error. */
+static void
+report_err (
+            FILE        *f,
+            const job_t *job
+            )
+{
+  
+  const char *p, *q;
+  int n;
+  
+  
+  n= 0;
+  for ( p= job->err; *p != '\0'; p= *q ? q+1 : q )
+    {
+      q= strchr ( p, '\n' );
+      if ( q == NULL ) q= p + strlen ( p );
+      if ( n++ < MAX_WARNINGS )
+        fprintf ( f, "%s warning            %.*s\n",
+        	  job->name, (int) (q-p), p );
+    }
+  if ( n > MAX_WARNINGS )
+    fprintf ( f, "%s warnings_dropped   %d\n", job->name, n-MAX_WARNINGS );
+  
+} /* end report_err */
+
+
+/* Retorna el nombre de ROMs que han fallat. */
+static int
+report (
+        FILE *f
+        )
+{
+  
+  const job_t *job;
+  int i, ret, status;
+  
+  
+  ret= 0;
+  for ( i= 0; i < _njobs; ++i )
+    {
+      job= &_jobs[i];
+      status= job->status;
+      if ( !job->spawned )
+        fprintf ( f, "%s status             error\n", job->name );
+      else if ( WIFSIGNALED ( status ) && WTERMSIG ( status ) == SIGALRM )
+        fprintf ( f, "%s status             timeout\n", job->name );
+      else if ( WIFSIGNALED ( status ) )
+        fprintf ( f, "%s status             crash %d\n",
+        	  job->name, WTERMSIG ( status ) );
+      else if ( WEXITSTATUS ( status ) != 0 )
+        fprintf ( f, "%s status             exit %d\n",
+        	  job->name, WEXITSTATUS ( status ) );
+      else
+        fprintf ( f, "%s status             ok\n", job->name );
+      if ( !job->spawned || !WIFEXITED ( status ) ||
+           WEXITSTATUS ( status ) != 0 )
+        ++ret;
+      if ( job->movie != NULL )
+        fprintf ( f, "%s movie              %s\n", job->name, job->movie );
+      if ( _show_times && job->spawned )
+        fprintf ( f, "%s time               %.3f s\n", job->name, job->time );
+      if ( job->out != NULL ) report_out ( f, job );
+      if ( job->err != NULL ) report_err ( f, job );
+    }
+  
+  return ret;
+  
+} /* end report */
+
+
+static void
+usage (
+       const char *prog
+       )
+{
+  fprintf ( stderr,
+            "Usage: %s [-j JOBS] [-f FRAMES] [-c CHECKPOINT] [-t TIMEOUT]"
+            " [-b GG_BENCH] [-n] DIR [REPORT]\n", prog );
+} /* end usage */
+
+
+
+
+/******************/
+/* PUNT D'ENTRADA */
+/******************/
+
+int
+main (
+      int   argc,
+      char *argv[]
+      )
+{
+  
+  pthread_t *threads;
+  FILE *f;
+  int opt, njobs, i, nfailed;
+  double t;
+  
+  
+  _bench= GG_BENCH;
+  _nframes= NFRAMES;
+  _checkpoint= CHECKPOINT;
+  _timeout= TIMEOUT;
+  _show_times= 1;
+  njobs= (int) sysconf ( _SC_NPROCESSORS_ONLN );
+  while ( (opt= getopt ( argc, argv, "j:f:c:t:b:n" )) != -1 )
+    switch ( opt )
+      {
+      case 'j': njobs= atoi ( optarg ); break;
+      case 'f': _nframes= atoi ( optarg ); break;
+      case 'c': _checkpoint= atoi ( optarg ); break;
+      case 't': _timeout= atoi ( optarg ); break;
+      case 'b': _bench= optarg; break;
+      case 'n': _show_times= 0; break;
+      default: usage ( argv[0] ); return EXIT_FAILURE;
+      }
+  if ( optind >= argc || argc-optind > 2 || _nframes <= 0 )
+    {
+      usage ( argv[0] );
+      return EXIT_FAILURE;
+    }
+  if ( njobs < 1 ) njobs= 1;
+  if ( scan_dir ( argv[optind] ) != 0 )
+    {
+      fprintf ( stderr, "Error: no s'ha pogut llegir '%s'\n", argv[optind] );
+      return EXIT_FAILURE;
+    }
+  if ( njobs > _njobs ) njobs= _njobs > 0 ? _njobs : 1;
+  
+  /* Execució. */
+  _next= 0;
+  threads= malloc ( njobs*sizeof(pthread_t) );
+  if ( threads == NULL ) { perror ( "malloc" ); return EXIT_FAILURE; }
+  t= GG_clock_get ();
+  for ( i= 0; i < njobs; ++i )
+    if ( pthread_create ( &threads[i], NULL, worker, NULL ) != 0 )
+      {
+        fprintf ( stderr, "Error: no s'ha pogut crear el fil %d\n", i );
+        return EXIT_FAILURE;
+      }
+  for ( i= 0; i < njobs; ++i )
+    pthread_join ( threads[i], NULL );
+  t= GG_clock_get () - t;
+  free ( threads );
+  
+  /* Informe. */
+  if ( argc-optind == 2 )
+    {
+      f= fopen ( argv[optind+1], "w" );
+      if ( f == NULL )
+        {
+          fprintf ( stderr, "Error: no s'ha pogut crear '%s'\n",
+        	    argv[optind+1] );
+          return EXIT_FAILURE;
+        }
+    }
+  else f= stdout;
+  nfailed= report ( f );
+  if ( f != stdout ) fclose ( f );
+  fprintf ( stderr, "%d ROMs, %d errors, %.1f s amb %d fils\n",
+            _njobs, nfailed, t, njobs );
+  
+  return nfailed ? EXIT_FAILURE : EXIT_SUCCESS;
+  
+} /* end main */
@@ -0,0 +1,475 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  netplay_test.c - Prova el mòdul ROLLBACK amb dues instàncies
+ *                   connectades per un enllaç local amb retard.
+ *
+ *  NOTES: El simulador és un 'singleton', per tant cada instància és
+ *  un procés. Cada jugador genera una seqüència d'entrades
+ *  pseudoaleatòria i l'envia a l'altre amb un retard de DELAY
+ *  'frames' (més JITTER aleatori). Al final els dos processos
+ *  calculen un resum de l'estat i el pare comprova que coincideixen.
+ *  El resum no depén del retard, i es pot comparar entre execucions.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "GG.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define MAX_QUEUE 4096
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+typedef struct
+{
+  
+  int32_t frame;
+  int32_t buttons;
+  
+} msg_t;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80u8 _sram[32*1024];
+
+/* Paràmetres. */
+static int _nframes= 1200;
+static int _delay= 4;
+static int _jitter= 3;
+static int _window= 16;
+
+/* Missatges pendents d'enviar. */
+static struct
+{
+  
+  msg_t v[MAX_QUEUE];
+  int   send_at[MAX_QUEUE];
+  int   begin, N;
+  int   last;        /* Per a mantindre l'ordre. */
+  
+} _queue;
+
+static int _fd;
+static unsigned int _seed;        /* Entrades. */
+static unsigned int _link_seed;   /* Retard. */
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+warning (
+         void       *udata,
+         const char *format,
+         ...
+         )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  fprintf ( stderr, "Warning: " );
+  vfprintf ( stderr, format, ap );
+  putc ( '\n', stderr );
+  va_end ( ap );
+  
+} /* end warning */
+
+
+static Z80u8 *
+get_external_ram (
+        	  void *udata
+        	  )
+{
+  return &(_sram[0]);
+} /* end get_external_ram */
+
+
+static void
+update_screen (
+               const int  fb[23040],
+               void      *udata
+               )
+{
+} /* end update_screen */
+
+
+static int
+check_buttons (
+               void *udata
+               )
+{
+  return 0;
+} /* end check_buttons */
+
+
+static void
+play_sound (
+            const double  left[GG_PSG_BUFFER_SIZE],
+            const double  right[GG_PSG_BUFFER_SIZE],
+            void         *udata
+            )
+{
+} /* end play_sound */
+
+
+static int
+load_rom (
+          const char *fn,
+          GG_Rom     *rom
+          )
+{
+  
+  FILE *f;
+  long size;
+  
+  
+  f= fopen ( fn, "rb" );
+  if ( f == NULL ) return -1;
+  if ( fseek ( f, 0, SEEK_END ) != 0 ) goto error;
+  size= ftell ( f );
+  if ( size <= 0 || size%GG_BANK_SIZE != 0 ) goto error;
+  rewind ( f );
+  rom->nbanks= (int) (size/GG_BANK_SIZE);
+  GG_rom_alloc ( *rom );
+  if ( rom->banks == NULL ) goto error;
+  if ( fread ( rom->banks, size, 1, f ) != 1 ) goto error;
+  fclose ( f );
+  
+  return 0;
+  
+ error:
+  fclose ( f );
+  return -1;
+  
+} /* end load_rom */
+
+
+static unsigned int
+next_rand (
+           unsigned int *seed
+           )
+{
+  
+  *seed= (*seed)*1103515245u + 12345u;
+  
+  return ((*seed)>>16)&0x7FFF;
+  
+} /* end next_rand */
+
+
+/* Entrada del jugador en el 'frame' FRAME. Canvia cada poc. */
+static int
+get_input (
+           const int player,
+           const int frame
+           )
+{
+  
+  static int current[2];
+  
+  
+  if ( frame%(7+player*4) == 0 )
+    current[player]= next_rand ( &_seed )&0x3F;
+  
+  return current[player];
+  
+} /* end get_input */
+
+
+static void
+queue_push (
+            const int frame,
+            const int buttons,
+            const int now
+            )
+{
+  
+  int pos, at;
+  
+  
+  at= now + _delay + (_jitter>0 ? (int) (next_rand ( &_link_seed )%(_jitter+1)) : 0);
+  if ( at < _queue.last ) at= _queue.last;
+  _queue.last= at;
+  pos= (_queue.begin+_queue.N)%MAX_QUEUE;
+  _queue.v[pos].frame= frame;
+  _queue.v[pos].buttons= buttons;
+  _queue.send_at[pos]= at;
+  ++_queue.N;
+  
+} /* end queue_push */
+
+
+/* Envia els missatges que toca. Si NOW és negatiu els envia tots. */
+static int
+queue_flush (
+             const int now
+             )
+{
+  
+  while ( _queue.N > 0 &&
+          (now < 0 || _queue.send_at[_queue.begin] <= now) )
+    {
+      if ( write ( _fd, &(_queue.v[_queue.begin]), sizeof(msg_t) ) !=
+           sizeof(msg_t) )
+        return -1;
+      _queue.begin= (_queue.begin+1)%MAX_QUEUE;
+      --_queue.N;
+    }
+  
+  return 0;
+  
+} /* end queue_flush */
+
+
+/* Llig els missatges disponibles. Si BLOCK és cert espera com a
+ * mínim un.
+ */
+static int
+receive (
+         const Z80_Bool block
+         )
+{
+  
+  msg_t msg;
+  ssize_t n;
+  int flags, count;
+  
+  
+  flags= fcntl ( _fd, F_GETFL );
+  fcntl ( _fd, F_SETFL, block ? (flags&~O_NONBLOCK) : (flags|O_NONBLOCK) );
+  count= 0;
+  while ( (n= read ( _fd, &msg, sizeof(msg) )) == sizeof(msg) )
+    {
+      if ( GG_rollback_add_remote_input ( msg.frame, msg.buttons ) != 0 )
+        return -1;
+      if ( count++ == 0 && block )
+        fcntl ( _fd, F_SETFL, flags|O_NONBLOCK );
+    }
+  
+  /* L'altre extrem pot haver acabat. */
+  if ( n == 0 && block && count == 0 ) return -1;
+  if ( n < 0 && errno != EAGAIN && errno != EWOULDBLOCK ) return -1;
+  if ( n > 0 && n != sizeof(msg) ) return -1;
+  
+  return 0;
+  
+} /* end receive */
+
+
+static uint64_t
+hash_state (void)
+{
+  
+  static Z80u8 buf[1<<20];
+  size_t n, i;
+  uint64_t h;
+  
+  
+  n= GG_save_state_compact_mem ( buf );
+  h= 0xcbf29ce484222325ULL;
+  for ( i= 0; i < n; ++i )
+    h= (h^buf[i])*0x100000001b3ULL;
+  
+  return h;
+  
+} /* end hash_state */
+
+
+static int
+run_player (
+            const GG_Rom *rom,
+            const int     player,
+            const int     fd
+            )
+{
+  
+  static const GG_Frontend frontend=
+    {
+      warning,
+      get_external_ram,
+      update_screen,
+      NULL,
+      check_buttons,
+      play_sound,
+      NULL,
+      NULL
+    };
+  
+  GG_RollbackStats stats;
+  int frame, buttons;
+  
+  
+  _fd= fd;
+  _seed= 1234u + 77u*player;
+  _link_seed= 99u + player;
+  GG_init ( rom, &frontend, NULL );
+  if ( GG_rollback_init ( player, _window ) != 0 ) return -1;
+  for ( frame= 0; frame < _nframes; ++frame )
+    {
+      buttons= get_input ( player, frame );
+      queue_push ( frame, buttons, frame );
+      if ( queue_flush ( frame ) != 0 ) return -1;
+      if ( receive ( Z80_FALSE ) != 0 ) return -1;
+      while ( GG_rollback_advance ( buttons ) < 0 )
+        {
+          /* Massa per davant: passa el temps. */
+          if ( queue_flush ( -1 ) != 0 ) return -1;
+          if ( receive ( Z80_TRUE ) != 0 ) return -1;
+        }
+    }
+  
+  /* Espera les últimes entrades. */
+  if ( queue_flush ( -1 ) != 0 ) return -1;
+  while ( GG_rollback_get_confirmed () < _nframes )
+    if ( receive ( Z80_TRUE ) != 0 ) return -1;
+  GG_rollback_sync ();
+  GG_rollback_get_stats ( &stats );
+  printf ( "%d %016llx %lu %lu %lu %d\n",
+           player, (unsigned long long) hash_state (),
+           stats.frames, stats.rollbacks, stats.resimulated,
+           stats.max_depth );
+  fflush ( stdout );
+  
+  return 0;
+  
+} /* end run_player */
+
+
+
+
+/******************/
+/* PUNT D'ENTRADA */
+/******************/
+
+int
+main (
+      int   argc,
+      char *argv[]
+      )
+{
+  
+  GG_Rom rom;
+  int fds[2], pipes[2][2], i, status, ret;
+  pid_t pid[2];
+  char line[2][256];
+  unsigned long long hash[2];
+  FILE *f;
+  
+  
+  if ( argc < 2 || argc > 6 )
+    {
+      fprintf ( stderr, "Usage: %s ROM [FRAMES [DELAY [JITTER [WINDOW]]]]\n",
+        	argv[0] );
+      return EXIT_FAILURE;
+    }
+  if ( argc > 2 ) _nframes= atoi ( argv[2] );
+  if ( argc > 3 ) _delay= atoi ( argv[3] );
+  if ( argc > 4 ) _jitter= atoi ( argv[4] );
+  if ( argc > 5 ) _window= atoi ( argv[5] );
+  rom.banks= NULL;
+  if ( load_rom ( argv[1], &rom ) != 0 )
+    {
+      fprintf ( stderr, "Error: no s'ha pogut llegir '%s'\n", argv[1] );
+      return EXIT_FAILURE;
+    }
+  
+  /* Enllaç i processos. */
+  if ( socketpair ( AF_UNIX, SOCK_STREAM, 0, fds ) != 0 ) return EXIT_FAILURE;
+  for ( i= 0; i < 2; ++i )
+    {
+      if ( pipe ( pipes[i] ) != 0 ) return EXIT_FAILURE;
+      pid[i]= fork ();
+      if ( pid[i] < 0 ) return EXIT_FAILURE;
+      if ( pid[i] == 0 )
+        {
+          close ( fds[1-i] );
+          close ( pipes[i][0] );
+          dup2 ( pipes[i][1], STDOUT_FILENO );
+          _exit ( run_player ( &rom, i, fds[i] )==0 ?
+        	  EXIT_SUCCESS : EXIT_FAILURE );
+        }
+      close ( pipes[i][1] );
+    }
+  close ( fds[0] );
+  close ( fds[1] );
+  
+  /* Resultats. */
+  ret= EXIT_SUCCESS;
+  for ( i= 0; i < 2; ++i )
+    {
+      f= fdopen ( pipes[i][0], "r" );
+      if ( f == NULL || fgets ( line[i], sizeof(line[i]), f ) == NULL )
+        line[i][0]= '\0';
+      if ( f != NULL ) fclose ( f );
+      if ( waitpid ( pid[i], &status, 0 ) < 0 ||
+           !WIFEXITED ( status ) || WEXITSTATUS ( status ) != 0 )
+        ret= EXIT_FAILURE;
+    }
+  for ( i= 0; i < 2; ++i )
+    {
+      printf ( "player %s", line[i][0]!='\0' ? line[i] : "?\n" );
+      if ( sscanf ( line[i], "%*d %llx", &hash[i] ) != 1 ) ret= EXIT_FAILURE;
+    }
+  if ( ret == EXIT_SUCCESS && hash[0] != hash[1] )
+    {
+      printf ( "DESYNC\n" );
+      ret= EXIT_FAILURE;
+    }
+  else if ( ret == EXIT_SUCCESS ) printf ( "OK\n" );
+  GG_rom_free ( rom );
+  
+  return ret;
+  
+} /* end main */
@@ -0,0 +1,336 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/GG.
+ *
+ * adriagipas/GG is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/GG is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/GG.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  state_bench.c - Mesura el temps que es tarda en guardar i carregar
+ *                  l'estat del simulador.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GG.h"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+/* 'Frames' que s'executen abans de començar a mesurar. */
+static const int WARMUP_FRAMES= 300;
+
+/* Repeticions per defecte. */
+static const int NITERS= 10000;
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static Z80u8 _sram[32*1024];
+static int _frames;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+warning (
+         void       *udata,
+         const char *format,
+         ...
+         )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  fprintf ( stderr, "Warning: " );
+  vfprintf ( stderr, format, ap );
+  putc ( '\n', stderr );
+  va_end ( ap );
+  
+} /* end warning */
+
+
+static Z80u8 *
+get_external_ram (
+        	  void *udata
+        	  )
+{
+  return &(_sram[0]);
+} /* end get_external_ram */
+
+
+static void
+update_screen (
+               const int  fb[23040],
+               void      *udata
+               )
+{
+  ++_frames;
+} /* end update_screen */
+
+
+static int
+check_buttons (
+               void *udata
+               )
+{
+  return 0xFF;
+} /* end check_buttons */
+
+
+static void
+play_sound (
+            const double  left[GG_PSG_BUFFER_SIZE],
+            const double  right[GG_PSG_BUFFER_SIZE],
+            void         *udata
+            )
+{
+} /* end play_sound */
+
+
+static int
+load_rom (
+          const char *fn,
+          GG_Rom     *rom
+          )
+{
+  
+  FILE *f;
+  long size;
+  
+  
+  f= fopen ( fn, "rb" );
+  if ( f == NULL ) return -1;
+  if ( fseek ( f, 0, SEEK_END ) != 0 ) goto error;
+  size= ftell ( f );
+  if ( size <= 0 || size%GG_BANK_SIZE != 0 ) goto error;
+  rewind ( f );
+  rom->nbanks= (int) (size/GG_BANK_SIZE);
+  GG_rom_alloc ( *rom );
+  if ( rom->banks == NULL ) goto error;
+  if ( fread ( rom->banks, size, 1, f ) != 1 ) goto error;
+  fclose ( f );
+  
+  return 0;
+  
+ error:
+  fclose ( f );
+  return -1;
+  
+} /* end load_rom */
+
+
+static void
+run_frames (
+            const int nframes
+            )
+{
+  
+  Z80_Bool stop;
+  
+  
+  stop= Z80_FALSE;
+  for ( _frames= 0; _frames < nframes; )
+    GG_iter ( &stop );
+  
+} /* end run_frames */
+
+
+static void
+report (
+        const char   *name,
+        const double  t,
+        const int     niters
+        )
+{
+  printf ( "%-18s %10.3f us/snapshot\n", name, 1e6*t/niters );
+} /* end report */
+
+
+
+
+/******************/
+/* PUNT D'ENTRADA */
+/******************/
+
+int
+main (
+      int   argc,
+      char *argv[]
+      )
+{
+  
+  static const GG_Frontend frontend=
+    {
+      warning,
+      get_external_ram,
+      update_screen,
+      NULL,
+      check_buttons,
+      play_sound,
+      NULL,
+      NULL
+    };
+  
+  GG_Rom rom;
+  Z80u8 *buf;
+  size_t size, n;
+  FILE *f;
+  GG_Branch *branch, *prev;
+  double t0, tnew, tload;
+  int i, niters;
+  
+  
+  if ( argc != 2 && argc != 3 )
+    {
+      fprintf ( stderr, "Usage: %s ROM [ITERS]\n", argv[0] );
+      return EXIT_FAILURE;
+    }
+  niters= argc==3 ? atoi ( argv[2] ) : NITERS;
+  if ( niters <= 0 ) niters= NITERS;
+  rom.banks= NULL;
+  prev= NULL;
+  if ( load_rom ( argv[1], &rom ) != 0 )
+    {
+      fprintf ( stderr, "Error: no s'ha pogut llegir '%s'\n", argv[1] );
+      return EXIT_FAILURE;
+    }
+  GG_init ( &rom, &frontend, NULL );
+  run_frames ( WARMUP_FRAMES );
+  size= GG_state_size ();
+  buf= (Z80u8 *) malloc ( size );
+  if ( buf == NULL ) goto error;
+  
+  /* Memòria. */
+  n= GG_save_state_mem ( buf );
+  if ( n == 0 ) goto error;
+  printf ( "state size         %10lu bytes (max %lu)\n",
+           (unsigned long) n, (unsigned long) size );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    GG_save_state_mem ( buf );
+  report ( "save_state_mem", GG_clock_get ()-t0, niters );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    if ( GG_load_state_mem ( buf, n ) != 0 ) goto error;
+  report ( "load_state_mem", GG_clock_get ()-t0, niters );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    if ( GG_load_state_trusted_mem ( buf, n ) != 0 ) goto error;
+  report ( "load_trusted_mem", GG_clock_get ()-t0, niters );
+  
+  /* Compacte. */
+  n= GG_save_state_compact_mem ( buf );
+  if ( n == 0 ) goto error;
+  printf ( "compact size       %10lu bytes\n", (unsigned long) n );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    GG_save_state_compact_mem ( buf );
+  report ( "save_compact_mem", GG_clock_get ()-t0, niters );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    if ( GG_load_state_mem ( buf, n ) != 0 ) goto error;
+  report ( "load_compact_mem", GG_clock_get ()-t0, niters );
+  
+  /* Portable. */
+  n= GG_save_state_portable_mem ( buf );
+  if ( n == 0 ) goto error;
+  printf ( "portable size      %10lu bytes\n", (unsigned long) n );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    GG_save_state_portable_mem ( buf );
+  report ( "save_portable_mem", GG_clock_get ()-t0, niters );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    if ( GG_load_state_mem ( buf, n ) != 0 ) goto error;
+  report ( "load_portable_mem", GG_clock_get ()-t0, niters );
+  
+  /* Bifurcacions. Després de cada 'frame' se'n crea una (sols es
+     copien les pàgines escrites) i es torna a l'anterior. */
+  tnew= tload= 0.0;
+  for ( i= 0; i < niters; ++i )
+    {
+      run_frames ( 1 );
+      t0= GG_clock_get ();
+      branch= GG_branch_new ();
+      tnew+= GG_clock_get ()-t0;
+      if ( branch == NULL ) goto error;
+      if ( prev != NULL )
+        {
+          t0= GG_clock_get ();
+          if ( GG_branch_load ( prev ) != 0 ) goto error;
+          tload+= GG_clock_get ()-t0;
+          GG_branch_free ( prev );
+        }
+      prev= branch;
+    }
+  GG_branch_free ( prev );
+  prev= NULL;
+  report ( "branch_new", tnew, niters );
+  report ( "branch_load", tload, niters-1 );
+  
+  /* FILE sobre memòria (format portable), per a comparar. */
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    {
+      f= fmemopen ( buf, size, "wb" );
+      if ( f == NULL || GG_save_state ( f ) != 0 ) goto error;
+      n= (size_t) ftell ( f );
+      fclose ( f );
+    }
+  report ( "save_state (FILE)", GG_clock_get ()-t0, niters );
+  t0= GG_clock_get ();
+  for ( i= 0; i < niters; ++i )
+    {
+      f= fmemopen ( buf, n, "rb" );
+      if ( f == NULL || GG_load_state ( f ) != 0 ) goto error;
+      fclose ( f );
+    }
+  report ( "load_state (FILE)", GG_clock_get ()-t0, niters );
+  
+  free ( buf );
+  GG_rom_free ( rom );
+  
+  return EXIT_SUCCESS;
+  
+ error:
+  fprintf ( stderr, "Error: no s'ha pogut guardar/carregar l'estat\n" );
+  GG_branch_free ( prev );
+  free ( buf );
+  GG_rom_free ( rom );
+  return EXIT_FAILURE;
+  
+} /* end main */